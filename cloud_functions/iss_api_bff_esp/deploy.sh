@@ -13,6 +13,10 @@ source "$CONFIG_FILE"
 
 # Function-specific configuration
 FUNCTION_NAME="iss_api_bff_esp"
+# Requests served at once per instance, so polls arriving together share
+# the instance cache; more than one needs a whole CPU
+CONCURRENCY=20
+CPU=1
 
 # Print current configuration
 echo "🚀 Preparing to deploy $FUNCTION_NAME..."
@@ -79,6 +83,8 @@ gcloud functions deploy $FUNCTION_NAME \
     --timeout=$TIMEOUT \
     --min-instances=$MIN_INSTANCES \
     --max-instances=$MAX_INSTANCES \
+    --concurrency=$CONCURRENCY \
+    --cpu=$CPU \
     --ingress-settings=$INGRESS_SETTINGS \
     --entry-point=$FUNCTION_NAME
 
@@ -0,0 +1,83 @@
+#!/bin/bash
+
+# Deploys the push stream (?stream=1) as its own function, from the same
+# source as iss_api_bff_esp. Streams stay open for minutes, so this service
+# gets a long timeout and many requests per instance; the polling BFF
+# (deploy.sh) keeps its short timeout and is not billed for idle streams.
+
+# Exit on any error
+set -e
+
+# Load common configuration
+CONFIG_FILE="../config/deployment_config.sh"
+if [ ! -f "$CONFIG_FILE" ]; then
+    echo "❌ Error: Configuration file not found at $CONFIG_FILE"
+    exit 1
+fi
+source "$CONFIG_FILE"
+
+# Function-specific configuration
+FUNCTION_NAME="iss_api_bff_esp_stream"
+ENTRY_POINT="iss_api_bff_esp"
+# Each open stream holds one request slot, so this bounds the devices per
+# instance; streams are mostly idle and share one Firestore watch
+CONCURRENCY=80
+CPU=1
+# Push streams end after 15 minutes (STREAM_MAX_SECONDS in utils.py)
+STREAM_TIMEOUT="960s"
+
+# Print current configuration
+echo "🚀 Preparing to deploy $FUNCTION_NAME..."
+echo "Project: $PROJECT_ID"
+echo "Region: $REGION"
+echo "Runtime: $RUNTIME"
+echo "Service Account: $SERVICE_ACCOUNT_EMAIL"
+
+# Verify gcloud is installed
+if ! command -v gcloud &> /dev/null; then
+    echo "❌ Error: gcloud CLI is not installed"
+    exit 1
+fi
+
+# Verify authentication
+if ! gcloud auth list --filter=status:ACTIVE --format="get(account)" &> /dev/null; then
+    echo "❌ Error: Not authenticated with gcloud"
+    echo "Please run: gcloud auth login"
+    exit 1
+fi
+
+# Set the project
+echo "🔧 Setting project to $PROJECT_ID..."
+gcloud config set project $PROJECT_ID
+
+# Deploy the function (APIs and the service account are set up by deploy.sh)
+echo "📦 Deploying function..."
+
+gcloud functions deploy $FUNCTION_NAME \
+    --region=$REGION \
+    --runtime=$RUNTIME \
+    --trigger-http \
+    --allow-unauthenticated \
+    --service-account=$SERVICE_ACCOUNT_EMAIL \
+    --memory=$MEMORY \
+    --timeout=$STREAM_TIMEOUT \
+    --min-instances=$MIN_INSTANCES \
+    --max-instances=$MAX_INSTANCES \
+    --concurrency=$CONCURRENCY \
+    --cpu=$CPU \
+    --set-env-vars=THREADS=$CONCURRENCY,STREAM_SERVICE=1 \
+    --ingress-settings=$INGRESS_SETTINGS \
+    --entry-point=$ENTRY_POINT
+
+# Check deployment status
+if [ $? -eq 0 ]; then
+    echo "✅ Function deployed successfully!"
+
+    # Get the function URL
+    FUNCTION_URL=$(gcloud functions describe $FUNCTION_NAME --region=$REGION --format='get(serviceConfig.uri)')
+    echo "📍 Function URL: $FUNCTION_URL"
+    echo "Devices connect their push stream to this host (bffStreamHost in iss_http.cpp)"
+else
+    echo "❌ Deployment failed"
+    exit 1
+fi
@@ -0,0 +1,480 @@
+"""
+Load test for iss_api_bff_esp: a simulated fleet of ESP displays.
+
+Each simulated device makes the firmware's requests (iss_fetch.cpp and
+iss_poll.cpp in iss_display_apps/iss_esp_display): the same GET with batch,
+history, Accept and validator headers on a kept-alive connection, up to 3
+attempts of 10 seconds each with a second between them, a reconnect that
+does not use up an attempt when a reused connection turns out closed, and
+equal-jitter backoff after a failed update. Servers that answer with
+"Connection: close" get a new connection next time, as on the device.
+
+The fleet polls in rounds, one per store interval by default, each device
+at a random point in the first POLL_JITTER_SECONDS of the round: the burst
+that follows a push announcement or a shared max-age hint.
+
+Results come from the response headers added by utils.instance_headers():
+  latency      Client time per poll, from the first attempt to the body
+  cold start   Polls served by an instance whose uptime was shorter than
+               the poll's latency, i.e. that started while it waited
+  cost         Cloud Run time per instance (the union of its requests'
+               Server-Timing intervals, plus start-up for instances that
+               started during the test) at request-based billing prices,
+               the per-request fee, and the facts the instances asked
+               iss_api_get_loc_fact for (fact cache misses, each a Gemini
+               call). Upstream functions' own compute is not included.
+
+Python 3.8+ standard library only. Each device holds one connection, so
+raise the open file limit (ulimit -n) above the fleet size.
+
+Usage:
+    ./load_test.sh [options]
+    python3 load_test.py URL API_KEY [--devices 1000] [--rounds 3]
+        [--interval 300] [--align] [--format cbor|json] [--batch 6]
+        [--history 90] [--connection-close] [--output summary.json]
+"""
+
+import argparse
+import asyncio
+import json
+import math
+import random
+import ssl
+import sys
+import time
+from urllib.parse import urlsplit
+
+# Request pattern of the firmware (iss_fetch.cpp, iss_poll.cpp, main.cpp)
+FETCH_BATCH_SIZE = 6
+HISTORY_MINUTES = 90
+ATTEMPT_TIMEOUT_SECONDS = 10
+RETRY_DELAY_SECONDS = 1
+MAX_ATTEMPTS = 3
+POLL_JITTER_SECONDS = 5
+MIN_POLL_SECONDS = 15
+FAILURE_BACKOFF_BASE_SECONDS = 30
+FAILURE_BACKOFF_MAX_SECONDS = 900
+STORE_INTERVAL_SECONDS = 300
+STORE_GRACE_SECONDS = 20
+
+# Cloud Run request-based billing, tier 1 regions (us-east1), in USD.
+# Billable instance time is rounded up to 100 ms.
+CPU_SECOND_USD = 0.000024
+GIB_SECOND_USD = 0.0000025
+REQUEST_USD = 0.40 / 1e6
+BILLING_GRANULARITY_SECONDS = 0.1
+# One fact from Gemini 2.5 Flash-Lite: about 100 prompt tokens at
+# $0.10 per million and 40 output tokens at $0.40 per million
+FACT_USD = 0.000026
+
+# Deployed size (deploy.sh and config/deployment_config.sh)
+DEFAULT_CPU = 1
+DEFAULT_MEMORY_GIB = 0.25
+
+
+class Poll:
+    """Outcome of one update, possibly over several attempts."""
+
+    def __init__(self, device, started):
+        self.device = device
+        self.started = started
+        self.latency = None
+        self.ttfb = None
+        self.status = None     # HTTP status of the last attempt, or an error name
+        self.attempts = 0
+        self.reconnects = 0    # Reused connections that turned out closed
+        self.connections = 0   # New (TLS) connections
+        self.body_bytes = 0
+        self.instance = None   # X-Instance-Id
+        self.uptime = None     # X-Instance-Uptime, seconds
+        self.facts = None      # X-Instance-Facts
+        self.server_seconds = None  # Server-Timing app duration
+
+    @property
+    def ok(self):
+        return self.status in (200, 304)
+
+    @property
+    def cold(self):
+        return self.uptime is not None and self.uptime < self.latency
+
+
+class AttemptError(Exception):
+    """An attempt that ended without a usable response."""
+
+    def __init__(self, kind, before_status=True):
+        super().__init__(kind)
+        self.kind = kind
+        self.before_status = before_status
+
+
+class Device:
+    """One simulated display with its connection and validators."""
+
+    def __init__(self, index, target, options):
+        self.index = index
+        self.target = target
+        self.options = options
+        self.reader = None
+        self.writer = None
+        self.etag = None
+        self.last_modified = None
+        self.failures = 0
+
+    def close(self):
+        if self.writer:
+            self.writer.close()
+        self.reader = None
+        self.writer = None
+
+    def request_bytes(self):
+        """The request as iss_fetch.cpp stepRequest() writes it."""
+        options = self.options
+        accept = ('application/cbor, application/json;q=0.5'
+                  if options.format == 'cbor' else 'application/json')
+        lines = [
+            f"GET {self.target.path}?api_key={options.api_key}"
+            f"&batch={options.batch}&history={options.history} HTTP/1.1",
+            f"Host: {self.target.host}",
+            "User-Agent: ESP32HTTPClient",
+            "Content-Length: 0",
+            f"Connection: {'close' if options.connection_close else 'keep-alive'}",
+            f"Accept: {accept}",
+        ]
+        if self.etag:
+            lines.append(f"If-None-Match: {self.etag}")
+        if self.last_modified:
+            lines.append(f"If-Modified-Since: {self.last_modified}")
+        return ("\r\n".join(lines) + "\r\n\r\n").encode()
+
+    async def connect(self, poll):
+        self.reader, self.writer = await asyncio.open_connection(
+            self.target.host, self.target.port, ssl=self.target.ssl,
+            server_hostname=self.target.host if self.target.ssl else None)
+        poll.connections += 1
+
+    async def read_body(self, headers):
+        if headers.get('transfer-encoding', '').lower().startswith('chunked'):
+            length = 0
+            while True:
+                size = int((await self.reader.readline()).split(b';')[0], 16)
+                if size == 0:
+                    await self.reader.readline()
+                    return length
+                await self.reader.readexactly(size + 2)
+                length += size
+        length = int(headers.get('content-length', 0))
+        await self.reader.readexactly(length)
+        return length
+
+    async def attempt(self, poll):
+        """Sends the request once and reads the whole response."""
+        if self.writer is None:
+            await self.connect(poll)
+        try:
+            self.writer.write(self.request_bytes())
+            await self.writer.drain()
+            sent = time.monotonic()
+            status_line = await self.reader.readline()
+        except (OSError, asyncio.IncompleteReadError) as e:
+            raise AttemptError('connection_lost', before_status=True) from e
+        if not status_line:
+            raise AttemptError('connection_lost', before_status=True)
+        if poll.ttfb is None:
+            poll.ttfb = time.monotonic() - sent
+
+        try:
+            status = int(status_line.split()[1])
+            head = await self.reader.readuntil(b'\r\n\r\n')
+        except (ValueError, IndexError) as e:
+            raise AttemptError('bad_status_line', before_status=False) from e
+        except (OSError, asyncio.IncompleteReadError,
+                asyncio.LimitOverrunError) as e:
+            raise AttemptError('connection_lost', before_status=False) from e
+        headers = {}
+        for line in head.decode('latin-1').split('\r\n'):
+            name, _, value = line.partition(':')
+            if value:
+                headers[name.strip().lower()] = value.strip()
+
+        try:
+            body_bytes = 0 if status == 304 else await self.read_body(headers)
+        except (OSError, ValueError, asyncio.IncompleteReadError) as e:
+            raise AttemptError('connection_lost', before_status=False) from e
+        if headers.get('connection', '').lower() == 'close':
+            self.close()
+        return status, headers, body_bytes
+
+    async def update(self, poll):
+        """Runs an update as iss_fetch.cpp does: attempts, retries, reconnects."""
+        while poll.attempts < MAX_ATTEMPTS:
+            poll.attempts += 1
+            reused = self.writer is not None
+            try:
+                status, headers, body_bytes = await asyncio.wait_for(
+                    self.attempt(poll), ATTEMPT_TIMEOUT_SECONDS)
+            except AttemptError as e:
+                self.close()
+                # A kept-alive connection the server closed just now: not a
+                # real failure, so reconnect without using up an attempt
+                if reused and e.before_status:
+                    poll.reconnects += 1
+                    poll.attempts -= 1
+                    continue
+                poll.status = e.kind
+            except asyncio.TimeoutError:
+                self.close()
+                poll.status = 'timeout'
+            except OSError:
+                self.close()
+                poll.status = 'connect'
+            else:
+                poll.status = status
+                poll.body_bytes = body_bytes
+                poll.instance = headers.get('x-instance-id')
+                if 'x-instance-uptime' in headers:
+                    poll.uptime = float(headers['x-instance-uptime'])
+                if 'x-instance-facts' in headers:
+                    poll.facts = int(headers['x-instance-facts'])
+                timing = headers.get('server-timing', '')
+                if 'dur=' in timing:
+                    poll.server_seconds = float(timing.split('dur=')[1].split(',')[0]) / 1000
+                if status in (200, 304):
+                    self.etag = headers.get('etag', self.etag)
+                    self.last_modified = headers.get('last-modified', self.last_modified)
+                    return
+                self.close()
+            if poll.attempts < MAX_ATTEMPTS:
+                await asyncio.sleep(RETRY_DELAY_SECONDS)
+
+    def failure_delay(self):
+        """Equal-jitter backoff of iss_poll.cpp pollDelayAfterFailure()."""
+        self.failures += 1
+        backoff = min(FAILURE_BACKOFF_BASE_SECONDS << min(self.failures - 1, 5),
+                      FAILURE_BACKOFF_MAX_SECONDS)
+        return max(backoff / 2 + random.uniform(0, backoff / 2), MIN_POLL_SECONDS)
+
+    async def run(self, start, polls):
+        """Polls once per round, and again after backoff when an update fails."""
+        end = start + self.options.rounds * self.options.interval
+        next_poll = start + random.uniform(0, self.options.spread)
+        while next_poll < end:
+            await asyncio.sleep(max(0, next_poll - time.monotonic()))
+            poll = Poll(self.index, time.monotonic())
+            await self.update(poll)
+            poll.latency = time.monotonic() - poll.started
+            polls.append(poll)
+
+            round_index = int((poll.started - start) // self.options.interval) + 1
+            next_poll = (start + round_index * self.options.interval +
+                         random.uniform(0, self.options.spread))
+            if poll.ok:
+                self.failures = 0
+            else:
+                next_poll = min(next_poll, time.monotonic() + self.failure_delay())
+        self.close()
+
+
+class Target:
+    """Host, port, path and TLS context of the endpoint."""
+
+    def __init__(self, url):
+        parts = urlsplit(url)
+        self.host = parts.hostname
+        self.port = parts.port or (443 if parts.scheme == 'https' else 80)
+        self.path = parts.path or '/'
+        self.ssl = ssl.create_default_context() if parts.scheme == 'https' else None
+
+
+def percentile(values, fraction):
+    """Nearest-rank percentile of a list, None if it is empty."""
+    if not values:
+        return None
+    ordered = sorted(values)
+    return ordered[max(0, math.ceil(fraction * len(ordered)) - 1)]
+
+
+def billable_seconds(intervals):
+    """Length of the union of (start, end) intervals, each run rounded up."""
+    total = 0.0
+    run_start = run_end = None
+    for start, end in sorted(intervals):
+        if run_end is not None and start <= run_end:
+            run_end = max(run_end, end)
+            continue
+        if run_end is not None:
+            total += math.ceil((run_end - run_start) / BILLING_GRANULARITY_SECONDS) * BILLING_GRANULARITY_SECONDS
+        run_start, run_end = start, end
+    if run_end is not None:
+        total += math.ceil((run_end - run_start) / BILLING_GRANULARITY_SECONDS) * BILLING_GRANULARITY_SECONDS
+    return total
+
+
+def summarize(polls, options, elapsed):
+    """Aggregates the polls into the report's numbers."""
+    outcomes = {}
+    for poll in polls:
+        outcomes[str(poll.status)] = outcomes.get(str(poll.status), 0) + 1
+
+    def latencies(selected):
+        values = [poll.latency * 1000 for poll in selected]
+        return {'p50_ms': percentile(values, 0.5), 'p99_ms': percentile(values, 0.99),
+                'max_ms': max(values) if values else None}
+
+    good = [poll for poll in polls if poll.ok]
+    served = [poll for poll in polls if poll.instance and poll.uptime is not None]
+
+    # Instance time: Server-Timing intervals on each instance's own clock,
+    # plus start-up (from uptime 0) for instances that started during the test
+    instances = {}
+    for poll in served:
+        instance = instances.setdefault(poll.instance, {
+            'intervals': [], 'first_uptime': poll.uptime, 'started_in_test': False,
+            'facts_first': poll.facts, 'facts_last': poll.facts})
+        duration = poll.server_seconds or 0.0
+        instance['intervals'].append((poll.uptime - duration, poll.uptime))
+        if poll.uptime < poll.latency + (poll.started - options.started):
+            instance['started_in_test'] = True
+        if poll.facts is not None:
+            if instance['facts_first'] is None or poll.facts < instance['facts_first']:
+                instance['facts_first'] = poll.facts
+            instance['facts_last'] = max(instance['facts_last'] or 0, poll.facts)
+
+    instance_seconds = 0.0
+    facts = 0
+    for instance in instances.values():
+        intervals = instance['intervals']
+        if instance['started_in_test']:
+            intervals = intervals + [(0.0, min(start for start, _ in intervals))]
+        instance_seconds += billable_seconds(intervals)
+        if instance['facts_last'] is not None:
+            # A warm instance's count before its first response is unknown;
+            # facts generated for that response itself are not counted then
+            baseline = 0 if instance['started_in_test'] else instance['facts_first']
+            facts += instance['facts_last'] - baseline
+
+    compute_usd = instance_seconds * (options.cpu * CPU_SECOND_USD +
+                                      options.memory_gib * GIB_SECOND_USD)
+    requests_usd = sum(poll.attempts for poll in polls) * REQUEST_USD
+    facts_usd = facts * options.fact_cost
+    total_usd = compute_usd + requests_usd + facts_usd
+    cold = [poll for poll in served if poll.cold]
+
+    return {
+        'devices': options.devices,
+        'rounds': options.rounds,
+        'elapsed_s': round(elapsed, 1),
+        'polls': len(polls),
+        'outcomes': outcomes,
+        'attempts': sum(poll.attempts for poll in polls),
+        'reconnects': sum(poll.reconnects for poll in polls),
+        'connections_opened': sum(poll.connections for poll in polls),
+        'body_bytes_mean': (sum(poll.body_bytes for poll in good) / len(good)) if good else None,
+        'latency': latencies(good),
+        'latency_200': latencies([poll for poll in good if poll.status == 200]),
+        'latency_304': latencies([poll for poll in good if poll.status == 304]),
+        'ttfb_p50_ms': percentile([poll.ttfb * 1000 for poll in good if poll.ttfb], 0.5),
+        'ttfb_p99_ms': percentile([poll.ttfb * 1000 for poll in good if poll.ttfb], 0.99),
+        'instances': len(instances),
+        'instances_started': sum(1 for i in instances.values() if i['started_in_test']),
+        'cold_start_polls': len(cold),
+        'cold_start_rate': (len(cold) / len(served)) if served else None,
+        'cold_start_latency': latencies(cold),
+        'instance_seconds': round(instance_seconds, 1),
+        'facts_generated': facts,
+        'cost_usd': {'compute': compute_usd, 'requests': requests_usd,
+                     'facts': facts_usd, 'total': total_usd},
+        'cost_per_1k_polls_usd': (total_usd / len(polls) * 1000) if polls else None,
+    }
+
+
+def print_report(summary):
+    """Prints the summary for a terminal."""
+    def ms(value):
+        return '-' if value is None else f"{value:.0f} ms"
+
+    def row(name, latency):
+        print(f"  {name:<12} p50 {ms(latency['p50_ms']):>9}  p99 {ms(latency['p99_ms']):>9}"
+              f"  max {ms(latency['max_ms']):>9}")
+
+    print(f"\n{summary['devices']} devices, {summary['rounds']} rounds, "
+          f"{summary['polls']} polls in {summary['elapsed_s']} s")
+    print("Outcomes:  " + ", ".join(f"{k}: {v}" for k, v in sorted(summary['outcomes'].items())))
+    print(f"Attempts:  {summary['attempts']} ({summary['reconnects']} reconnects on closed "
+          f"keep-alive connections, {summary['connections_opened']} new connections)")
+    print("Latency:")
+    row('all', summary['latency'])
+    row('200', summary['latency_200'])
+    row('304', summary['latency_304'])
+    row('cold start', summary['cold_start_latency'])
+    print(f"  {'ttfb':<12} p50 {ms(summary['ttfb_p50_ms']):>9}  p99 {ms(summary['ttfb_p99_ms']):>9}")
+    rate = summary['cold_start_rate']
+    print(f"Instances: {summary['instances']} seen, {summary['instances_started']} started "
+          f"during the test; cold-start rate "
+          f"{'-' if rate is None else f'{rate * 100:.2f}%'} of polls")
+    cost = summary['cost_usd']
+    print(f"Cost:      {summary['instance_seconds']} instance-seconds, "
+          f"{summary['facts_generated']} facts")
+    print(f"  compute ${cost['compute']:.6f}  requests ${cost['requests']:.6f}  "
+          f"facts ${cost['facts']:.6f}  total ${cost['total']:.6f}")
+    per_1k = summary['cost_per_1k_polls_usd']
+    print(f"  per 1k polls: {'-' if per_1k is None else f'${per_1k:.5f}'}")
+
+
+async def run_fleet(options):
+    target = Target(options.url)
+    if options.align:
+        # First round just after the next location is stored
+        now = time.time()
+        boundary = (math.floor(now / STORE_INTERVAL_SECONDS) + 1) * STORE_INTERVAL_SECONDS
+        wait = boundary + STORE_GRACE_SECONDS - now
+        print(f"Waiting {wait:.0f} s for the next store boundary")
+        await asyncio.sleep(wait)
+
+    polls = []
+    options.started = time.monotonic()
+    devices = [Device(i, target, options) for i in range(options.devices)]
+    print(f"Polling with {options.devices} devices for {options.rounds} rounds "
+          f"of {options.interval} s")
+    await asyncio.gather(*(device.run(options.started, polls) for device in devices))
+    return polls, time.monotonic() - options.started
+
+
+def parse_args(argv):
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('url', help='Function URL')
+    parser.add_argument('api_key', help='ESP API key')
+    parser.add_argument('--devices', type=int, default=1000)
+    parser.add_argument('--rounds', type=int, default=3)
+    parser.add_argument('--interval', type=float, default=STORE_INTERVAL_SECONDS,
+                        help='Seconds between the fleet\'s polls')
+    parser.add_argument('--spread', type=float, default=POLL_JITTER_SECONDS,
+                        help='Seconds over which a round\'s polls are spread')
+    parser.add_argument('--align', action='store_true',
+                        help='Start just after the next 5-minute store boundary')
+    parser.add_argument('--format', choices=('cbor', 'json'), default='cbor')
+    parser.add_argument('--batch', type=int, default=FETCH_BATCH_SIZE)
+    parser.add_argument('--history', type=int, default=HISTORY_MINUTES)
+    parser.add_argument('--connection-close', action='store_true',
+                        help='Send Connection: close instead of keeping connections')
+    parser.add_argument('--cpu', type=float, default=DEFAULT_CPU)
+    parser.add_argument('--memory-gib', type=float, default=DEFAULT_MEMORY_GIB)
+    parser.add_argument('--fact-cost', type=float, default=FACT_USD,
+                        help='USD per generated fact')
+    parser.add_argument('--output', help='Also write the summary as JSON to this file')
+    return parser.parse_args(argv)
+
+
+def main(argv):
+    options = parse_args(argv)
+    polls, elapsed = asyncio.run(run_fleet(options))
+    summary = summarize(polls, options, elapsed)
+    print_report(summary)
+    if options.output:
+        with open(options.output, 'w') as output:
+            json.dump(summary, output, indent=2)
+        print(f"Summary written to {options.output}")
+
+
+if __name__ == '__main__':
+    main(sys.argv[1:])
@@ -0,0 +1,38 @@
+#!/bin/bash
+
+# Exit on any error
+set -e
+
+# Load common configuration
+CONFIG_FILE="../config/deployment_config.sh"
+if [ ! -f "$CONFIG_FILE" ]; then
+    echo "❌ Error: Configuration file not found at $CONFIG_FILE"
+    exit 1
+fi
+source "$CONFIG_FILE"
+
+# Function-specific configuration
+FUNCTION_NAME="iss_api_bff_esp"
+
+# Get the function URL
+FUNCTION_URL=$(gcloud functions describe $FUNCTION_NAME --region=$REGION --format='get(serviceConfig.uri)')
+if [ -z "$FUNCTION_URL" ]; then
+    echo "❌ Error: Could not get function URL"
+    exit 1
+fi
+
+# Get the API key from Secret Manager
+API_KEY=$(gcloud secrets versions access latest --secret="iss-sky-scanner-esp-api-key")
+if [ -z "$API_KEY" ]; then
+    echo "Error: Could not get API key"
+    exit 1
+fi
+
+echo "🚀 Load testing $FUNCTION_NAME..."
+echo "📍 Function URL: $FUNCTION_URL"
+
+# One connection per simulated device
+ulimit -n 65536 2>/dev/null || echo "⚠️  Could not raise the open file limit: $(ulimit -n)"
+
+# Options are passed through, e.g. --devices 5000 --rounds 2 --align
+python3 "$(dirname "$0")/load_test.py" "$FUNCTION_URL" "$API_KEY" "$@"
@@ -1,17 +1,66 @@
 import logging
+import os
+import re
+import time
 import functions_framework
-from flask import jsonify, request
-from utils import get_iss_location_with_fact, get_secret
+from flask import Response, jsonify, make_response, request
+from utils import (FIRMWARE_CHECK_MAX_AGE_SECONDS, HISTORY_MAX_MINUTES,
+                   MAX_BATCH_SIZE, accepts_cbor, build_cache_headers,
+                   encode_cbor, get_firmware_update, get_latest_location,
+                   get_response, get_secret, get_track, instance_headers,
+                   is_not_modified, stream_location_events, track_json)
 
 # Configure logging
 logging.basicConfig(level=logging.INFO)
 logger = logging.getLogger(__name__)
 
+# Set on the stream service only (deploy_stream.sh), whose timeout and
+# concurrency suit long-lived streams; elsewhere ?stream=1 is ignored
+STREAM_SERVICE = os.environ.get('STREAM_SERVICE') == '1'
+
 @functions_framework.http
 def iss_api_bff_esp(request):
+    """
+    Serves the ESP endpoint, see _handle_request().
+
+    Responses other than the push stream also name the serving instance
+    (see utils.instance_headers) for load_test.py.
+    """
+    started = time.time()
+    response = make_response(_handle_request(request))
+    if not response.is_streamed:
+        response.headers.update(instance_headers(started))
+    return response
+
+
+def _handle_request(request):
     """
     Backend for Frontend (BFF) for the ESP IoT app.
     Combines data from iss_api_get_last_stored_loc and iss_api_get_loc_fact.
+
+    With ?batch=N (2 to MAX_BATCH_SIZE) the response also carries the next
+    N - 1 predicted locations with their facts, for the device to play back
+    one per store interval before it polls again.
+
+    Clients sending Accept: application/cbor get the same fields as CBOR,
+    which the ESP decodes without a JSON document; JSON stays the default.
+
+    With ?history=MINUTES (up to HISTORY_MAX_MINUTES) the response also
+    carries the ground track of the stored locations over those minutes,
+    delta/varint encoded: a byte string in CBOR, base64 in JSON.
+
+    With ?stream=1, on the stream service, the response is a server-sent
+    event stream instead, announcing each new stored location within
+    seconds so the device can fetch it without polling on a timer.
+
+    With ?firmware=IMAGE_ID (the SHA-256 of the running image, as hex) the
+    response is a firmware update for that image instead: a delta patch or
+    the full image from the release in the config bucket, or 204 No Content
+    if the image is the current release.
+
+    The secret, ID tokens, latest location and response bodies are cached
+    per instance, so a fleet polling together costs one set of upstream
+    calls.
     
     Returns:
         JSON response with ISS location data and fun fact
@@ -21,7 +70,7 @@ def iss_api_bff_esp(request):
         headers = {
             'Access-Control-Allow-Origin': '*',
             'Access-Control-Allow-Methods': 'GET',
-            'Access-Control-Allow-Headers': 'Content-Type',
+            'Access-Control-Allow-Headers': 'Content-Type, If-None-Match, If-Modified-Since, Last-Event-ID',
             'Access-Control-Max-Age': '3600'
         }
         return ('', 204, headers)
@@ -47,9 +96,95 @@ def iss_api_bff_esp(request):
         logger.error(f"Error validating API key: {str(e)}")
         return (jsonify({'error': 'Error validating API key'}), 500, headers)
 
-    # Get ISS location with fun fact
-    result = get_iss_location_with_fact()
+    # Push channel: one long-lived stream of location events
+    if STREAM_SERVICE and request.args.get('stream') == '1':
+        stream_headers = {
+            'Access-Control-Allow-Origin': '*',
+            'Cache-Control': 'no-cache',
+            'X-Accel-Buffering': 'no'
+        }
+        events = stream_location_events(request.headers.get('Last-Event-ID'))
+        return Response(events, 200, stream_headers, mimetype='text/event-stream')
+
+    # Firmware check: the update for the running image, if there is one
+    firmware = request.args.get('firmware')
+    if firmware is not None:
+        return _firmware_response(firmware.lower())
+
+    batch_size = max(1, min(request.args.get('batch', 1, type=int), MAX_BATCH_SIZE))
+    history_minutes = max(0, min(request.args.get('history', 0, type=int),
+                                 HISTORY_MAX_MINUTES))
+    cbor = accepts_cbor(request.headers)
+    variant = 'cbor' if cbor else None
+    if history_minutes:
+        variant = f"{variant or 'json'}:history{history_minutes}"
+
+    # Get the latest ISS location
+    location_info = get_latest_location()
+    if not location_info:
+        return (jsonify({'error': 'Failed to get ISS location data'}), 500, headers)
+
+    # Conditional request: the client already has this location's fact,
+    # so skip generating a new one
+    cache_headers = build_cache_headers(location_info, batch_size, variant)
+    headers.update(cache_headers)
+    headers['Access-Control-Expose-Headers'] = 'ETag, Last-Modified, Cache-Control'
+    headers['Vary'] = 'Accept'
+    if is_not_modified(request.headers, cache_headers):
+        logger.info("Location unchanged, returning 304")
+        del headers['Content-Type']
+        return ('', 304, headers)
+
+    # Add the fun fact (and upcoming locations), shared by concurrent polls
+    result = get_response(location_info, batch_size)
     if not result:
         return (jsonify({'error': 'Failed to get ISS location data'}), 500, headers)
 
+    # If fewer upcoming locations could be built, ask for the next poll sooner
+    if batch_size > 1:
+        covered = 1 + len(result.get('upcoming', []))
+        if covered < batch_size:
+            headers['Cache-Control'] = build_cache_headers(location_info, covered,
+                                                           variant)['Cache-Control']
+
+    # Ground track, if asked for; the response is sent without it on failure
+    if history_minutes:
+        track = get_track(location_info, history_minutes)
+        if track:
+            result = dict(result, track=track if cbor else track_json(track))
+
+    if cbor:
+        headers['Content-Type'] = 'application/cbor'
+        return (encode_cbor(result), 200, headers)
     return (jsonify(result), 200, headers)
+
+
+def _firmware_response(image_id):
+    """
+    Answers a firmware check from a device running the given image.
+
+    Args:
+        image_id (str): SHA-256 of the running image, as lowercase hex
+
+    Returns:
+        Response tuple: 200 with the patch file, 204 when up to date or
+        without a release, 400 for a malformed id
+    """
+    headers = {'Access-Control-Allow-Origin': '*'}
+    if not re.fullmatch(r'[0-9a-f]{64}', image_id):
+        headers['Content-Type'] = 'application/json'
+        return (jsonify({'error': 'Invalid firmware id'}), 400, headers)
+
+    manifest, patch = get_firmware_update(image_id)
+    headers['Cache-Control'] = f"max-age={FIRMWARE_CHECK_MAX_AGE_SECONDS}"
+    if not patch:
+        return ('', 204, headers)
+
+    logger.info(f"Firmware {manifest['version']} for image {image_id[:16]}: "
+                f"{len(patch)} bytes")
+    headers.update({
+        'Content-Type': 'application/octet-stream',
+        'X-Firmware-Version': str(manifest['version']),
+        'X-Firmware-Id': manifest['image_id']
+    })
+    return (patch, 200, headers)
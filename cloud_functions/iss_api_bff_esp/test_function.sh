@@ -13,6 +13,7 @@ source "$CONFIG_FILE"
 
 # Function-specific configuration
 FUNCTION_NAME="iss_api_bff_esp"
+STREAM_FUNCTION_NAME="iss_api_bff_esp_stream"
 
 # Colors for output
 GREEN='\033[0;32m'
@@ -112,8 +113,24 @@ done
 echo -e "\n${GREEN}✅ Latest ISS Location with Fun Fact:${NC}"
 echo "$BODY" | jq '.'
 
-# Test 4: CORS headers
-echo -e "\n${YELLOW}Test 4: CORS headers${NC}"
+# Test 4: Batched response
+echo -e "\n${YELLOW}Test 4: Batched response${NC}"
+echo "📡 Making request..."
+RESPONSE=$(curl -s -w "\n%{http_code}" "$FUNCTION_URL?api_key=$API_KEY&batch=3")
+HTTP_CODE=$(echo "$RESPONSE" | tail -n 1)
+BODY=$(echo "$RESPONSE" | sed '$d')
+
+if [ "$HTTP_CODE" -eq 200 ] && echo "$BODY" | jq -e '.fun_fact and (.upcoming | type == "array")' > /dev/null 2>&1; then
+    echo -e "${GREEN}✅ Test 4 passed: Batched response has $(echo "$BODY" | jq '.upcoming | length') upcoming items${NC}"
+else
+    echo -e "${RED}❌ Test 4 failed: Expected 200 with an upcoming list, got $HTTP_CODE${NC}"
+    echo "Response body:"
+    echo "$BODY"
+    exit 1
+fi
+
+# Test 5: CORS headers
+echo -e "\n${YELLOW}Test 5: CORS headers${NC}"
 echo "📡 Making request..."
 RESPONSE=$(curl -s -w "\n%{http_code}" -X OPTIONS -H "Origin: http://localhost" "$FUNCTION_URL")
 HTTP_CODE=$(echo "$RESPONSE" | tail -n 1)
@@ -123,12 +140,33 @@ if [ "$HTTP_CODE" -eq 204 ] && \
    echo "$HEADERS" | grep -i "access-control-allow-origin: *" > /dev/null && \
    echo "$HEADERS" | grep -i "access-control-allow-methods: GET" > /dev/null && \
    echo "$HEADERS" | grep -i "access-control-allow-headers: Content-Type" > /dev/null; then
-    echo -e "${GREEN}✅ Test 4 passed: CORS headers are correctly set${NC}"
+    echo -e "${GREEN}✅ Test 5 passed: CORS headers are correctly set${NC}"
 else
-    echo -e "${RED}❌ Test 4 failed: CORS headers are incorrect${NC}"
+    echo -e "${RED}❌ Test 5 failed: CORS headers are incorrect${NC}"
     echo "Headers:"
     echo "$HEADERS"
     exit 1
 fi
 
+# Test 6: Push stream opens with the current location, on the stream
+# service (deploy_stream.sh)
+echo -e "\n${YELLOW}Test 6: Push stream${NC}"
+STREAM_URL=$(gcloud functions describe $STREAM_FUNCTION_NAME --region=$REGION --format='get(serviceConfig.uri)' 2>/dev/null || true)
+if [ -z "$STREAM_URL" ]; then
+    echo -e "${YELLOW}⚠️  Test 6 skipped: $STREAM_FUNCTION_NAME is not deployed${NC}"
+    echo -e "\n${GREEN}✅ All tests passed successfully!${NC}"
+    exit 0
+fi
+echo "📡 Opening stream for 5 seconds..."
+STREAM=$(curl -s -N --max-time 5 -H "Accept: text/event-stream" "$STREAM_URL?api_key=$API_KEY&stream=1" || true)
+
+if echo "$STREAM" | grep -q "^event: location" && echo "$STREAM" | grep -q "^id: "; then
+    echo -e "${GREEN}✅ Test 6 passed: Stream announced the current location${NC}"
+else
+    echo -e "${RED}❌ Test 6 failed: No location event on the stream${NC}"
+    echo "Stream:"
+    echo "$STREAM"
+    exit 1
+fi
+
 echo -e "\n${GREEN}✅ All tests passed successfully!${NC}"
@@ -1,8 +1,20 @@
+import base64
+import hashlib
+import json
 import requests
 import logging
+import struct
+import threading
+import time
+import uuid
+from concurrent.futures import ThreadPoolExecutor
+from datetime import datetime, timedelta, timezone
+from email.utils import format_datetime, parsedate_to_datetime
 from google.auth.transport.requests import Request
 from google.oauth2 import id_token
+from google.cloud import firestore
 from google.cloud import secretmanager
+from google.cloud import storage
 
 # Configure logging
 logging.basicConfig(level=logging.INFO)
@@ -11,11 +23,149 @@ logger = logging.getLogger(__name__)
 # API URLs
 LAST_LOC_URL = "https://us-east1-iss-sky-scanner-20241222.cloudfunctions.net/iss_api_query_loc_history"
 FACT_URL = "https://iss-api-get-loc-fact-cklav7ht2q-ue.a.run.app"
+TLE_URL = "https://live.ariss.org/iss.txt"
+GEOCODE_URL = "https://api.bigdatacloud.net/data/reverse-geocode-client"
 
-def get_secret(secret_id):
+# Batched responses: the current location plus up to MAX_BATCH_SIZE - 1
+# predicted ones from iss_api_generate_predictions, one per store interval
+MAX_BATCH_SIZE = 12
+PREDICTIONS_COLLECTION = 'iss_loc_predictions'
+UPSTREAM_TIMEOUT_SECONDS = 10
+
+# Ground track (?history=MINUTES): the stored locations of the last
+# minutes, delta/varint encoded (see encode_track). Coordinates are sent in
+# hundredths of a degree, which the device keeps as int16.
+HISTORY_MAX_MINUTES = 180
+HISTORY_SCALE = 100
+TRACK_FORMAT_VERSION = 1
+
+# Facts cached per geographic cell and place name by iss_api_get_loc_fact
+# (its config.py FACT_CACHE_SETTINGS) and pre-warmed along the predicted
+# track by iss_api_generate_predictions. Read here directly, so a hit costs
+# one Firestore read instead of a call to the fact service.
+FACT_CACHE_COLLECTION = 'iss_fact_cells'
+FACT_CACHE_GEOHASH_PRECISION = 3
+GEOHASH_ALPHABET = '0123456789bcdefghjkmnpqrstuvwxyz'
+
+# Firestore client, created on first use and reused across invocations
+_firestore_client = None
+
+# Firmware updates (?firmware=IMAGE_ID): releases written by the display's
+# scripts/make_ota_patch.py to the config bucket. They are served from
+# here, so the device needs one host and one CA bundle for everything.
+FIRMWARE_BUCKET = 'iss-sky-scanner-config'
+FIRMWARE_PREFIX = 'firmware/iss_esp_display/'
+FIRMWARE_MANIFEST_CACHE_SECONDS = 5 * 60
+FIRMWARE_PATCH_CACHE_SECONDS = 60 * 60
+FIRMWARE_CHECK_MAX_AGE_SECONDS = 6 * 60 * 60
+_storage_client = None
+
+# ISS TLEs are refreshed a few times a day; keep one per instance for a while
+TLE_CACHE_SECONDS = 3 * 60 * 60
+_tle_cache = {'lines': None, 'fetched_at': 0.0}
+
+# iss_api_store_realtime_loc stores a new location every 5 minutes; the
+# grace period covers the store and query latency before it is visible
+STORE_INTERVAL_SECONDS = 300
+STORE_GRACE_SECONDS = 20
+MIN_MAX_AGE_SECONDS = 15
+MAX_AGE_FALLBACK_SECONDS = 60
+
+# Push stream (?stream=1): heartbeats keep idle connections open through
+# proxies, and streams end before the function timeout so clients reconnect
+LOCATION_COLLECTION = 'iss_loc_history'
+STREAM_HEARTBEAT_SECONDS = 25
+STREAM_MAX_SECONDS = 15 * 60
+STREAM_RETRY_MS = 10000
+# A new location is announced once its predictions are stored too, so a
+# batch fetched right away is complete; give up waiting after this long
+PREDICTIONS_WAIT_SECONDS = 45
+PREDICTIONS_CHECK_SECONDS = 3
+
+# In-process cache shared by concurrent requests on an instance. The API
+# key rarely changes; Google-signed ID tokens are valid for an hour.
+SECRET_CACHE_SECONDS = 5 * 60
+ID_TOKEN_CACHE_SECONDS = 50 * 60
+# A batch that came back short is retried sooner than a complete one
+PARTIAL_RESPONSE_CACHE_SECONDS = 60
+_cache = {}
+_cache_lock = threading.Lock()
+# Per-key load locks: key -> [lock, callers using it], guarded by _cache_lock
+_inflight_locks = {}
+
+# Instance identity for load tests (load_test.py): which instance served a
+# request, how long it had been up, and how many facts it has generated
+INSTANCE_ID = uuid.uuid4().hex[:12]
+_instance_started = time.time()
+_fact_calls = 0
+_fact_calls_lock = threading.Lock()
+
+
+def get_cached(key, ttl, loader):
+    """
+    Gets a value from the instance cache, loading it on a miss.
+
+    Loads are single-flight: concurrent callers missing the same key wait
+    for the first caller's load instead of repeating the upstream call.
+    A None result or an exception is not cached, so the next caller
+    tries again.
+
+    Args:
+        key (hashable): Cache key
+        ttl (float or callable): Seconds to keep the value, or a function
+            of the loaded value returning them
+        loader (callable): Loads the value on a miss
+
+    Returns:
+        The cached or freshly loaded value
+    """
+    with _cache_lock:
+        entry = _cache.get(key)
+        if entry and entry[1] > time.time():
+            return entry[0]
+        # Every caller of a key shares one lock until the last one is done
+        inflight = _inflight_locks.setdefault(key, [threading.Lock(), 0])
+        inflight[1] += 1
+
+    try:
+        with inflight[0]:
+            # Another caller may have loaded it while this one waited
+            with _cache_lock:
+                entry = _cache.get(key)
+                if entry and entry[1] > time.time():
+                    return entry[0]
+
+            value = loader()
+            if value is not None:
+                seconds = ttl(value) if callable(ttl) else ttl
+                with _cache_lock:
+                    now = time.time()
+                    # Drop expired entries, e.g. responses for old locations
+                    for stale in [k for k, e in _cache.items() if e[1] <= now]:
+                        del _cache[stale]
+                    _cache[key] = (value, now + seconds)
+            return value
+    finally:
+        with _cache_lock:
+            inflight[1] -= 1
+            if inflight[1] == 0:
+                del _inflight_locks[key]
+
+
+def set_cached(key, value, ttl):
     """
-    Gets a secret from Secret Manager.
+    Stores a value in the instance cache, replacing any current one.
+
+    Args:
+        key (hashable): Cache key
+        value: Value to store
+        ttl (float): Seconds to keep it
     """
+    with _cache_lock:
+        _cache[key] = (value, time.time() + ttl)
+
+def _load_secret(secret_id):
+    """Reads a secret from Secret Manager."""
     try:
         client = secretmanager.SecretManagerServiceClient()
         name = f"projects/iss-sky-scanner-20241222/secrets/{secret_id}/versions/latest"
@@ -25,6 +175,14 @@ def get_secret(secret_id):
         logger.error(f"Error getting secret: {str(e)}")
         raise
 
+
+def get_secret(secret_id):
+    """
+    Gets a secret from Secret Manager, cached per instance.
+    """
+    return get_cached(('secret', secret_id), SECRET_CACHE_SECONDS,
+                      lambda: _load_secret(secret_id))
+
 def validate_api_key(api_key):
     """
     Validates the provided API key against the stored secret.
@@ -36,26 +194,58 @@ def validate_api_key(api_key):
         logger.error(f"Error validating API key: {str(e)}")
         return False
 
-def get_id_token(target_url):
-    """
-    Gets an ID token for authenticating with other Cloud Functions.
-    """
+def _fetch_id_token(target_url):
+    """Fetches a new ID token for a target audience."""
     try:
         return id_token.fetch_id_token(Request(), target_url)
     except Exception as e:
         logger.error(f"Error getting ID token: {str(e)}")
         raise
 
-def get_iss_location_with_fact():
+
+def get_id_token(target_url):
     """
-    Gets the latest ISS location and a fun fact about that location.
-    Combines data from iss_api_query_loc_history (with limit=1) and iss_api_get_loc_fact.
-    
+    Gets an ID token for authenticating with other Cloud Functions.
+    Tokens are cached per audience until shortly before they expire.
+    """
+    return get_cached(('id_token', target_url), ID_TOKEN_CACHE_SECONDS,
+                      lambda: _fetch_id_token(target_url))
+
+def get_iss_tle():
+    """
+    Gets the current ISS two-line element set, cached per instance.
+
+    The ESP propagates the position from it between polls. A failed
+    fetch falls back to the last cached TLE.
+
     Returns:
-        dict: Combined location data and fun fact
+        tuple: (tle_line1, tle_line2), or None if no TLE is available
     """
+    now = time.time()
+    if (_tle_cache['lines']
+            and now - _tle_cache['fetched_at'] < TLE_CACHE_SECONDS):
+        return _tle_cache['lines']
+
+    try:
+        logger.info("Fetching ISS TLE...")
+        response = requests.get(TLE_URL, timeout=10)
+        response.raise_for_status()
+        lines = [line.strip() for line in response.text.strip().split('\n')]
+        if len(lines) < 3:
+            logger.warning("Invalid TLE format")
+        else:
+            # Skip line 0, which is the satellite name
+            _tle_cache['lines'] = (lines[1], lines[2])
+            _tle_cache['fetched_at'] = now
+    except Exception as e:
+        logger.error(f"Error fetching TLE: {str(e)}")
+
+    return _tle_cache['lines']
+
+
+def _fetch_latest_location():
+    """Queries iss_api_query_loc_history for the newest location."""
     try:
-        # Get latest ISS location
         logger.info("Fetching latest ISS location...")
         token = get_id_token(LAST_LOC_URL)
         headers = {"Authorization": f"Bearer {token}"}
@@ -71,23 +261,836 @@ def get_iss_location_with_fact():
         if not location_data.get('locations') or len(location_data['locations']) == 0:
             logger.error("No location data found")
             return None
-            
-        location_info = location_data['locations'][0]
 
-        # Get fun fact about the location
-        location = location_info.get('location')
-        logger.info(f"Fetching fun fact for location: {location}")
-        token = get_id_token(FACT_URL)  # Get a new token for the fact API
-        headers = {"Authorization": f"Bearer {token}"}
-        fact_response = requests.get(f"{FACT_URL}?location={location}", headers=headers)
-        fact_response.raise_for_status()
-        fact_data = fact_response.json()
+        return location_data['locations'][0]
+
+    except Exception as e:
+        logger.error(f"Error getting latest ISS location: {str(e)}")
+        return None
+
+
+def get_latest_location():
+    """
+    Gets the latest stored ISS location from iss_api_query_loc_history.
+
+    The record is cached until the next location is expected, so polls
+    arriving together share one query. The returned dict is shared and
+    must not be modified.
+
+    Returns:
+        dict: The location record, or None on failure
+    """
+    return get_cached('latest_location',
+                      seconds_until_next_location,
+                      _fetch_latest_location)
+
+
+def geohash(latitude, longitude, precision):
+    """Encodes a position as a geohash of the given length."""
+    lat_range = [-90.0, 90.0]
+    lon_range = [-180.0, 180.0]
+    code = []
+    bits = 0
+    bit_count = 0
+    even = True  # Bits alternate between longitude and latitude
+    while len(code) < precision:
+        value, bounds = (longitude, lon_range) if even else (latitude, lat_range)
+        middle = (bounds[0] + bounds[1]) / 2
+        bits <<= 1
+        if value >= middle:
+            bits |= 1
+            bounds[0] = middle
+        else:
+            bounds[1] = middle
+        even = not even
+        bit_count += 1
+        if bit_count == 5:
+            code.append(GEOHASH_ALPHABET[bits])
+            bits = bit_count = 0
+    return ''.join(code)
+
+
+def get_cached_fact(latitude, longitude, location):
+    """
+    Looks up a fact in the cell cache of iss_api_get_loc_fact.
+
+    The document id is the place's cell plus a hash of its name, as in
+    iss_api_get_loc_fact/utils.py fact_cache_document_id().
+
+    Returns:
+        str: The fact, or None on a miss, an expired entry or an error
+    """
+    try:
+        cell = geohash(latitude, longitude, FACT_CACHE_GEOHASH_PRECISION)
+        name_hash = hashlib.sha1(location.encode('utf-8')).hexdigest()[:12]
+        doc = (_get_firestore_client().collection(FACT_CACHE_COLLECTION)
+               .document(f"{cell}-{name_hash}").get())
+        if not doc.exists:
+            return None
+        entry = doc.to_dict()
+        if (entry.get('location') != location
+                or entry.get('expires_at') <= datetime.now(timezone.utc)):
+            return None
+        return entry.get('fact')
+    except Exception as e:
+        logger.warning(f"Fact cache lookup failed for {location}: {str(e)}")
+        return None
+
+
+def get_location_fact(location, latitude=None, longitude=None):
+    """
+    Gets a fun fact about a location.
+
+    With a position, the cell cache is tried first; iss_api_get_loc_fact
+    is called only on a miss, and caches the fact it generates.
 
-        # Combine the data
-        location_info['fun_fact'] = fact_data.get('fact', 'Fun fact coming soon!')
+    Args:
+        location (str): Location name, e.g. "Paris, France"
+        latitude (float): Position of the place, if known
+        longitude (float): Position of the place, if known
+
+    Returns:
+        str: The fact
+
+    Raises:
+        Exception: If the fact service fails
+    """
+    global _fact_calls
+    params = {'location': location}
+    try:
+        position = (float(latitude), float(longitude))
+    except (TypeError, ValueError):
+        position = None
+    if position:
+        fact = get_cached_fact(position[0], position[1], location)
+        if fact:
+            return fact
+        params.update(latitude=position[0], longitude=position[1])
+
+    logger.info(f"Fetching fun fact for location: {location}")
+    with _fact_calls_lock:
+        _fact_calls += 1
+    token = get_id_token(FACT_URL)  # Get a new token for the fact API
+    headers = {"Authorization": f"Bearer {token}"}
+    fact_response = requests.get(FACT_URL, params=params,
+                                 headers=headers, timeout=UPSTREAM_TIMEOUT_SECONDS)
+    fact_response.raise_for_status()
+    return fact_response.json().get('fact', 'Fun fact coming soon!')
+
+
+def add_location_fact(location_info):
+    """
+    Adds a fun fact about the location, plus the TLE, to a location record.
+
+    Args:
+        location_info (dict): Record from get_latest_location()
+
+    Returns:
+        dict: The combined record, or None on failure
+    """
+    try:
+        # Combine the data; the input may be the shared cached record
+        location_info = dict(location_info)
+        location_info['fun_fact'] = get_location_fact(location_info.get('location'),
+                                                      location_info.get('latitude'),
+                                                      location_info.get('longitude'))
         location_info['status'] = 'success'  # Add status field for backward compatibility
+
+        # Orbit for on-device propagation between polls (optional)
+        tle = get_iss_tle()
+        if tle:
+            location_info['tle_line1'], location_info['tle_line2'] = tle
         return location_info
 
     except Exception as e:
         logger.error(f"Error getting ISS location with fact: {str(e)}")
         return None
+
+
+def instance_headers(request_started):
+    """
+    Gets the headers that tell a load test about the serving instance.
+
+    The uptime is measured from module import, so an uptime shorter than
+    the client's latency means the request waited for a cold start. The
+    fact count covers the instance's whole life and counts the calls to
+    iss_api_get_loc_fact, i.e. cell cache misses; it calls Gemini for
+    each unless the fact was cached meanwhile.
+
+    Args:
+        request_started (float): time.time() when the request arrived
+
+    Returns:
+        dict: X-Instance-Id, X-Instance-Uptime, X-Instance-Facts and
+              Server-Timing (app duration in ms)
+    """
+    now = time.time()
+    with _fact_calls_lock:
+        fact_calls = _fact_calls
+    return {
+        'X-Instance-Id': INSTANCE_ID,
+        'X-Instance-Uptime': f"{now - _instance_started:.3f}",
+        'X-Instance-Facts': str(fact_calls),
+        'Server-Timing': f"app;dur={(now - request_started) * 1000:.1f}"
+    }
+
+
+def get_iss_location_with_fact():
+    """
+    Gets the latest ISS location and a fun fact about that location.
+    Combines data from iss_api_query_loc_history (with limit=1) and iss_api_get_loc_fact.
+
+    Returns:
+        dict: Combined location data and fun fact
+    """
+    location_info = get_latest_location()
+    if not location_info:
+        return None
+    return add_location_fact(location_info)
+
+
+def _get_firestore_client():
+    """Get or create the Firestore client."""
+    global _firestore_client
+    if _firestore_client is None:
+        _firestore_client = firestore.Client()
+    return _firestore_client
+
+
+def _prediction_document_id(location_info):
+    """
+    Gets the iss_loc_predictions document for a location record.
+
+    Returns:
+        str: The document id, or None if the timestamp is invalid
+    """
+    stamp = parse_location_time(location_info)
+    if not stamp:
+        return None
+    return stamp.replace(minute=stamp.minute - stamp.minute % 5,
+                         second=0, microsecond=0).isoformat()
+
+
+def get_predicted_positions(location_info, count):
+    """
+    Gets the predicted positions that follow a stored location.
+
+    iss_api_generate_predictions stores them per source location, keyed
+    by its timestamp rounded down to 5 minutes.
+
+    Args:
+        location_info (dict): Record from get_latest_location()
+        count (int): Maximum number of positions
+
+    Returns:
+        list: Predictions ordered by time, each with timestamp,
+              timestamp_unix, latitude and longitude; empty on failure
+    """
+    document_id = _prediction_document_id(location_info)
+    if not document_id or count <= 0:
+        return []
+    try:
+        doc = (_get_firestore_client().collection(PREDICTIONS_COLLECTION)
+               .document(document_id).get())
+        if not doc.exists:
+            logger.warning(f"No predictions for {document_id}")
+            return []
+        predictions = [p for p in doc.to_dict().get('predictions', [])
+                       if p.get('method', 'orbital_mechanics') == 'orbital_mechanics']
+        predictions.sort(key=lambda p: p.get('minutes_ahead', 0))
+        return predictions[:count]
+    except Exception as e:
+        logger.error(f"Error getting predictions: {str(e)}")
+        return []
+
+
+def describe_position(latitude, longitude):
+    """
+    Names the place below a position, like iss_api_get_realtime_loc.
+
+    Returns:
+        str: "Locality, Region, Country" or "Over the <ocean>", or None
+             on failure
+    """
+    try:
+        response = requests.get(GEOCODE_URL, params={
+            'latitude': latitude,
+            'longitude': longitude,
+            'localityLanguage': 'en'
+        }, timeout=UPSTREAM_TIMEOUT_SECONDS)
+        response.raise_for_status()
+        data = response.json()
+    except Exception as e:
+        logger.error(f"Error reverse geocoding {latitude}, {longitude}: {str(e)}")
+        return None
+
+    for info in data.get('localityInfo', {}).get('informative', []):
+        name = info.get('name', '')
+        if any(keyword in name.lower() for keyword in ('ocean', 'sea')):
+            return f"Over the {name}"
+
+    components = [data.get('locality') or data.get('city'),
+                  data.get('principalSubdivision'), data.get('countryName')]
+    components = [c for c in components if c]
+    return ", ".join(components) if components else "Over Ocean"
+
+
+def _build_upcoming_item(prediction):
+    """
+    Names a predicted position and adds a fact about it.
+
+    Returns:
+        dict: The playback item, or None on failure
+    """
+    latitude = prediction.get('latitude')
+    longitude = prediction.get('longitude')
+    location = describe_position(latitude, longitude)
+    if not location:
+        return None
+    try:
+        fact = get_location_fact(location, latitude, longitude)
+    except Exception as e:
+        logger.error(f"Error getting fact for {location}: {str(e)}")
+        return None
+    return {
+        'timestamp': prediction.get('timestamp'),
+        'timestamp_unix': prediction.get('timestamp_unix'),
+        'latitude': latitude,
+        'longitude': longitude,
+        'location': location,
+        'fun_fact': fact
+    }
+
+
+def get_upcoming_items(location_info, count):
+    """
+    Builds the playback items for the positions after a stored location.
+
+    Places and facts are looked up in parallel. The list stops at the
+    first item that could not be built, so the device never has a gap
+    in its playback.
+
+    Args:
+        location_info (dict): Record from get_latest_location()
+        count (int): Maximum number of items
+
+    Returns:
+        list: Items ordered by time, each with timestamp, timestamp_unix,
+              latitude, longitude, location and fun_fact
+    """
+    predictions = get_predicted_positions(location_info, count)
+    if not predictions:
+        return []
+    with ThreadPoolExecutor(max_workers=len(predictions)) as executor:
+        items = list(executor.map(_build_upcoming_item, predictions))
+    if None in items:
+        items = items[:items.index(None)]
+    logger.info(f"Built {len(items)} of {len(predictions)} upcoming items")
+    return items
+
+
+def _compose_response(location_info, batch_size):
+    """Builds the response body for get_response()."""
+    result = add_location_fact(location_info)
+    if result and batch_size > 1:
+        result['upcoming'] = get_upcoming_items(location_info, batch_size - 1)
+    return result
+
+
+def get_response(location_info, batch_size=1):
+    """
+    Gets the response body for a location and batch size.
+
+    Bodies are cached per location and batch size (the JSON and CBOR
+    encodings share one), and built single-flight: when a fleet polls on
+    the same store boundary, one request generates the facts and the rest
+    wait for it. The returned dict is shared and must not be modified.
+
+    Args:
+        location_info (dict): Record from get_latest_location()
+        batch_size (int): Items to cover, see get_upcoming_items()
+
+    Returns:
+        dict: Location, fact and TLE, plus 'upcoming' for a batch;
+              None on failure
+    """
+    def ttl(result):
+        covered = 1 + len(result.get('upcoming', []))
+        if batch_size > 1 and covered < batch_size:
+            return PARTIAL_RESPONSE_CACHE_SECONDS
+        return batch_size * STORE_INTERVAL_SECONDS + STORE_GRACE_SECONDS
+
+    key = ('response', str(location_info.get('timestamp')), batch_size)
+    return get_cached(key, ttl,
+                      lambda: _compose_response(location_info, batch_size))
+
+
+def parse_location_time(location_info):
+    """
+    Parses the timestamp of a location record.
+
+    Returns:
+        datetime: Timezone-aware UTC time, or None if missing or invalid
+    """
+    try:
+        stamp = datetime.fromisoformat(
+            str(location_info.get('timestamp')).replace('Z', '+00:00'))
+    except ValueError:
+        return None
+    if stamp.tzinfo is None:
+        stamp = stamp.replace(tzinfo=timezone.utc)
+    return stamp.astimezone(timezone.utc)
+
+
+def seconds_until_next_location(location_info, batch_size=1):
+    """
+    Estimates how long a location record stays current.
+
+    Args:
+        location_info (dict): Record from get_latest_location()
+        batch_size (int): Items covered, one per store interval
+
+    Returns:
+        int: Seconds until the location after the covered ones is
+             expected, within MIN_MAX_AGE_SECONDS and one batch
+    """
+    covered_seconds = batch_size * STORE_INTERVAL_SECONDS
+    stamp = parse_location_time(location_info)
+    remaining = MAX_AGE_FALLBACK_SECONDS
+    if stamp:
+        next_update = (stamp + timedelta(seconds=covered_seconds
+                                         + STORE_GRACE_SECONDS))
+        seconds = (next_update - datetime.now(timezone.utc)).total_seconds()
+        if seconds > 0:
+            remaining = int(seconds)
+    return max(MIN_MAX_AGE_SECONDS,
+               min(remaining, covered_seconds + STORE_GRACE_SECONDS))
+
+
+def build_cache_headers(location_info, batch_size=1, variant=None):
+    """
+    Builds the validators and freshness hint for a location record.
+
+    The ETag and Last-Modified follow the stored location, which changes
+    every STORE_INTERVAL_SECONDS. max-age tells the device how long until
+    the next location (and so the next fact) is expected, or for a batch,
+    until its last item has been shown.
+
+    Args:
+        location_info (dict): Record from get_latest_location()
+        batch_size (int): Items the response covers, one per store interval
+        variant (str): Body format other than JSON (e.g. 'cbor'), so each
+            representation gets its own ETag
+
+    Returns:
+        dict: ETag, Last-Modified and Cache-Control headers
+    """
+    stamp = parse_location_time(location_info)
+    key = str(location_info.get('timestamp'))
+    if batch_size > 1:
+        key += f":{batch_size}"
+    if variant:
+        key += f":{variant}"
+    etag = '"' + hashlib.sha1(key.encode('utf-8')).hexdigest()[:16] + '"'
+    headers = {'ETag': etag}
+    if stamp:
+        headers['Last-Modified'] = format_datetime(stamp, usegmt=True)
+    max_age = seconds_until_next_location(location_info, batch_size)
+    headers['Cache-Control'] = f'private, max-age={max_age}'
+    return headers
+
+
+def is_not_modified(request_headers, cache_headers):
+    """
+    Checks a conditional request against the current validators.
+    If-None-Match takes precedence over If-Modified-Since (RFC 9110).
+
+    Returns:
+        bool: True if the client's copy is current
+    """
+    if_none_match = request_headers.get('If-None-Match')
+    if if_none_match:
+        tags = [tag.strip() for tag in if_none_match.split(',')]
+        return cache_headers['ETag'] in tags or '*' in tags
+
+    if_modified_since = request_headers.get('If-Modified-Since')
+    last_modified = cache_headers.get('Last-Modified')
+    if if_modified_since and last_modified:
+        try:
+            return (parsedate_to_datetime(last_modified)
+                    <= parsedate_to_datetime(if_modified_since))
+        except (TypeError, ValueError):
+            return False
+    return False
+
+
+def _fetch_location_history(location_info, minutes):
+    """Queries iss_api_query_loc_history for the stored track."""
+    end = parse_location_time(location_info)
+    if not end:
+        return None
+    # Prefix without a zone, so it compares below every stored timestamp
+    # of that second whichever format it was written in
+    start = (end - timedelta(minutes=minutes)).strftime('%Y-%m-%dT%H:%M:%S')
+    try:
+        token = get_id_token(LAST_LOC_URL)
+        response = requests.get(LAST_LOC_URL, params={
+            'start_time': start,
+            'order_direction': 'ASCENDING',
+            'limit': minutes * 60 // STORE_INTERVAL_SECONDS + 1
+        }, headers={"Authorization": f"Bearer {token}"},
+            timeout=UPSTREAM_TIMEOUT_SECONDS)
+        response.raise_for_status()
+        data = response.json()
+    except Exception as e:
+        logger.error(f"Error getting location history: {str(e)}")
+        return None
+    if data.get('status') != 'success':
+        logger.error(f"Error getting location history: {data}")
+        return None
+
+    points = []
+    for record in data.get('locations') or []:
+        stamp = parse_location_time(record)
+        try:
+            latitude = float(record.get('latitude'))
+            longitude = float(record.get('longitude'))
+        except (TypeError, ValueError):
+            continue  # Error entries share the collection
+        if stamp and stamp <= end:
+            points.append((int(stamp.timestamp()), latitude, longitude))
+    return encode_track(points)
+
+
+def get_track(location_info, minutes):
+    """
+    Gets the encoded ground track that ends at a stored location.
+
+    Cached per location and window, like the response bodies, so a fleet
+    costs one history query per store interval.
+
+    Args:
+        location_info (dict): Record from get_latest_location()
+        minutes (int): Window before the location, up to HISTORY_MAX_MINUTES
+
+    Returns:
+        bytes: See encode_track(); None on failure
+    """
+    key = ('track', str(location_info.get('timestamp')), minutes)
+    return get_cached(key, lambda track: seconds_until_next_location(location_info),
+                      lambda: _fetch_location_history(location_info, minutes))
+
+
+def encode_track(points, step=STORE_INTERVAL_SECONDS):
+    """
+    Encodes a ground track as a compact delta/varint stream.
+
+    Layout (varints are unsigned LEB128, signed values zigzag encoded):
+        version     1 byte, TRACK_FORMAT_VERSION
+        count       varint, number of points
+        step        varint, seconds between samples
+        start       varint, Unix time of the first point
+        per point:
+          gap       varint, steps since the previous point (0 for the first)
+          latitude  signed varint, hundredths of a degree; a delta from
+                    the previous point after the first
+          longitude signed varint, likewise; deltas wrap at the
+                    antimeridian into [-18000, 18000)
+
+    A 90-minute track of 5-minute samples takes about 100 bytes.
+
+    Args:
+        points (list): (unix_time, latitude, longitude) tuples, oldest first
+        step (int): Sample interval in seconds
+
+    Returns:
+        bytes: The encoded track
+    """
+    def varint(value):
+        out = bytearray()
+        while True:
+            byte = value & 0x7f
+            value >>= 7
+            if value:
+                out.append(byte | 0x80)
+            else:
+                out.append(byte)
+                return bytes(out)
+
+    def signed(value):
+        return varint(value * 2 if value >= 0 else -value * 2 - 1)
+
+    full_turn = 360 * HISTORY_SCALE
+    body = bytearray()
+    start = points[0][0] if points else 0
+    previous = None
+    for stamp, latitude, longitude in points:
+        lat = round(latitude * HISTORY_SCALE)
+        lon = round(longitude * HISTORY_SCALE)
+        if previous is None:
+            body += varint(0) + signed(lat) + signed(lon)
+        else:
+            gap = max(1, round((stamp - previous[0]) / step))
+            delta_lon = (lon - previous[2] + full_turn // 2) % full_turn - full_turn // 2
+            body += varint(gap) + signed(lat - previous[1]) + signed(delta_lon)
+        previous = (stamp, lat, lon)
+    header = (bytes([TRACK_FORMAT_VERSION]) + varint(len(points)) + varint(step)
+              + varint(start))
+    return header + bytes(body)
+
+
+def track_json(track):
+    """
+    Returns:
+        str: An encoded track as base64, for JSON responses
+    """
+    return base64.b64encode(track).decode('ascii')
+
+
+def encode_cbor(value):
+    """
+    Encodes a JSON-like value as CBOR (RFC 8949) for the ESP.
+
+    Uses definite lengths only, which is what the device's decoder
+    supports. Floats are sent in single precision, the precision the
+    device keeps anyway.
+
+    Args:
+        value: dict, list, str, bytes, int, float, bool, None or datetime
+
+    Returns:
+        bytes: The encoded value
+
+    Raises:
+        TypeError: For any other type
+    """
+    def head(major, argument):
+        if argument < 24:
+            return bytes([major << 5 | argument])
+        for info, fmt in ((24, '>B'), (25, '>H'), (26, '>I'), (27, '>Q')):
+            if argument < 1 << (8 * struct.calcsize(fmt)):
+                return bytes([major << 5 | info]) + struct.pack(fmt, argument)
+        raise ValueError("Integer too large for CBOR")
+
+    # bool first: it is a subclass of int
+    if value is None:
+        return b'\xf6'
+    if isinstance(value, bool):
+        return b'\xf5' if value else b'\xf4'
+    if isinstance(value, int):
+        return head(0, value) if value >= 0 else head(1, -1 - value)
+    if isinstance(value, float):
+        return b'\xfa' + struct.pack('>f', value)
+    if isinstance(value, str):
+        encoded = value.encode('utf-8')
+        return head(3, len(encoded)) + encoded
+    if isinstance(value, (bytes, bytearray)):
+        return head(2, len(value)) + bytes(value)
+    if isinstance(value, (list, tuple)):
+        return head(4, len(value)) + b''.join(encode_cbor(v) for v in value)
+    if isinstance(value, dict):
+        return head(5, len(value)) + b''.join(
+            encode_cbor(str(k)) + encode_cbor(v) for k, v in value.items())
+    if isinstance(value, datetime):
+        return encode_cbor(value.isoformat())
+    raise TypeError(f"Cannot encode {type(value).__name__} as CBOR")
+
+
+def accepts_cbor(request_headers):
+    """
+    Checks whether the client asked for a CBOR response.
+
+    Returns:
+        bool: True if the Accept header lists application/cbor with a
+              non-zero quality
+    """
+    for entry in request_headers.get('Accept', '').split(','):
+        parts = [part.strip() for part in entry.split(';')]
+        if parts[0].lower() != 'application/cbor':
+            continue
+        for param in parts[1:]:
+            if param.replace(' ', '') in ('q=0', 'q=0.0', 'q=0.00', 'q=0.000'):
+                return False
+        return True
+    return False
+
+
+# Newest location seen by the Firestore watch, and a generation count that
+# stream requests wait on
+_push_condition = threading.Condition()
+_push_state = {'generation': 0, 'record': None, 'pending': None}
+_location_watch = None
+
+
+def _publish_location(record):
+    """
+    Announces a new location to the waiting streams.
+
+    Waits (in its own thread) for the location's predictions first, then
+    primes the location cache so the fetch each device makes in response
+    sees the new record straight away.
+    """
+    document_id = _prediction_document_id(record)
+    deadline = time.time() + PREDICTIONS_WAIT_SECONDS
+    while document_id and time.time() < deadline:
+        try:
+            if (_get_firestore_client().collection(PREDICTIONS_COLLECTION)
+                    .document(document_id).get().exists):
+                break
+        except Exception as e:
+            logger.error(f"Error checking predictions: {str(e)}")
+        time.sleep(PREDICTIONS_CHECK_SECONDS)
+
+    set_cached('latest_location', record, seconds_until_next_location(record))
+    with _push_condition:
+        _push_state['generation'] += 1
+        _push_state['record'] = record
+        _push_condition.notify_all()
+    logger.info(f"Pushed location {record.get('timestamp')}")
+
+
+def _on_location_snapshot(snapshots, changes, read_time):
+    """Firestore watch callback for the newest iss_loc_history document."""
+    for snapshot in snapshots:
+        record = snapshot.to_dict()
+        # Error entries share the collection; only announce real locations
+        if record.get('latitude') is None:
+            continue
+        current = _push_state['record'] or {}
+        if record.get('timestamp') in (current.get('timestamp'), _push_state['pending']):
+            continue
+        _push_state['pending'] = record.get('timestamp')
+        threading.Thread(target=_publish_location, args=(record,),
+                         daemon=True).start()
+
+
+def _ensure_location_watch():
+    """Starts the instance's Firestore watch on first use."""
+    global _location_watch
+    with _push_condition:
+        if _location_watch is None:
+            query = (_get_firestore_client().collection(LOCATION_COLLECTION)
+                     .order_by('timestamp', direction=firestore.Query.DESCENDING)
+                     .limit(1))
+            _location_watch = query.on_snapshot(_on_location_snapshot)
+            logger.info("Started location watch")
+
+
+def _format_event(record):
+    """Formats a location as a server-sent event."""
+    stamp = str(record.get('timestamp'))
+    data = json.dumps({
+        'timestamp': stamp,
+        'latitude': record.get('latitude'),
+        'longitude': record.get('longitude'),
+        'location': record.get('location')
+    }, default=str)
+    return f"event: location\nid: {stamp}\ndata: {data}\n\n"
+
+
+def stream_location_events(last_event_id=None):
+    """
+    Yields server-sent events announcing each new stored location.
+
+    All streams on an instance share one Firestore watch, so a location
+    costs one read however many devices listen. The newest location is
+    sent first unless it matches the client's Last-Event-ID; comment
+    lines keep the connection alive in between. The stream ends after
+    STREAM_MAX_SECONDS and the client reconnects.
+
+    Args:
+        last_event_id (str): Timestamp of the last location the client saw
+
+    Yields:
+        str: Event stream text
+    """
+    _ensure_location_watch()
+    yield f"retry: {STREAM_RETRY_MS}\n\n"
+
+    with _push_condition:
+        generation = _push_state['generation']
+        record = _push_state['record']
+    if record and str(record.get('timestamp')) != last_event_id:
+        yield _format_event(record)
+
+    deadline = time.time() + STREAM_MAX_SECONDS
+    while time.time() < deadline:
+        with _push_condition:
+            _push_condition.wait_for(
+                lambda: _push_state['generation'] != generation,
+                timeout=min(STREAM_HEARTBEAT_SECONDS, deadline - time.time()))
+            changed = _push_state['generation'] != generation
+            generation = _push_state['generation']
+            record = _push_state['record']
+        yield _format_event(record) if changed else ": keepalive\n\n"
+
+
+def _get_storage_client():
+    """Get or create the Cloud Storage client."""
+    global _storage_client
+    if _storage_client is None:
+        _storage_client = storage.Client()
+    return _storage_client
+
+
+def _download_firmware_blob(name):
+    """
+    Reads a file of the firmware release from the bucket.
+
+    Args:
+        name (str): Path below FIRMWARE_PREFIX
+
+    Returns:
+        bytes: The file, or None if it does not exist or cannot be read
+    """
+    try:
+        blob = _get_storage_client().bucket(FIRMWARE_BUCKET).blob(FIRMWARE_PREFIX + name)
+        return blob.download_as_bytes()
+    except Exception as e:
+        logger.info(f"No firmware file {name}: {str(e)}")
+        return None
+
+
+def get_firmware_manifest():
+    """
+    Gets the manifest of the current firmware release, cached per instance.
+
+    Returns:
+        dict: latest.json (version, image_id, size, patches), or None if
+              there is no release
+    """
+    def load():
+        data = _download_firmware_blob('latest.json')
+        return json.loads(data) if data else None
+
+    return get_cached(('firmware', 'manifest'), FIRMWARE_MANIFEST_CACHE_SECONDS, load)
+
+
+def get_firmware_update(image_id):
+    """
+    Gets the update for a device running the given image.
+
+    A patch from that image is preferred; an image the release has no patch
+    for (e.g. one flashed over USB) gets the full image instead. Both are
+    cached per instance, so a fleet updating together reads each file once.
+
+    Args:
+        image_id (str): SHA-256 of the running image, as hex
+
+    Returns:
+        tuple: (manifest, patch file bytes), or (manifest, None) if the
+               device is up to date, or (None, None) without a release
+    """
+    manifest = get_firmware_manifest()
+    if not manifest or manifest.get('image_id') == image_id:
+        return manifest, None
+
+    release = manifest['image_id']
+    if image_id in manifest.get('patches', {}):
+        patch = get_cached(('firmware', release, image_id), FIRMWARE_PATCH_CACHE_SECONDS,
+                           lambda: _download_firmware_blob(f"patches/{image_id}.issd"))
+        if patch:
+            return manifest, patch
+    full = get_cached(('firmware', release, 'full'), FIRMWARE_PATCH_CACHE_SECONDS,
+                      lambda: _download_firmware_blob('full.issd'))
+    return (manifest, full) if full else (None, None)
@@ -5,6 +5,9 @@ from typing import Dict, Any, List, Optional, Tuple
 from google.cloud import firestore
 from datetime import datetime, timezone, timedelta
 from collections import OrderedDict
+from concurrent.futures import ThreadPoolExecutor
+from google.auth.transport.requests import Request
+from google.oauth2 import id_token
 from skyfield.api import load, EarthSatellite
 
 # Configure logging
@@ -29,6 +32,15 @@ DEFAULT_TIME_INTERVAL = 5.0  # minutes between data points
 # Earth rotation rate
 EARTH_ROTATION_RATE = 360 / (24 * 60)  # degrees per minute = 0.25
 
+# Fact pre-warming: the positions a batched iss_api_bff_esp response can
+# cover (its MAX_BATCH_SIZE - 1) are named and sent to iss_api_get_loc_fact,
+# which caches a fact per cell and place (or answers from its cache)
+FACT_URL = "https://iss-api-get-loc-fact-cklav7ht2q-ue.a.run.app"
+GEOCODE_URL = "https://api.bigdatacloud.net/data/reverse-geocode-client"
+PREWARM_COUNT = 11
+GEOCODE_TIMEOUT_SECONDS = 5
+FACT_TIMEOUT_SECONDS = 8  # With the geocode, stays within the caller's 30 s
+
 
 def fetch_tle_data() -> Optional[Tuple[str, str]]:
     """
@@ -288,6 +300,87 @@ def predict_position(current_lat: float, current_lon: float,
     }
 
 
+def describe_position(latitude: float, longitude: float) -> Optional[str]:
+    """
+    Names the place below a position, like iss_api_bff_esp does for its
+    upcoming items, so the pre-warmed facts are cached under the same name.
+    
+    Returns:
+        "Locality, Region, Country" or "Over the <ocean>", or None on failure
+    """
+    try:
+        response = requests.get(GEOCODE_URL, params={
+            'latitude': latitude,
+            'longitude': longitude,
+            'localityLanguage': 'en'
+        }, timeout=GEOCODE_TIMEOUT_SECONDS)
+        response.raise_for_status()
+        data = response.json()
+    except Exception as e:
+        logger.error(f"Error reverse geocoding {latitude}, {longitude}: {str(e)}")
+        return None
+
+    for info in data.get('localityInfo', {}).get('informative', []):
+        name = info.get('name', '')
+        if any(keyword in name.lower() for keyword in ('ocean', 'sea')):
+            return f"Over the {name}"
+
+    components = [data.get('locality') or data.get('city'),
+                  data.get('principalSubdivision'), data.get('countryName')]
+    components = [c for c in components if c]
+    return ", ".join(components) if components else "Over Ocean"
+
+
+def prewarm_fact(prediction: Dict[str, Any], token: str) -> bool:
+    """
+    Makes sure the fact cache has a fact for one predicted position.
+    
+    Returns:
+        True if iss_api_get_loc_fact answered from its cache or cached a new fact
+    """
+    latitude = prediction['latitude']
+    longitude = prediction['longitude']
+    location = describe_position(latitude, longitude)
+    if not location:
+        return False
+    try:
+        response = requests.get(FACT_URL, params={
+            'location': location,
+            'latitude': latitude,
+            'longitude': longitude
+        }, headers={'Authorization': f'Bearer {token}'}, timeout=FACT_TIMEOUT_SECONDS)
+        response.raise_for_status()
+        return 'debug' not in response.json()  # Fallback texts are not cached
+    except Exception as e:
+        logger.warning(f"Failed to pre-warm the fact for {location}: {str(e)}")
+        return False
+
+
+def prewarm_facts(predictions: List[Dict[str, Any]]) -> int:
+    """
+    Pre-warms the fact cache along the predicted ground track, in parallel.
+    
+    Non-critical: iss_api_bff_esp asks for any fact that is still missing.
+    
+    Args:
+        predictions: Predicted positions, nearest first
+        
+    Returns:
+        Number of positions whose fact is cached
+    """
+    if not predictions:
+        return 0
+    try:
+        token = id_token.fetch_id_token(Request(), FACT_URL)
+    except Exception as e:
+        logger.warning(f"Skipping fact pre-warming, no ID token: {str(e)}")
+        return 0
+    with ThreadPoolExecutor(max_workers=len(predictions)) as executor:
+        warmed = sum(executor.map(lambda p: prewarm_fact(p, token), predictions))
+    logger.info(f"Pre-warmed facts for {warmed} of {len(predictions)} predicted positions")
+    return warmed
+
+
 def get_previous_location(source_timestamp: str) -> Optional[Dict[str, Any]]:
     """
     Get the previous location entry from Firestore to calculate velocity.
@@ -453,6 +546,11 @@ def generate_predictions(
         logger.info(f"Generated {len(predictions)} orbital mechanics predictions")
         logger.info(f"Total predictions generated: {len(predictions)} (19 orbital mechanics)")
         
+        # Facts for the positions ahead are cached before the predictions are
+        # stored: the BFF announces a location once they are, and the batch
+        # its devices then fetch is answered from the cache
+        facts_prewarmed = prewarm_facts(predictions[:PREWARM_COUNT])
+        
         # Create document reference for source document
         source_doc_ref = db.collection('iss_loc_history').document(source_document_id)
         
@@ -480,7 +578,8 @@ def generate_predictions(
         return {
             'status': 'success',
             'document_id': rounded_timestamp,
-            'prediction_count': len(predictions)
+            'prediction_count': len(predictions),
+            'facts_prewarmed': facts_prewarmed
         }
         
     except Exception as e:
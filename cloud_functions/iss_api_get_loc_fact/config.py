@@ -11,3 +11,14 @@ GEMINI_SETTINGS = {
 # Default prompt that will be used if Secret Manager value is not available
 DEFAULT_LOCATION_FACT_PROMPT = """Generate a fascinating historical or geographical fact about {location}. 
 Focus on lesser-known but verified information. Respond in a maximum of 20 words."""
+
+# Facts cached per geographic cell and place name, so positions the ISS
+# passes again (and predicted ones, pre-warmed by iss_api_generate_predictions)
+# are answered without a Gemini call. Geohash precision 3 cells are about
+# 156 x 156 km; expired documents are also removed by a Firestore TTL
+# policy on expires_at.
+FACT_CACHE_SETTINGS = {
+    'collection': 'iss_fact_cells',
+    'geohash_precision': 3,
+    'max_age_days': 30,
+}
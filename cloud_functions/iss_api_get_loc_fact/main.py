@@ -1,12 +1,17 @@
 import functions_framework
 from flask import jsonify, request
-from utils import generate_location_fun_fact
+from utils import generate_location_fun_fact, get_cached_fact, store_cached_fact
 
 @functions_framework.http
 def iss_api_get_loc_fact(request):
     """Generates location-based fun facts.
+
+    With latitude and longitude as well, facts are cached per geographic
+    cell and place name, and a cached fact is returned without Gemini.
+
     Args:
-        request (flask.Request): The request object with location parameter.
+        request (flask.Request): The request object with location parameter,
+            and optionally latitude and longitude.
     Returns:
         JSON: Returns a fun fact about the provided location.
     """
@@ -19,13 +24,27 @@ def iss_api_get_loc_fact(request):
                 "status": "error"
             }), 400
 
+        latitude = request.args.get('latitude', type=float)
+        longitude = request.args.get('longitude', type=float)
+        has_position = latitude is not None and longitude is not None
+
+        # Cached fact for this place, if the caller sent its position
+        fun_fact = get_cached_fact(latitude, longitude, location) if has_position else None
+        cached = fun_fact is not None
+        error_info = None
+
         # Generate fact for current location
-        fun_fact, error_info = generate_location_fun_fact(location)
+        if not cached:
+            fun_fact, error_info = generate_location_fun_fact(location)
+            # The fallback text sent on errors is not cached
+            if has_position and not error_info:
+                store_cached_fact(latitude, longitude, location, fun_fact)
 
         # Prepare response
         response_data = {
             'location': location,
             'fact': fun_fact,
+            'cached': cached,
             'status': 'success',
             'version': '1.0'
         }
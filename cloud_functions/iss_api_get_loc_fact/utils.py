@@ -1,10 +1,18 @@
+import hashlib
+from datetime import datetime, timedelta, timezone
+from google.cloud import firestore
 from google.cloud import secretmanager
 from google.cloud import storage
 from vertexai.generative_models import GenerativeModel
 from vertexai import init
 import traceback
 import logging
-from config import GEMINI_SETTINGS, DEFAULT_LOCATION_FACT_PROMPT
+from config import GEMINI_SETTINGS, DEFAULT_LOCATION_FACT_PROMPT, FACT_CACHE_SETTINGS
+
+GEOHASH_ALPHABET = '0123456789bcdefghjkmnpqrstuvwxyz'
+
+# Firestore client, created on first use and reused across invocations
+_firestore_client = None
 
 def getSecret(secret_id):
     try:
@@ -86,3 +94,89 @@ def generate_location_fun_fact(location):
         }
         logging.error(f"Error generating location fact: {error_info}")
         return "An interesting fact about this location is coming soon!", error_info
+
+
+def _get_firestore_client():
+    """Get or create the Firestore client."""
+    global _firestore_client
+    if _firestore_client is None:
+        _firestore_client = firestore.Client()
+    return _firestore_client
+
+
+def geohash(latitude, longitude, precision):
+    """Encode a position as a geohash of the given length."""
+    lat_range = [-90.0, 90.0]
+    lon_range = [-180.0, 180.0]
+    code = []
+    bits = 0
+    bit_count = 0
+    even = True  # Bits alternate between longitude and latitude
+    while len(code) < precision:
+        value, bounds = (longitude, lon_range) if even else (latitude, lat_range)
+        middle = (bounds[0] + bounds[1]) / 2
+        bits <<= 1
+        if value >= middle:
+            bits |= 1
+            bounds[0] = middle
+        else:
+            bounds[1] = middle
+        even = not even
+        bit_count += 1
+        if bit_count == 5:
+            code.append(GEOHASH_ALPHABET[bits])
+            bits = bit_count = 0
+    return ''.join(code)
+
+
+def fact_cache_document_id(latitude, longitude, location):
+    """Key of a cached fact: the place's cell plus a hash of its name.
+
+    The same key is computed in iss_api_bff_esp/utils.py, which reads the
+    cache directly.
+
+    Returns:
+        Tuple of (cell, document_id).
+    """
+    cell = geohash(latitude, longitude, FACT_CACHE_SETTINGS['geohash_precision'])
+    name_hash = hashlib.sha1(location.encode('utf-8')).hexdigest()[:12]
+    return cell, f"{cell}-{name_hash}"
+
+
+def get_cached_fact(latitude, longitude, location):
+    """Look up a fact for a place in its cell.
+
+    Returns:
+        The cached fact, or None on a miss, an expired entry or an error.
+    """
+    try:
+        _, document_id = fact_cache_document_id(latitude, longitude, location)
+        doc = (_get_firestore_client().collection(FACT_CACHE_SETTINGS['collection'])
+               .document(document_id).get())
+        if not doc.exists:
+            return None
+        entry = doc.to_dict()
+        if entry.get('location') != location or entry.get('expires_at') <= datetime.now(timezone.utc):
+            return None
+        return entry.get('fact')
+    except Exception as e:
+        logging.warning(f"Fact cache lookup failed for {location}: {str(e)}")
+        return None
+
+
+def store_cached_fact(latitude, longitude, location, fact):
+    """Store a generated fact for a place in its cell; failures are only logged."""
+    try:
+        cell, document_id = fact_cache_document_id(latitude, longitude, location)
+        now = datetime.now(timezone.utc)
+        _get_firestore_client().collection(FACT_CACHE_SETTINGS['collection']).document(document_id).set({
+            'cell': cell,
+            'location': location,
+            'fact': fact,
+            'latitude': latitude,
+            'longitude': longitude,
+            'generated_at': now,
+            'expires_at': now + timedelta(days=FACT_CACHE_SETTINGS['max_age_days'])
+        })
+    except Exception as e:
+        logging.warning(f"Fact cache store failed for {location}: {str(e)}")
@@ -0,0 +1,137 @@
+/*
+ * Native Arduino Core
+ * ===================
+ *
+ * The part of the Arduino core the portable firmware modules use, for the
+ * host build (pio test -e native). Serial writes to stdout, the clocks run
+ * from the host's monotonic clock, and delay() really sleeps, so the modules
+ * compile unchanged and time the same way they do on the device.
+ *
+ * Only what the native modules touch is here; anything that needs the
+ * radio, NVS or the LCD comes from the other fakes in this directory.
+ *
+ * Usage (host only):
+ *   Serial.mute(true);      // silence module logging inside a timed loop
+ */
+
+#ifndef ISS_NATIVE_ARDUINO_H
+#define ISS_NATIVE_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+typedef uint8_t byte;
+
+#define PROGMEM
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+
+template <typename T, typename L, typename H>
+inline T constrain(T value, L low, H high) {
+    return value < (T)low ? (T)low : (value > (T)high ? (T)high : value);
+}
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+#ifndef __APPLE__
+// glibc before 2.38 has no strlcpy
+size_t strlcpy(char* dst, const char* src, size_t size);
+#endif
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+
+    size_t print(const char* text) { return write(text); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int value) { return printf("%d", value); }
+    size_t print(unsigned value) { return printf("%u", value); }
+    size_t print(long value) { return printf("%ld", value); }
+    size_t print(unsigned long value) { return printf("%lu", value); }
+    size_t print(double value, int digits = 2) { return printf("%.*f", digits, value); }
+    template <typename T>
+    size_t println(T value) { return print(value) + println(); }
+    size_t println() { return write("\r\n"); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    virtual void flush() {}
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long ms) { timeout = ms; }
+
+    /**
+     * Reads up to length bytes, stopping early when the stream runs dry
+     * (a host stream has nothing more to wait for)
+     */
+    size_t readBytes(char* buffer, size_t length);
+    size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+
+protected:
+    unsigned long timeout = 1000;
+};
+
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) {}
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+
+    /**
+     * Host only: drops output while muted
+     */
+    void mute(bool on) { muted = on; }
+
+private:
+    bool muted = false;
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+    uint32_t getFreeHeap() { return 0; }
+    uint32_t getMaxAllocHeap() { return 0; }
+    uint32_t getCpuFreqMHz() { return 240; }
+    void restart() { exit(0); }
+};
+
+extern EspClass ESP;
+
+/**
+ * Sets TZ from the POSIX rule; there is no SNTP on the host, the clock is
+ * already set
+ */
+void configTzTime(const char* tz, const char* server1, const char* server2 = NULL,
+                  const char* server3 = NULL);
+bool getLocalTime(struct tm* info, uint32_t ms = 5000);
+
+#endif
@@ -0,0 +1,35 @@
+/*
+ * Native HTTPClient
+ * =================
+ *
+ * No network on the host: every request fails as a connection refusal,
+ * the same path the firmware takes when the server cannot be reached.
+ */
+
+#ifndef ISS_NATIVE_HTTP_CLIENT_H
+#define ISS_NATIVE_HTTP_CLIENT_H
+
+#include <Arduino.h>
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+
+class HTTPClient {
+public:
+    bool begin(const char* url) { return true; }
+    void setConnectTimeout(int32_t ms) {}
+    void setTimeout(uint16_t ms) {}
+    int GET() { return HTTPC_ERROR_CONNECTION_REFUSED; }
+    Stream& getStream() { return empty; }
+    void end() {}
+
+private:
+    class EmptyStream : public Stream {
+    public:
+        size_t write(uint8_t c) override { return 0; }
+        int available() override { return 0; }
+        int read() override { return -1; }
+        int peek() override { return -1; }
+    } empty;
+};
+
+#endif
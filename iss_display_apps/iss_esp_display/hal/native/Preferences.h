@@ -0,0 +1,25 @@
+/*
+ * Native Preferences
+ * ==================
+ *
+ * NVS stand-in kept in memory for the life of the process, so a "warm boot"
+ * can be tested by calling the begin function twice.
+ */
+
+#ifndef ISS_NATIVE_PREFERENCES_H
+#define ISS_NATIVE_PREFERENCES_H
+
+#include <Arduino.h>
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false);
+    void end() { space[0] = '\0'; }
+    size_t getString(const char* key, char* value, size_t maxLen);
+    size_t putString(const char* key, const char* value);
+
+private:
+    char space[16] = "";  // Open namespace, empty if none
+};
+
+#endif
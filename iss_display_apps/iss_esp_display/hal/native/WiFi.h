@@ -0,0 +1,28 @@
+/*
+ * Native WiFi
+ * ===========
+ *
+ * The host is always "connected"; modules that check the link before a
+ * request go ahead, and their HTTP calls fail cleanly (see HTTPClient.h).
+ */
+
+#ifndef ISS_NATIVE_WIFI_H
+#define ISS_NATIVE_WIFI_H
+
+#include <Arduino.h>
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_CONNECTED = 3,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+class WiFiClass {
+public:
+    wl_status_t status() { return WL_CONNECTED; }
+    int RSSI() { return 0; }
+};
+
+extern WiFiClass WiFi;
+
+#endif
@@ -0,0 +1,37 @@
+/*
+ * Native Wire
+ * ===========
+ *
+ * I2C bus stand-in that accepts every transaction and counts them, so bus
+ * traffic can be compared between builds without a panel attached.
+ */
+
+#ifndef ISS_NATIVE_WIRE_H
+#define ISS_NATIVE_WIRE_H
+
+#include <Arduino.h>
+
+class TwoWire {
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) { return true; }
+    bool setClock(uint32_t frequency) { clock = frequency; return true; }
+    void beginTransmission(uint8_t address) { pending = 0; }
+    size_t write(uint8_t data) { pending++; return 1; }
+    size_t write(const uint8_t* data, size_t length) { pending += length; return length; }
+    uint8_t endTransmission(bool sendStop = true) {
+        transactions++;
+        bytes += pending;
+        return 0;
+    }
+
+    uint32_t clock = 100000;
+    uint32_t transactions = 0;      // Completed transactions
+    uint32_t bytes = 0;             // Payload bytes in them
+
+private:
+    size_t pending = 0;
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,169 @@
+/*
+ * Native HAL
+ * ==========
+ *
+ * Host implementations behind the fakes in this directory.
+ */
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <Preferences.h>
+#include <WiFi.h>
+#include <Wire.h>
+#include <rgb_lcd.h>
+#include <stdarg.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+WiFiClass WiFi;
+TwoWire Wire;
+
+static const auto bootTime = std::chrono::steady_clock::now();
+
+unsigned long millis() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - bootTime).count();
+}
+
+unsigned long micros() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - bootTime).count();
+}
+
+void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void yield() {
+    std::this_thread::yield();
+}
+
+long random(long max) {
+    return max > 0 ? rand() % max : 0;
+}
+
+long random(long min, long max) {
+    return max > min ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed) {
+    srand((unsigned)seed);
+}
+
+#ifndef __APPLE__
+size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t length = strlen(src);
+    if (size > 0) {
+        size_t count = length < size - 1 ? length : size - 1;
+        memcpy(dst, src, count);
+        dst[count] = '\0';
+    }
+    return length;
+}
+#endif
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (written < size && write(buffer[written])) {
+        written++;
+    }
+    return written;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length < 0) {
+        return 0;
+    }
+    return write((const uint8_t*)buffer, min((size_t)length, sizeof(buffer) - 1));
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = read();
+        if (c < 0) {
+            break;
+        }
+        buffer[count++] = (char)c;
+    }
+    return count;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    if (!muted) {
+        fwrite(buffer, 1, size, stdout);
+    }
+    return size;
+}
+
+void configTzTime(const char* tz, const char* server1, const char* server2, const char* server3) {
+    setenv("TZ", tz, 1);
+    tzset();
+}
+
+bool getLocalTime(struct tm* info, uint32_t ms) {
+    time_t now = time(NULL);
+    localtime_r(&now, info);
+    return true;
+}
+
+void rgb_lcd::clear() {
+    memset(cells, ' ', sizeof(cells));
+    row = 0;
+    column = 0;
+    transactions++;
+}
+
+void rgb_lcd::setCursor(uint8_t column, uint8_t row) {
+    this->column = column;
+    this->row = row;
+    transactions++;
+}
+
+size_t rgb_lcd::write(uint8_t c) {
+    if (row < 2 && column < 16) {
+        cells[row][column] = (char)c;
+    }
+    column++;
+    charactersWritten++;
+    transactions++;
+    return 1;
+}
+
+// Namespace and key -> value, for as long as the process runs
+static std::map<std::string, std::string> nvs;
+
+bool Preferences::begin(const char* name, bool readOnly) {
+    strlcpy(space, name, sizeof(space));
+    return true;
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t maxLen) {
+    auto entry = nvs.find(std::string(space) + "/" + key);
+    if (entry == nvs.end() || maxLen == 0) {
+        return 0;
+    }
+    strlcpy(value, entry->second.c_str(), maxLen);
+    return min(entry->second.size() + 1, maxLen);
+}
+
+size_t Preferences::putString(const char* key, const char* value) {
+    if (space[0] == '\0') {
+        return 0;
+    }
+    nvs[std::string(space) + "/" + key] = value;
+    return strlen(value);
+}
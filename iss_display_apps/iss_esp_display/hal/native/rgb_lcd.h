@@ -0,0 +1,37 @@
+/*
+ * Native Grove RGB LCD
+ * ====================
+ *
+ * Stand-in for the Grove RGB LCD driver that keeps the cells in memory and
+ * counts the I2C traffic the real driver would send, so the renderer can be
+ * measured in transactions rather than wall time.
+ */
+
+#ifndef ISS_NATIVE_RGB_LCD_H
+#define ISS_NATIVE_RGB_LCD_H
+
+#include <Arduino.h>
+
+class rgb_lcd : public Print {
+public:
+    void begin(uint8_t columns, uint8_t rows, uint8_t charsize = 0) { clear(); }
+    void clear();
+    void home() { setCursor(0, 0); }
+    void setCursor(uint8_t column, uint8_t row);
+    void setRGB(unsigned char r, unsigned char g, unsigned char b) { transactions += 3; }
+    void createChar(uint8_t location, uint8_t charmap[]) { transactions += 9; }
+    void display() { transactions++; }
+    void noDisplay() { transactions++; }
+    size_t write(uint8_t c) override;
+    using Print::write;
+
+    char cells[2][16];              // What the panel shows
+    uint32_t transactions = 0;      // I2C writes the driver would make
+    uint32_t charactersWritten = 0;
+
+private:
+    int row = 0;
+    int column = 0;
+};
+
+#endif
@@ -0,0 +1,50 @@
+/*
+ * ISS Backlight
+ * =============
+ *
+ * Backlight colour changes as gamma-correct fades. Colours are PWM duty
+ * values as before (0-255 per channel), but a fade interpolates in
+ * perceived brightness (gamma 2.2) rather than in duty, so it looks even
+ * instead of jumping at the dark end and crawling at the bright end. Each
+ * frame writes the colour as one I2C burst (lcdSetRGB()), and sends nothing
+ * once the fade has settled.
+ *
+ * Without a running frame clock (iss_render.h), nothing would step a fade,
+ * so every change is immediate.
+ *
+ * Usage:
+ *   backlightBegin(renderBegin());
+ *   backlightSet(0, 255, 0, 400);       // fade to green over 400 ms
+ *   backlightStep(elapsedUs);           // every frame
+ */
+
+#ifndef ISS_BACKLIGHT_H
+#define ISS_BACKLIGHT_H
+
+#include <Arduino.h>
+
+/**
+ * Builds the gamma tables; call before the first backlightSet()
+ * @param frameClock True if the render clock is running and calls
+ *                   backlightStep() each frame; false settles every change at once
+ */
+void backlightBegin(bool frameClock);
+
+/**
+ * Starts a fade from the current colour (or sets it at once)
+ * @param fadeMs Fade duration; 0 for an immediate change
+ */
+void backlightSet(uint8_t red, uint8_t green, uint8_t blue, unsigned long fadeMs);
+
+/**
+ * Advances the fade in progress, if any
+ * @param elapsedUs Time since the previous step
+ */
+void backlightStep(uint32_t elapsedUs);
+
+/**
+ * @return True while a fade is in progress
+ */
+bool backlightFading();
+
+#endif
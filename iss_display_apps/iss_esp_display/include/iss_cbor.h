@@ -0,0 +1,132 @@
+/*
+ * ISS CBOR Reader
+ * ===============
+ *
+ * Minimal streaming CBOR (RFC 8949) decoder for fixed-schema payloads. Items
+ * are read one at a time straight from a Stream into caller-provided
+ * storage: no document, no heap, and no copy of the payload. The caller walks
+ * the structure it expects and skips anything else, so unknown keys added by
+ * a newer server are harmless.
+ *
+ * Supports definite-length maps, arrays and strings (what the BFF's encoder
+ * emits), integers, half/single/double floats, booleans and null. Tags are
+ * skipped. Indefinite-length items are rejected as malformed.
+ *
+ * The typed reads consume the next item even when it has the wrong type and
+ * then return false, so one unexpected value (a null coordinate, say) does
+ * not derail the rest of the decode. Only truncated or malformed input sets
+ * failed().
+ *
+ * Usage:
+ *   CborReader cbor(stream);
+ *   size_t fields;
+ *   if (cbor.readMap(fields)) {
+ *       for (size_t i = 0; i < fields; i++) {
+ *           char key[24];
+ *           cbor.readText(key, sizeof(key));
+ *           if (strcmp(key, "latitude") == 0) cbor.readFloat(latitude);
+ *           else cbor.skip();
+ *       }
+ *   }
+ *   if (cbor.failed()) { ... }
+ */
+
+#ifndef ISS_CBOR_H
+#define ISS_CBOR_H
+
+#include <Arduino.h>
+
+// CBOR major types
+enum CborType {
+    CBOR_UNSIGNED = 0,
+    CBOR_NEGATIVE = 1,
+    CBOR_BYTES = 2,
+    CBOR_TEXT = 3,
+    CBOR_ARRAY = 4,
+    CBOR_MAP = 5,
+    CBOR_TAG = 6,
+    CBOR_SIMPLE = 7,   // Floats, booleans, null
+    CBOR_END = -1      // End of input or error
+};
+
+class CborReader {
+public:
+    explicit CborReader(Stream& input);
+
+    /**
+     * @return The type of the next item (after any tags), without consuming it
+     */
+    CborType peekType();
+
+    /**
+     * Reads a map header; the pairs follow as separate items
+     * @param count Receives the number of key/value pairs
+     * @return False if the next item is not a map
+     */
+    bool readMap(size_t& count);
+
+    /**
+     * Reads an array header; the elements follow as separate items
+     * @param count Receives the number of elements
+     * @return False if the next item is not an array
+     */
+    bool readArray(size_t& count);
+
+    /**
+     * Reads a text string, truncated to fit; null reads as ""
+     * @param output Buffer for the NUL-terminated string
+     * @param outputSize Size of the buffer
+     * @return False if the next item is not text or null
+     */
+    bool readText(char* output, size_t outputSize);
+
+    /**
+     * Reads a byte string whole; one longer than the buffer is skipped
+     * @param output Buffer for the bytes
+     * @param outputSize Size of the buffer
+     * @param length Receives the number of bytes read
+     * @return False if the next item is not a byte string or does not fit
+     */
+    bool readByteString(uint8_t* output, size_t outputSize, size_t& length);
+
+    /**
+     * Reads a number; a text item holding a decimal number is accepted too
+     * @param output Receives the value
+     * @return False if the next item is not a number
+     */
+    bool readFloat(float& output);
+
+    /**
+     * Reads an integer
+     * @param output Receives the value
+     * @return False if the next item is not an integer
+     */
+    bool readInt(int64_t& output);
+
+    /**
+     * Skips the next item, including everything nested in it
+     * @return False on malformed input
+     */
+    bool skip();
+
+    /**
+     * @return True once the input ended early or was malformed
+     */
+    bool failed() const { return error; }
+
+private:
+    bool readHead(uint8_t& major, uint8_t& info, uint64_t& argument);
+    bool readBytes(uint8_t* buffer, size_t length);
+    bool discard(uint64_t length);
+    bool skipDepth(int depth);
+    int nextByte();
+
+    Stream& input;
+    bool hasPending;             // A head was read by peekType()
+    uint8_t pendingMajor;
+    uint8_t pendingInfo;
+    uint64_t pendingArgument;
+    bool error;
+};
+
+#endif
@@ -0,0 +1,46 @@
+/*
+ * ISS LCD Character Set
+ * =====================
+ *
+ * Converts UTF-8 text from the API into bytes the HD44780 LCD can show. The
+ * panel's ROM only has ASCII (plus a few Japanese-set symbols), so every
+ * codepoint is looked up in a compile-time table covering Latin-1
+ * Supplement and Latin Extended-A (U+00A0..U+017F) and mapped to:
+ *
+ * - an ASCII replacement, e.g. "a" for "á", "ss" for "ß", "AE" for "Æ"
+ * - one of eight custom CGRAM glyphs for the most common lowercase accents
+ *   (loaded by charsetLoadGlyphs())
+ *
+ * Typographic punctuation (quotes, dashes, ellipsis) is folded to ASCII and
+ * anything else becomes '?'. Conversion is a single pass with no allocations.
+ *
+ * Usage:
+ *   charsetLoadGlyphs(lcdPanel());               // once, after lcdBegin()
+ *   charsetTransliterate(utf8, out, sizeof(out));
+ */
+
+#ifndef ISS_CHARSET_H
+#define ISS_CHARSET_H
+
+#include <Arduino.h>
+#include <rgb_lcd.h>
+
+/**
+ * Stores the custom glyphs in the LCD's character generator RAM
+ * Uses all eight CGRAM slots
+ * @param lcd The initialized LCD
+ */
+void charsetLoadGlyphs(rgb_lcd& lcd);
+
+/**
+ * Converts UTF-8 text to LCD bytes
+ * Invalid UTF-8 becomes '?'. A replacement that does not fit is dropped
+ * whole, so the output is always terminated and never ends mid-replacement.
+ * @param input Null-terminated UTF-8 text
+ * @param output Buffer for the LCD bytes (may not alias input)
+ * @param outputSize Size of the output buffer
+ * @return Number of bytes written, excluding the terminator
+ */
+size_t charsetTransliterate(const char* input, char* output, size_t outputSize);
+
+#endif
@@ -0,0 +1,134 @@
+/*
+ * ISS BFF Fetch
+ * =============
+ *
+ * Non-blocking client for the iss-api-bff-esp endpoint. A request is split
+ * into small steps (resolve, connect, TLS, request, headers, body, parse) that
+ * are advanced one at a time by fetchStep(), so the caller's loop keeps running
+ * while the server is slow to answer (e.g. during a Cloud Run cold start).
+ *
+ * Requests are conditional: the ETag and Last-Modified of the last good
+ * response are sent back, and a 304 Not Modified ends the request as
+ * FETCH_UNCHANGED without a body. The server's Cache-Control max-age (or
+ * Retry-After on errors) is available from fetchPollHint().
+ *
+ * Each request asks for a batch: the current location plus the next
+ * FETCH_BATCH_SIZE - 1 predicted ones, each with its own fact, which the
+ * caller plays back one per store interval. A server without batch support
+ * answers with the current location only (upcomingCount is 0). It also asks
+ * for the ground track of the last HISTORY_MINUTES (iss_history.h).
+ *
+ * The BFF is asked for CBOR, which is decoded field by field straight from
+ * the connection (iss_cbor.h); a JSON answer is parsed with ArduinoJson. Both
+ * decoders live in iss_payload.h.
+ *
+ * The connection is kept open between requests (HTTP keep-alive). When the
+ * server has closed it, the next request reconnects and resumes the previous
+ * TLS session from its cached ticket, so a full handshake is only needed when
+ * the server no longer accepts the ticket.
+ *
+ * Usage:
+ *   fetchBegin();                       // start a request
+ *   if (fetchInProgress()) {
+ *       FetchState state = fetchStep(); // call once per loop() iteration
+ *       if (state == FETCH_DONE) ...    // fetchResult() holds the data
+ *   }
+ */
+
+#ifndef ISS_FETCH_H
+#define ISS_FETCH_H
+
+#include <Arduino.h>
+#include "iss_payload.h"
+
+// Stages of a single request to the BFF
+enum FetchState {
+    FETCH_IDLE,        // No request in flight
+    FETCH_RESOLVE,     // Looking up the BFF host name
+    FETCH_CONNECT,     // Opening the TCP connection
+    FETCH_TLS,         // Performing (or resuming) the TLS handshake
+    FETCH_REQUEST,     // Sending the HTTP request
+    FETCH_HEADERS,     // Waiting for and reading the response headers
+    FETCH_BODY,        // Waiting for the response body to start
+    FETCH_PARSE,       // Parsing the JSON body as it streams in
+    FETCH_RETRY_WAIT,  // Pausing before the next attempt
+    FETCH_DONE,        // Finished successfully, result is available
+    FETCH_UNCHANGED,   // Server answered 304, the previous result is still current
+    FETCH_FAILED       // Gave up after all attempts
+};
+
+// Connection reuse counters since boot
+struct ConnectionStats {
+    uint32_t fullHandshakes;     // TLS sessions negotiated from scratch
+    uint32_t resumedHandshakes;  // Abbreviated handshakes from a cached session ticket
+    uint32_t reusedConnections;  // Requests sent on an open keep-alive connection
+};
+
+/**
+ * Starts a new request to the BFF
+ * Does nothing if a request is already in flight
+ */
+void fetchBegin();
+
+/**
+ * Advances the in-flight request by one bounded step
+ * Steps return at once, except the one that parses the body: it reads the
+ * body as it arrives and can take up to a second on a slow connection
+ * @return The state after the step; FETCH_DONE, FETCH_UNCHANGED and
+ *         FETCH_FAILED are reported exactly once, after which the fetcher
+ *         returns to FETCH_IDLE
+ */
+FetchState fetchStep();
+
+/**
+ * @return True while a request is in flight
+ */
+bool fetchInProgress();
+
+/**
+ * @return The data from the last successful request; valid is false
+ *         until the first one
+ */
+const ISSData& fetchResult();
+
+/**
+ * @return True if the last FETCH_DONE brought new data; false if its body
+ *         could not be parsed, in which case fetchResult() is unchanged
+ */
+bool fetchResultChanged();
+
+/**
+ * @return The HTTP status of the last attempt, or a negative value if the
+ *         attempt failed before a status line was received
+ */
+int fetchLastStatus();
+
+/**
+ * @return The server's hint for the next poll from the last response, in
+ *         seconds (Cache-Control max-age, or Retry-After), or -1 if none
+ */
+long fetchPollHint();
+
+/**
+ * @return The number of attempts made by the last request
+ */
+int fetchAttempts();
+
+/**
+ * @return Connection reuse counters since boot
+ */
+const ConnectionStats& fetchConnectionStats();
+
+/**
+ * @return The number of full TLS handshakes avoided since boot, either by
+ *         reusing a keep-alive connection or by resuming a session
+ */
+uint32_t fetchHandshakesAvoided();
+
+/**
+ * @param state A fetch state
+ * @return A short name for the state, for logging
+ */
+const char* fetchStateName(FetchState state);
+
+#endif
@@ -0,0 +1,70 @@
+/*
+ * ISS LCD Framebuffer
+ * ===================
+ *
+ * Shadow framebuffer for the 16x2 Grove RGB LCD. Frames are composed in a
+ * back buffer and framebufferFlush() compares it with what the panel is
+ * known to show, sending only the characters that changed. This replaces
+ * lcd.clear() + full rewrites, which took ~2 ms for the clear alone, sent all
+ * 32 cells over I2C every frame and made the display flicker.
+ *
+ * Each run of changed cells goes out as one lcdWrite() transaction
+ * (iss_lcd.h), so nearby runs are merged when that is cheaper than a new
+ * transaction.
+ *
+ * Usage:
+ *   framebufferBegin();                        // once, after lcdBegin()
+ *   framebufferSetRow(0, text, length);        // compose a frame
+ *   framebufferSetRow(1, text, length);
+ *   framebufferFlush();                        // push the differences
+ */
+
+#ifndef ISS_FRAMEBUFFER_H
+#define ISS_FRAMEBUFFER_H
+
+#include <Arduino.h>
+#include "iss_lcd.h"
+
+// Counters since boot, for checking how much I2C traffic the diffing saves
+struct FramebufferStats {
+    uint32_t frames;          // Calls to framebufferFlush()
+    uint32_t cellsWritten;    // Characters sent to the panel
+    uint32_t cellsSkipped;    // Characters left alone because they were unchanged
+};
+
+/**
+ * Clears the panel and starts tracking its contents
+ */
+void framebufferBegin();
+
+/**
+ * Sets one row of the next frame
+ * Text shorter than the row is padded with spaces, longer text is cut off
+ * @param row Row index (0 or 1)
+ * @param text Characters to show
+ * @param length Number of characters available at text
+ */
+void framebufferSetRow(int row, const char* text, int length);
+
+/**
+ * Sends the cells that differ from what the panel currently shows
+ */
+void framebufferFlush();
+
+/**
+ * Forgets what the panel shows, so the next flush rewrites every cell
+ * Use after anything else has written to the LCD directly
+ */
+void framebufferInvalidate();
+
+/**
+ * @return Counters since boot
+ */
+const FramebufferStats& framebufferStats();
+
+/**
+ * Prints the counters on one Serial line
+ */
+void framebufferLogStats();
+
+#endif
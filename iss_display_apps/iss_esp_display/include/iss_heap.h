@@ -0,0 +1,41 @@
+/*
+ * ISS Heap Statistics
+ * ===================
+ *
+ * Periodic sampling of the ESP32 heap, used to confirm that the firmware
+ * does not slowly fragment memory over days of uptime. Fragmentation is
+ * reported as the share of free memory that is not part of the largest free
+ * block: 0% means all free memory is contiguous.
+ */
+
+#ifndef ISS_HEAP_H
+#define ISS_HEAP_H
+
+#include <Arduino.h>
+
+// Heap figures from the latest sample, plus worst values since boot
+struct HeapStats {
+    uint32_t freeBytes;          // Free heap now
+    uint32_t largestFreeBlock;   // Largest single allocation possible now
+    uint32_t minFreeBytes;       // Lowest free heap since boot
+    uint8_t fragmentation;       // Percent of free heap outside the largest block
+    uint8_t peakFragmentation;   // Highest fragmentation seen since boot
+    uint32_t samples;            // Number of samples taken
+};
+
+/**
+ * Takes a new heap sample and updates the running statistics
+ */
+void heapStatsSample();
+
+/**
+ * @return Statistics as of the latest sample
+ */
+const HeapStats& heapStats();
+
+/**
+ * Prints the latest statistics on one Serial line
+ */
+void heapStatsLog();
+
+#endif
@@ -0,0 +1,89 @@
+/*
+ * ISS Ground Track
+ * ================
+ *
+ * The stored locations of the last HISTORY_MINUTES, sent by the BFF with
+ * each response (?history=) as a delta/varint stream of about 100 bytes:
+ *
+ *   version     1 byte (1)
+ *   count       varint
+ *   step        varint, seconds between samples
+ *   start       varint, Unix time of the first point
+ *   per point:  gap (varint, steps since the previous point), then
+ *               latitude and longitude (zigzag varints, 1/100 degree),
+ *               deltas from the previous point after the first; longitude
+ *               deltas wrap at the antimeridian
+ *
+ * The points are kept as a structure of arrays of int16 (1/100 degree
+ * fits in 16 bits), 6 bytes each. From the last two, historyMotion() gives
+ * the ground speed and heading without another request.
+ *
+ * Usage:
+ *   if (historyDecode(raw, length, track) && track.count >= 2) {
+ *       historyMotion(track, speedKmh, headingDeg);
+ *   }
+ */
+
+#ifndef ISS_HISTORY_H
+#define ISS_HISTORY_H
+
+#include <Arduino.h>
+#include <time.h>
+
+// Track window asked for, in minutes
+#define HISTORY_MINUTES 90
+
+// Points kept; older ones of a longer track are dropped
+#define HISTORY_CAPACITY 64
+
+// Largest encoded track accepted (a full one is about 8 bytes per point)
+#define HISTORY_MAX_BYTES 640
+
+// Coordinates are stored in 1/HISTORY_SCALE degree
+#define HISTORY_SCALE 100
+
+struct GroundTrack {
+    int count;                              // Points held, oldest first
+    time_t start;                           // Unix time of the first point
+    uint16_t step;                          // Seconds between samples
+    uint16_t offset[HISTORY_CAPACITY];      // Steps after start
+    int16_t latitude[HISTORY_CAPACITY];     // 1/100 degree
+    int16_t longitude[HISTORY_CAPACITY];    // 1/100 degree, [-18000, 18000)
+};
+
+/**
+ * Decodes an encoded track
+ * @param data Encoded bytes
+ * @param length Number of bytes
+ * @param track Receives the points; count is 0 on failure
+ * @return False if the track is malformed or of an unknown version
+ */
+bool historyDecode(const uint8_t* data, size_t length, GroundTrack& track);
+
+/**
+ * Decodes base64 (the JSON form of the track)
+ * @return Number of bytes written, 0 if the text is not base64 or too long
+ */
+size_t historyDecodeBase64(const char* text, uint8_t* output, size_t outputSize);
+
+/**
+ * @return Unix time of point i
+ */
+inline time_t historyTime(const GroundTrack& track, int i) {
+    return track.start + (time_t)track.offset[i] * track.step;
+}
+
+/**
+ * Ground speed and heading between the last two points
+ * @param speedKmh Receives the speed over the ground
+ * @param headingDeg Receives the initial great-circle bearing, 0-360
+ * @return False with fewer than two points
+ */
+bool historyMotion(const GroundTrack& track, float& speedKmh, float& headingDeg);
+
+/**
+ * @return Eight-point compass name of a heading ("N", "NE", ...)
+ */
+const char* historyCompass(float headingDeg);
+
+#endif
@@ -0,0 +1,152 @@
+/*
+ * ISS HTTP
+ * ========
+ *
+ * What the BFF clients (iss_fetch, iss_push and iss_ota) have in common: the
+ * endpoint, starting a connection to it, the GET request with the API key,
+ * and reading the response head as it arrives. Each client still runs its
+ * own connection and state machine; bodies are read through iss_http_body.h.
+ *
+ * Nothing here blocks beyond the host name lookup, so it suits the
+ * step-driven clients of the network task.
+ *
+ * Usage:
+ *   if (httpBeginConnect(client, bffHost) != HTTP_CONNECTING) ...   // then pollConnect()
+ *   httpSendGet(client, bffHost, "batch=4", "Accept: application/cbor\r\n");
+ *   head.begin(onHeader);
+ *   if (head.read(client, 256)) ...      // head.status(), head.chunked()
+ */
+
+#ifndef ISS_HTTP_H
+#define ISS_HTTP_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include "iss_tls.h"
+
+// BFF endpoint; the push stream is its own service, with the same path and API key
+extern const char* const bffHost;
+extern const char* const bffStreamHost;
+extern const char* const bffPath;
+extern const uint16_t bffPort;
+
+enum HttpConnectResult {
+    HTTP_CONNECTING,        // Resolved; the TCP connection is under way
+    HTTP_RESOLVE_FAILED,
+    HTTP_CONNECT_FAILED
+};
+
+/**
+ * Resolves a BFF host name and starts a TCP connection to it
+ * Records the lookup time as METRIC_DNS
+ * @param client Connection to start; poll it with pollConnect() after
+ * @param host bffHost or bffStreamHost
+ * @return HTTP_CONNECTING unless the lookup or the connect failed
+ */
+HttpConnectResult httpBeginConnect(IssTlsClient& client, const char* host);
+
+/**
+ * Sends a GET request to the BFF in a single write
+ * @param client Connection with a completed handshake
+ * @param host The host the connection was made to
+ * @param query Query parameters after the API key, without a leading '&'
+ * @param headers Further header lines, each ending in CRLF, or ""
+ * @return False if the request did not fit or could not be written
+ */
+bool httpSendGet(IssTlsClient& client, const char* host, const char* query, const char* headers);
+
+/**
+ * Returns the value of a header line if it has the given name
+ * Also matches event stream fields, which have the same "name: value" form
+ * @param line A complete line without the trailing CRLF
+ * @param name The name to match, case-insensitively
+ * @return Pointer to the value with leading spaces skipped, or NULL
+ */
+const char* httpHeaderValue(const char* line, const char* name);
+
+/**
+ * Collects received bytes into lines, dropping CRs
+ * A line longer than the buffer is cut short
+ */
+class HttpLineBuffer {
+public:
+    HttpLineBuffer() : length(0) { buffer[0] = '\0'; }
+
+    /**
+     * Discards a partly received line
+     */
+    void reset() { length = 0; }
+
+    /**
+     * Adds one received byte
+     * @return True if it ended a line, which line() then holds until the next add()
+     */
+    bool add(char c);
+
+    /**
+     * @return The last complete line, without its line ending
+     */
+    const char* line() const { return buffer; }
+
+private:
+    char buffer[128];
+    size_t length;
+};
+
+/**
+ * Reads an HTTP/1.1 response head, a little at a time
+ * Keeps the status and how the body is framed; every other header line goes
+ * to the handler given to begin()
+ */
+class HttpResponseHead {
+public:
+    typedef void (*HeaderHandler)(const char* line);
+
+    HttpResponseHead();
+
+    /**
+     * Prepares for the head of a new response
+     * @param handler Called with each other header line, or NULL
+     */
+    void begin(HeaderHandler handler);
+
+    /**
+     * Reads whatever part of the head has arrived, without waiting for more
+     * @param maxRead Most bytes to consume in this call
+     * @return True once the blank line that ends the head has been read; the
+     *         connection is then positioned at the first body byte
+     */
+    bool read(Client& client, size_t maxRead);
+
+    /**
+     * @return True once the status line has been read
+     */
+    bool started() const { return statusRead; }
+
+    /**
+     * @return The response status, or 0 if the status line did not parse
+     */
+    int status() const { return statusCode; }
+
+    /**
+     * @return Content-Length, or -1 if not given
+     */
+    long contentLength() const { return length; }
+
+    /**
+     * @return True for Transfer-Encoding: chunked
+     */
+    bool chunked() const { return isChunked; }
+
+private:
+    void processLine(const char* text);
+
+    HeaderHandler handler;
+    HttpLineBuffer line;
+    bool statusRead;
+    int statusCode;
+    long length;
+    bool isChunked;
+};
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ * ISS HTTP Body Stream
+ * ====================
+ *
+ * Presents the body of an HTTP/1.1 response as a plain Arduino Stream, so it
+ * can be handed straight to a parser such as deserializeJson() without first
+ * collecting it into a String. Handles Content-Length, chunked and
+ * close-delimited bodies, and stops at the end of the body so the connection
+ * can be reused for the next request.
+ *
+ * Reads wait (yielding with delay(1)) for data until the deadline passed to
+ * begin(), so use it from the network task only.
+ */
+
+#ifndef ISS_HTTP_BODY_H
+#define ISS_HTTP_BODY_H
+
+#include <Arduino.h>
+#include <Client.h>
+
+class HttpBodyStream : public Stream {
+public:
+    HttpBodyStream();
+
+    /**
+     * Prepares to read a body whose headers have just been consumed
+     * @param client Connection positioned at the first body byte
+     * @param contentLength Body length, or -1 if not given
+     * @param chunked True for Transfer-Encoding: chunked
+     * @param deadline millis() value after which reads give up
+     */
+    void begin(Client& client, long contentLength, bool chunked, unsigned long deadline);
+
+    /**
+     * Moves the deadline, e.g. to bound each read of a long-lived stream
+     * @param deadline millis() value after which reads give up
+     */
+    void setDeadline(unsigned long deadline) { this->deadline = deadline; }
+
+    /**
+     * @return True once the whole body has been read
+     */
+    bool complete() const { return done && bufferPos == bufferLength; }
+
+    /**
+     * @return True if the connection failed or timed out before the end of the body
+     */
+    bool failed() const { return error; }
+
+    /**
+     * Reads and discards the rest of the body
+     * @return True if the body ended cleanly (the connection can be reused)
+     */
+    bool drain();
+
+    /**
+     * @return Number of decoded body bytes delivered so far
+     */
+    size_t consumed() const { return delivered; }
+
+    // Stream interface
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t) override { return 0; }
+    void flush() override {}
+
+private:
+    bool fill();
+    int readRaw(uint8_t* buf, size_t size);
+    int readRawByte();
+    bool readChunkSize();
+    bool timedOut() const;
+
+    Client* client;
+    long remaining;          // Bytes left for Content-Length bodies, -1 otherwise
+    bool chunked;
+    size_t chunkRemaining;   // Bytes left in the current chunk
+    bool chunkDataEnded;     // CRLF after the current chunk's data still to skip
+    unsigned long deadline;
+    bool done;
+    bool error;
+    size_t delivered;
+
+    uint8_t buffer[128];
+    size_t bufferPos;
+    size_t bufferLength;
+};
+
+#endif
@@ -0,0 +1,46 @@
+/*
+ * ISS Last-Known Display Content
+ * ==============================
+ *
+ * Keeps the last good display content in NVS, so a reboot can show it
+ * within the first few hundred milliseconds instead of "Starting up..."
+ * while WiFi, the timezone and the first BFF request are still pending.
+ *
+ * The lines are stored as strings and the rest (position field, orbit and
+ * save time) as one small versioned blob; content from an older firmware
+ * layout is ignored.
+ *
+ * Usage:
+ *   if (lastKnownLoad(snapshot)) { ...show it... }   // setup()
+ *   lastKnownSave(snapshot);                          // after a good update
+ */
+
+#ifndef ISS_LAST_KNOWN_H
+#define ISS_LAST_KNOWN_H
+
+#include <Arduino.h>
+#include "iss_snapshot.h"
+
+/**
+ * Loads the stored content
+ * @param snapshot Receives the lines, position and orbit; hasLines is set and
+ *                 redrawNow is true so it can be shown at once
+ * @return True if content was found
+ */
+bool lastKnownLoad(DisplaySnapshot& snapshot);
+
+/**
+ * Stores content for the next boot
+ * Only writes to flash when the lines changed, to spare the NVS pages; a new
+ * position or clock alone does not count, so the stored text keeps those of
+ * the first save of the same place and fact
+ * @param snapshot Content that has just been published
+ */
+void lastKnownSave(const DisplaySnapshot& snapshot);
+
+/**
+ * @return Unix time the loaded content was saved, or 0 if unknown
+ */
+time_t lastKnownSavedAt();
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ * ISS LCD Driver
+ * ==============
+ *
+ * Fast I2C path to the Grove RGB LCD for the per-frame traffic. The rgb_lcd
+ * library still runs the init sequence and loads CGRAM glyphs, but it sends
+ * one I2C transaction per character and three for a backlight colour. Here
+ * the bus runs in Fast-mode and each write is a single transaction:
+ *
+ *   Characters   [0x80, set DDRAM address, 0x40, c1, c2 ... cN]
+ *                The address command is left out when the controller's
+ *                address counter is already there. A full row is 19 bytes
+ *                in one transaction instead of 16 transactions of 2.
+ *   Backlight    [0xA2, blue, green, red] to the PCA9633, auto-incrementing
+ *                over its PWM registers. A colour equal to the current one
+ *                is not sent at all. The v5 backlight chip (at 0x30) has no
+ *                documented auto-increment and keeps three register writes.
+ *
+ * The controller needs about 40 us to store a character, which a byte at
+ * 400 kHz (22.5 us) can outrun on some panels. If characters come out
+ * garbled, define ISS_LCD_I2C_HZ as 100000: bursts stay, the bus slows down.
+ *
+ * Usage:
+ *   lcdBegin(I2C_SDA, I2C_SCL);
+ *   charsetLoadGlyphs(lcdPanel());
+ *   lcdWrite(0, 0, "Hello", 5);
+ *   lcdSetRGB(0, 255, 0);
+ */
+
+#ifndef ISS_LCD_H
+#define ISS_LCD_H
+
+#include <Arduino.h>
+#include <rgb_lcd.h>
+
+// Display geometry
+#define LCD_COLUMNS 16
+#define LCD_ROWS 2
+
+#ifndef ISS_LCD_I2C_HZ
+#define ISS_LCD_I2C_HZ 400000
+#endif
+
+// Counters since boot
+struct LcdStats {
+    uint32_t transactions;    // I2C transactions sent by this driver
+    uint32_t bytes;           // Payload bytes in them
+    uint32_t addressSets;     // Writes that had to move the address counter
+    uint32_t busyUs;          // Time spent in the I2C calls
+};
+
+/**
+ * Starts I2C and the panel, then raises the bus to ISS_LCD_I2C_HZ
+ * @param sda SDA pin
+ * @param scl SCL pin
+ */
+void lcdBegin(int sda, int scl);
+
+/**
+ * @return The library object, for what only it does (CGRAM glyphs)
+ */
+rgb_lcd& lcdPanel();
+
+/**
+ * Clears the panel and homes the address counter (blocks for ~2 ms)
+ */
+void lcdClear();
+
+/**
+ * Writes characters in one transaction
+ * @param row Row index
+ * @param column First column
+ * @param text Characters (need not be terminated)
+ * @param count Number of characters; kept within the row
+ */
+void lcdWrite(int row, int column, const char* text, int count);
+
+/**
+ * Sets the backlight colour in one transaction, unless it is already set
+ */
+void lcdSetRGB(uint8_t red, uint8_t green, uint8_t blue);
+
+/**
+ * @return Counters since boot
+ */
+const LcdStats& lcdStats();
+
+/**
+ * Prints the counters on one Serial line
+ */
+void lcdLogStats();
+
+#endif
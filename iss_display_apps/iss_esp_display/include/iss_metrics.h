@@ -0,0 +1,97 @@
+/*
+ * ISS Metrics
+ * ===========
+ *
+ * Hot-path timings and health figures for profiling the fleet, kept in
+ * fixed-size histograms so recording never allocates or blocks:
+ *
+ *   dns            Host name lookup of the BFF
+ *   tls_handshake  TLS handshake, full or resumed
+ *   ttfb           Request sent to first response byte
+ *   parse          Body read and decode
+ *   render         One display frame (scroll step and LCD flush)
+ *   loop_jitter    How much later than planned the display loop woke up
+ *
+ * Buckets are powers of two from 64 us to about 8 s. Each timing has a single
+ * writer (the network task or the display loop), so recording needs no lock;
+ * a reader may see one sample half-applied, which a profile can live with.
+ * Update outcomes are counted, and the heap low-water marks (free heap and
+ * largest free block) are tracked at every sample.
+ *
+ * The figures are served as Prometheus text on http://<device>/metrics,
+ * answered from the network task between requests. Set ISS_METRICS_PORT to 0
+ * to leave the server out. A summary line with p50/p90/max goes to the stats log.
+ *
+ * Usage:
+ *   uint32_t start = micros();
+ *   ...
+ *   metricsRecord(METRIC_DNS, micros() - start);
+ *   metricsCount(METRIC_UPDATE_DONE);
+ *   metricsServe();              // network task loop, after metricsBegin()
+ */
+
+#ifndef ISS_METRICS_H
+#define ISS_METRICS_H
+
+#include <Arduino.h>
+
+#ifndef ISS_METRICS_PORT
+#define ISS_METRICS_PORT 80
+#endif
+
+// Histogram buckets; bucket i counts samples below 64 << i microseconds
+#define METRIC_BUCKETS 18
+
+// Timed hot paths
+enum MetricTimer {
+    METRIC_DNS,
+    METRIC_TLS_HANDSHAKE,
+    METRIC_TTFB,
+    METRIC_PARSE,
+    METRIC_RENDER,
+    METRIC_LOOP_JITTER,
+    METRIC_TIMER_COUNT
+};
+
+// Counted events
+enum MetricCounter {
+    METRIC_UPDATE_DONE,
+    METRIC_UPDATE_UNCHANGED,
+    METRIC_UPDATE_FAILED,
+    METRIC_COUNTER_COUNT
+};
+
+/**
+ * Records one timing
+ * @param timer Which hot path
+ * @param us Duration in microseconds
+ */
+void metricsRecord(MetricTimer timer, uint32_t us);
+
+/**
+ * Counts one event
+ */
+void metricsCount(MetricCounter counter);
+
+/**
+ * Updates the heap low-water marks from the current heap
+ */
+void metricsSampleHeap();
+
+/**
+ * Starts the /metrics server; call once WiFi is up
+ */
+void metricsBegin();
+
+/**
+ * Reads what has arrived of a /metrics request and answers it once complete
+ * (network task only). Never waits for the client, so call it every loop
+ */
+void metricsServe();
+
+/**
+ * Prints p50/p90/max for each timing on one Serial line
+ */
+void metricsLogSummary();
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * ISS Orbit Propagator
+ * ====================
+ *
+ * Compact on-device propagator that turns a two-line element set (TLE) into
+ * the current sub-satellite latitude/longitude, so the position shown can
+ * move every second between the 5 minute BFF polls without any extra
+ * network traffic.
+ *
+ * This is not full SGP4 (the backend uses that, see get_sgp4_position() in
+ * iss_api_generate_predictions): it applies the TLE mean elements with the
+ * J2 secular drift of the node, perigee and mean anomaly, solves Kepler's
+ * equation and rotates by Greenwich sidereal time. For a fresh TLE this
+ * stays within a few tens of km over a day, far below what the display
+ * resolves at 0.1 degree. The polynomial fit in docs/iss_*_equation.json
+ * was not used; its published error is tens of degrees.
+ *
+ * Usage:
+ *   OrbitElements orbit;
+ *   if (orbitParseTle(line1, line2, orbit)) {
+ *       float lat, lon;
+ *       orbitPosition(orbit, time(nullptr), lat, lon);
+ *   }
+ */
+
+#ifndef ISS_ORBIT_H
+#define ISS_ORBIT_H
+
+#include <Arduino.h>
+#include <time.h>
+
+// Length of a TLE line, without terminator
+#define TLE_LINE_LENGTH 69
+
+// Mean orbital elements at the TLE epoch, plus their secular rates
+struct OrbitElements {
+    bool valid;
+    double epoch;             // Unix time of the elements
+    double meanAnomaly;       // rad at epoch
+    double meanMotion;        // rad/s
+    double meanMotionDrift;   // rad/s^2, M grows by meanMotionDrift * dt^2 (TLE ndot/2)
+    double raan;              // Right ascension of the ascending node, rad
+    double argPerigee;        // rad
+    float inclination;        // rad
+    float eccentricity;
+    float semiMajorAxis;      // km
+    float raanRate;           // rad/s, J2 nodal regression
+    float argPerigeeRate;     // rad/s, J2 apsidal rotation
+};
+
+/**
+ * Parses and checks a TLE
+ * @param line1 TLE line 1 ("1 25544U ...")
+ * @param line2 TLE line 2 ("2 25544 ...")
+ * @param elements Receives the elements; elements.valid reflects the result
+ * @return True if both lines are well formed and their checksums match
+ */
+bool orbitParseTle(const char* line1, const char* line2, OrbitElements& elements);
+
+/**
+ * Computes the sub-satellite point
+ * @param elements Parsed elements
+ * @param now Unix time to propagate to
+ * @param latitude Receives the geodetic latitude in degrees (north positive)
+ * @param longitude Receives the longitude in degrees, -180..180 (east positive)
+ * @return False if the elements are not valid
+ */
+bool orbitPosition(const OrbitElements& elements, time_t now, float& latitude, float& longitude);
+
+/**
+ * @param elements Parsed elements
+ * @param now Current Unix time
+ * @return Age of the elements in hours (negative if they are from the future)
+ */
+float orbitAgeHours(const OrbitElements& elements, time_t now);
+
+#endif
@@ -0,0 +1,114 @@
+/*
+ * ISS OTA Update
+ * ==============
+ *
+ * Background firmware updates from the BFF. Every few hours the network task
+ * asks the BFF whether there is newer firmware for the image it is running
+ * (identified by its SHA-256). If there is, the BFF answers with a
+ * compressed delta patch from that image (iss_ota_patch.h) or, for an image
+ * it has no patch for, the whole new image compressed.
+ *
+ * The patch is inflated as it arrives (the ROM's tinfl, with a 32 KB window),
+ * applied against the running partition, and written sector by sector to
+ * the inactive app partition. Like iss_fetch, each otaStep() does one
+ * bounded piece of work. Flash writes stall both cores while the cache is
+ * off, so at most one 4 KB sector is written per step and the writes are
+ * spaced out; the display only ever misses a frame or two. The image is
+ * never applied in place, so nothing changes until it has been checked
+ * against the id in the patch header; the only downtime is the reboot into
+ * it, after which the last-known content (iss_last_known.h) is on screen
+ * straight away.
+ *
+ * A new image boots on trial. It is confirmed as soon as it completes a
+ * good request to the BFF (otaHealthy()). Until then it is rolled back to
+ * the previous partition if it:
+ * - Resets before that (the bootloader reverts a pending image, or with a
+ *   bootloader that cannot, the boot counter kept here does after
+ *   maxTrialBoots)
+ * - Has not managed a good request within the health timeout (otaRollback()
+ *   from the caller's deadline)
+ * A rolled back image is remembered and not downloaded again.
+ *
+ * Patches are not signed. The written image is checked against the id in
+ * the patch header, which catches a corrupt download or a bad patch but not
+ * a forged one: the update is only as trustworthy as the TLS-verified BFF
+ * and the bucket it serves releases from.
+ *
+ * Needs two OTA app partitions, as in the default esp32dev partition table.
+ *
+ * Usage:
+ *   otaBootCheck();                     // early in setup()
+ *   otaIdentify();                      // once the first screen is up
+ *   otaHealthy();                       // after each good request
+ *   if (otaCheckDue()) otaBegin();
+ *   if (otaInProgress()) otaStep();     // each network task iteration
+ */
+
+#ifndef ISS_OTA_H
+#define ISS_OTA_H
+
+#include <Arduino.h>
+
+// How long a new image has to complete a good request (in milliseconds)
+#define OTA_HEALTH_TIMEOUT 600000
+
+/**
+ * Handles a trial boot after an update
+ * Counts the boot and rolls back (restarting) after too many; notes an
+ * update the bootloader has already rolled back. Call it first in setup(),
+ * before any other initialisation a bad image could fail in. It only reads
+ * NVS: the image on trial is recognised by its partition
+ */
+void otaBootCheck();
+
+/**
+ * Computes the id of the running image, unless it is the one on trial
+ * Hashes the whole image (a few hundred milliseconds), so call it after the
+ * first screen is shown and before the network task starts
+ */
+void otaIdentify();
+
+/**
+ * @return True while the running image is a new one not yet confirmed
+ */
+bool otaOnTrial();
+
+/**
+ * Confirms the running image after a good request, ending its trial
+ */
+void otaHealthy();
+
+/**
+ * Returns to the previous image; restarts and does not return unless
+ * there is no valid previous image
+ */
+void otaRollback();
+
+/**
+ * @return True if the next update check is due (never while on trial)
+ */
+bool otaCheckDue();
+
+/**
+ * Starts an update check, downloading and applying an update if there is one
+ * Does nothing if one is already in flight or the heap is too short
+ */
+void otaBegin();
+
+/**
+ * @return True while a check or update is in flight
+ */
+bool otaInProgress();
+
+/**
+ * Advances the update by one bounded step
+ * Restarts into the new image once it has been written and verified
+ */
+void otaStep();
+
+/**
+ * Prints update counters on one Serial line
+ */
+void otaLogStats();
+
+#endif
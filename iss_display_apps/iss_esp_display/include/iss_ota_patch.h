@@ -0,0 +1,132 @@
+/*
+ * ISS OTA Delta Patch
+ * ===================
+ *
+ * Rebuilds a firmware image from the running one and a delta patch written
+ * by scripts/make_ota_patch.py. Portable (no flash or network access), so
+ * the native bench covers it; iss_ota.h does the download and flashing.
+ *
+ * A patch file is a fixed header, then a zlib stream. Once inflated, the
+ * stream is a sequence of bsdiff-style records:
+ *
+ *   addLength    varint     Target bytes formed from source bytes
+ *   copyLength   varint     Target bytes taken from the patch as they are
+ *   seek         zigzag     Source position change after the record
+ *   diff         addLength bytes, each new - old (mod 256)
+ *   extra        copyLength bytes
+ *
+ * Code that moved or was relinked mostly differs in a few address bytes,
+ * so the diff bytes are largely zero and deflate well. A patch against no
+ * source (sourceSize 0) is one copy record: the whole image, compressed.
+ *
+ * Header (little-endian, OTA_PATCH_HEADER_SIZE bytes):
+ *   magic "ISD1", sourceSize u32, targetSize u32,
+ *   sourceId[32], targetId[32]   Image ids as esp_partition_get_sha256()
+ *                                reports them (the SHA-256 appended to the
+ *                                image); sourceId is zero for a full image
+ *
+ * Usage:
+ *   OtaPatch patch;
+ *   patch.begin(header.sourceSize, header.targetSize, readSource, writeTarget, context);
+ *   size_t used = patch.feed(inflated, length);   // as the stream inflates
+ *   if (patch.failed()) ... else if (patch.complete()) ...
+ */
+
+#ifndef ISS_OTA_PATCH_H
+#define ISS_OTA_PATCH_H
+
+#include <Arduino.h>
+
+#define OTA_PATCH_HEADER_SIZE 76
+#define OTA_IMAGE_ID_SIZE 32
+
+struct OtaPatchHeader {
+    uint32_t sourceSize;                   // 0 for a full image
+    uint32_t targetSize;
+    uint8_t sourceId[OTA_IMAGE_ID_SIZE];
+    uint8_t targetId[OTA_IMAGE_ID_SIZE];
+};
+
+/**
+ * Reads source image bytes
+ * @return False if they cannot be read
+ */
+typedef bool (*OtaSourceReader)(uint32_t offset, uint8_t* buffer, size_t length, void* context);
+
+/**
+ * Takes target image bytes, in order
+ * @return False to abort the patch
+ */
+typedef bool (*OtaTargetWriter)(const uint8_t* data, size_t length, void* context);
+
+/**
+ * Parses a patch header
+ * @param data OTA_PATCH_HEADER_SIZE bytes
+ * @return False if the magic is wrong
+ */
+bool otaParseHeader(const uint8_t* data, OtaPatchHeader& header);
+
+class OtaPatch {
+public:
+    OtaPatch();
+
+    /**
+     * Starts applying a patch
+     * @param sourceSize Bytes of source the records may refer to
+     * @param targetSize Bytes the patch must produce
+     * @param reader Source access
+     * @param writer Output of the target image
+     * @param context Passed to both callbacks
+     */
+    void begin(uint32_t sourceSize, uint32_t targetSize,
+               OtaSourceReader reader, OtaTargetWriter writer, void* context);
+
+    /**
+     * Applies the next part of the inflated stream
+     * Produces at most one output byte per input byte, so a caller can
+     * bound the output by bounding the input
+     * @return Bytes used; fewer than length once complete or failed
+     */
+    size_t feed(const uint8_t* data, size_t length);
+
+    /**
+     * @return True once targetSize bytes have been produced
+     */
+    bool complete() const { return stage == STAGE_DONE; }
+
+    /**
+     * @return True if a record was malformed or out of range, or a callback failed
+     */
+    bool failed() const { return stage == STAGE_ERROR; }
+
+    /**
+     * @return Target bytes produced so far
+     */
+    uint32_t produced() const { return written; }
+
+private:
+    enum Stage { STAGE_CONTROL, STAGE_ADD, STAGE_COPY, STAGE_DONE, STAGE_ERROR };
+
+    bool finishControl();
+    void finishRecord();
+
+    OtaSourceReader reader;
+    OtaTargetWriter writer;
+    void* context;
+    uint32_t sourceSize;
+    uint32_t targetSize;
+    uint32_t written;
+    int64_t sourcePos;
+    Stage stage;
+
+    // Control fields being read: addLength, copyLength, seek
+    uint64_t fields[3];
+    int field;
+    int shift;
+    uint32_t addRemaining;
+    uint32_t copyRemaining;
+
+    uint8_t work[256];   // Source bytes for the add being applied
+};
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ * ISS Payload
+ * ===========
+ *
+ * The fields the display takes from a BFF response, and the two decoders
+ * that fill them from a body stream: CBOR field by field (iss_cbor.h), or
+ * JSON through a filtered ArduinoJson document that keeps only those fields,
+ * so the document stays small however long the rest of the payload is.
+ *
+ * Neither decoder touches the network or the clock, so they run unchanged
+ * in the native benchmark build (test/test_bench) against a recorded body.
+ *
+ * Usage:
+ *   ISSData data;
+ *   if (payloadParseCbor(body, data)) ...   // or payloadParseJson()
+ */
+
+#ifndef ISS_PAYLOAD_H
+#define ISS_PAYLOAD_H
+
+#include <Arduino.h>
+#include "iss_orbit.h"
+#include "iss_history.h"
+
+// Locations per request: the current one plus upcoming predictions
+#define FETCH_BATCH_SIZE 6
+
+// A predicted location to show later
+struct ISSUpcoming {
+    time_t at;                   // When the ISS is there (Unix time)
+    bool hasPosition;
+    float latitude;
+    float longitude;
+    char locationDetails[96];
+    char funFact[480];
+};
+
+// Fields extracted from a successful BFF response
+struct ISSData {
+    bool valid;                  // False until a payload has parsed
+    char funFact[480];
+    char locationDetails[96];
+    char timestamp[40];
+    bool hasPosition;            // False if latitude/longitude were missing
+    float latitude;
+    float longitude;
+    char tleLine1[TLE_LINE_LENGTH + 1];  // Empty if the BFF sent no TLE
+    char tleLine2[TLE_LINE_LENGTH + 1];
+    ISSUpcoming upcoming[FETCH_BATCH_SIZE - 1];  // Ordered by time
+    int upcomingCount;
+    GroundTrack track;           // Stored locations before this one; count 0 if none
+};
+
+/**
+ * Parses a JSON body into the result, reading it straight from the stream
+ * @param body Response body
+ * @param result Receives the fields (partly written on failure); valid is
+ *        left to the caller
+ * @return True if the body parsed
+ */
+bool payloadParseJson(Stream& body, ISSData& result);
+
+/**
+ * Decodes a CBOR body field by field into the result
+ * Same fields as the JSON form, without a document in between
+ * @param body Response body
+ * @param result Receives the fields (partly written on failure); valid is
+ *        left to the caller
+ * @return True if the body decoded
+ */
+bool payloadParseCbor(Stream& body, ISSData& result);
+
+#endif
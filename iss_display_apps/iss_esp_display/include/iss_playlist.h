@@ -0,0 +1,99 @@
+/*
+ * ISS Display Playlist
+ * ====================
+ *
+ * Rotating set of display items handed from the network task (core 0) to
+ * the display loop (core 1): the current location with its fact, previews
+ * of the upcoming locations of a batched response, and status messages.
+ * Items are formatted and transliterated once by the producer; the display
+ * loop only copies the next one into its scroll engines when it comes round.
+ *
+ * The playlist is a fixed ring of PLAYLIST_CAPACITY slots written in place
+ * by the single producer. Each slot carries a sequence counter (odd while
+ * being written). The consumer never waits for a slot the producer is still
+ * writing, or one rewritten while it was copied: it keeps what it shows and
+ * looks again on its next poll. Neither side ever blocks, spins or takes a
+ * mutex.
+ *
+ * Every item has a key (one slot per key; writing a key again replaces its
+ * item), a priority and an optional expiry time. The display rotates
+ * through the live items of the highest priority present, in ring order,
+ * and moves on once the current one has been shown in full. Items committed
+ * with showNow (new content rather than more of it) are shown straight away
+ * when they are of that priority. A full playlist gives up the oldest slot
+ * of a lower priority only.
+ *
+ * Producer:
+ *   DisplaySnapshot* item = playlistBeginWrite(PLAYLIST_LOCATION, PLAYLIST_NORMAL, 0);
+ *   if (item) { ...fill item...; playlistCommit(true); }
+ *   playlistRemove(PLAYLIST_STATUS);
+ *
+ * Consumer:
+ *   if (playlistPoll(local, shownInFull)) { ...show local... }
+ */
+
+#ifndef ISS_PLAYLIST_H
+#define ISS_PLAYLIST_H
+
+#include <Arduino.h>
+#include <time.h>
+#include "iss_snapshot.h"
+
+// Items held at once (about 1.1 KB each)
+#define PLAYLIST_CAPACITY 8
+
+// Item keys; upcoming locations use PLAYLIST_UPCOMING + their index
+enum PlaylistKey {
+    PLAYLIST_STATUS,        // Error shown instead of everything else
+    PLAYLIST_LOCATION,      // Current location and its fact
+    PLAYLIST_TRACK,         // Speed, heading and trail from the ground track
+    PLAYLIST_UPCOMING       // First of the previews of a batched response
+};
+
+enum PlaylistPriority {
+    PLAYLIST_NORMAL = 1,    // Rotated with the other normal items
+    PLAYLIST_URGENT = 2     // Shown alone while it is in the playlist
+};
+
+/**
+ * Returns the slot to fill for an item; a key written before keeps its slot
+ * (and its previous content). Must be followed by playlistCommit().
+ * @param key PlaylistKey of the item
+ * @param priority PlaylistPriority
+ * @param expiresAt Unix time the item is dropped at, 0 to keep it
+ * @return The content to fill, NULL if the playlist is full of items that
+ *         outrank it
+ */
+DisplaySnapshot* playlistBeginWrite(int key, uint8_t priority, time_t expiresAt);
+
+/**
+ * Makes the item from playlistBeginWrite() visible to the display loop
+ * @param showNow Show it at once instead of waiting for its turn
+ */
+void playlistCommit(bool showNow);
+
+/**
+ * Drops an item, if present (producer only)
+ */
+void playlistRemove(int key);
+
+/**
+ * Producer convenience: a fixed two-line message in one call, shown at once
+ * Lines longer than SNAPSHOT_LINE_SIZE - 1 are truncated
+ * @param redrawNow Draw immediately instead of waiting for the next scroll tick
+ */
+void playlistPublishLines(int key, uint8_t priority,
+                          const char* line1, const char* line2,
+                          uint8_t red, uint8_t green, uint8_t blue,
+                          bool redrawNow);
+
+/**
+ * Picks what the display should show (display loop only)
+ * Cheap when nothing changed; expiry is checked about once a second
+ * @param out Receives the item to switch to
+ * @param advance True if the item shown has had its turn
+ * @return True if out holds an item to show (new, rewritten or next in turn)
+ */
+bool playlistPoll(DisplaySnapshot& out, bool advance);
+
+#endif
@@ -0,0 +1,57 @@
+/*
+ * ISS Poll Policy
+ * ===============
+ *
+ * Decides when to poll the BFF next, replacing the fixed 5 minute timer.
+ *
+ * - After a successful update the server's max-age hint (the time until it
+ *   expects the next location to be stored) is followed, so a new fact is
+ *   picked up shortly after it is published rather than up to one period late.
+ *   For a batched response the hint covers all of its locations.
+ * - A 304 Not Modified means we asked a little early; without a hint the
+ *   next poll follows soon after.
+ * - Failures back off exponentially with equal jitter, so a fleet of
+ *   displays does not hammer the BFF in step while it is down.
+ *
+ * - While the push stream (iss_push.h) is up, new locations trigger updates
+ *   directly and the timer is only a fallback, stretched to half an hour.
+ *
+ * All delays get a small random jitter and are clamped to sane bounds.
+ *
+ * Usage:
+ *   scheduler.runIn(updateJob, pollDelayAfterUpdate(changed, fetchPollHint()));
+ *   scheduler.runIn(updateJob, pollDelayAfterFailure(fetchPollHint()));
+ */
+
+#ifndef ISS_POLL_H
+#define ISS_POLL_H
+
+#include <Arduino.h>
+
+/**
+ * @param changed True for new data (200), false for 304 Not Modified
+ * @param hintSeconds Server freshness hint in seconds, or -1 if none
+ * @return Milliseconds until the next poll
+ */
+unsigned long pollDelayAfterUpdate(bool changed, long hintSeconds);
+
+/**
+ * Counts a failed update and computes the backoff
+ * @param hintSeconds Server Retry-After in seconds, or -1 if none
+ * @return Milliseconds until the next poll
+ */
+unsigned long pollDelayAfterFailure(long hintSeconds);
+
+/**
+ * Stretches a poll delay while push announcements cover new locations
+ * @param delayMs Delay from pollDelayAfterUpdate()
+ * @return Milliseconds until the fallback poll
+ */
+unsigned long pollDelayWithPush(unsigned long delayMs);
+
+/**
+ * @return Failed updates since the last success
+ */
+int pollConsecutiveFailures();
+
+#endif
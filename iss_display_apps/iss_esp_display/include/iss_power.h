@@ -0,0 +1,90 @@
+/*
+ * ISS Power Modes
+ * ===============
+ *
+ * Duty-cycling for battery deployments, selected at build time with
+ * ISS_POWER_MODE (see platformio.ini):
+ *
+ *   POWER_MODE_ACTIVE (default)  240 MHz, radio associated, SDK default
+ *                                modem sleep. Same behaviour as before.
+ *   POWER_MODE_MODEM_SLEEP       80 MHz, radio associated with maximum
+ *                                modem sleep (sleeps across DTIM beacons).
+ *   POWER_MODE_LIGHT_SLEEP       80 MHz, radio switched off between fetches
+ *                                and light sleep between display jobs, woken
+ *                                by the RTC timer. The next fetch brings the
+ *                                radio back through iss_wifi's fast reconnect.
+ *
+ * Light sleep keeps RAM and the LCD contents, so the scroll engines simply
+ * resume where they were; the display loop decides how long to sleep from
+ * both schedulers, so no network job is ever late.
+ *
+ * To compare modes, the module tracks how long the CPU was awake and the
+ * radio on, and logs an average current estimated from that residency. A
+ * measured figure is logged too when the build provides powerMeasuredCurrent()
+ * (e.g. reading an INA219 in averaging mode), and POWER_MARKER_PIN, if
+ * defined, is driven high while awake for a scope or logging meter.
+ *
+ * Usage:
+ *   powerBegin();                                  // setup(), before WiFi starts
+ *   if (!powerLightSleep(ms)) vTaskDelay(...);     // display loop
+ *   if (powerRadioCanSleep()) powerRadioSleep();   // network task, after a fetch
+ *   if (powerRadioAsleep()) powerRadioWake();      // network task, before a fetch
+ */
+
+#ifndef ISS_POWER_H
+#define ISS_POWER_H
+
+#include <Arduino.h>
+
+#define POWER_MODE_ACTIVE 0
+#define POWER_MODE_MODEM_SLEEP 1
+#define POWER_MODE_LIGHT_SLEEP 2
+
+#ifndef ISS_POWER_MODE
+#define ISS_POWER_MODE POWER_MODE_ACTIVE
+#endif
+
+/**
+ * Applies the CPU clock and WiFi power save of the selected mode
+ */
+void powerBegin();
+
+/**
+ * Light sleeps until the next job is due, if the mode and radio allow it
+ * @param ms Milliseconds until the next job on either core
+ * @return True if it slept; otherwise the caller waits as usual
+ */
+bool powerLightSleep(unsigned long ms);
+
+/**
+ * @return True if the mode switches the radio off between fetches
+ */
+bool powerRadioCanSleep();
+
+/**
+ * Switches the radio off until powerRadioWake()
+ */
+void powerRadioSleep();
+
+/**
+ * Marks the radio as on again; reconnect with wifiReconnect() afterwards
+ */
+void powerRadioWake();
+
+/**
+ * @return True while the radio is switched off by powerRadioSleep()
+ */
+bool powerRadioAsleep();
+
+/**
+ * Optional measurement hook, to be defined by the build for a current meter
+ * @return Average supply current in mA, or a negative value if unavailable
+ */
+float powerMeasuredCurrent();
+
+/**
+ * Prints mode, residency and average current on one Serial line
+ */
+void powerLogStats();
+
+#endif
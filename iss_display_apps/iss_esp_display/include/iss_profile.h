@@ -0,0 +1,124 @@
+/*
+ * ISS Profiler
+ * ============
+ *
+ * Cycle-accurate profiling build. Scoped regions are timed with the CPU
+ * cycle counter (CCOUNT, via ESP.getCycleCount()), which costs a couple of
+ * cycles to read, so even a single LCD write or a JSON decode can be
+ * measured where millis() would show nothing.
+ *
+ * Each region keeps calls, min, mean and max since the last reset, and its
+ * last PROFILE_RING_SIZE samples in a static ring buffer for the p99. Regions
+ * nest: every core keeps the stack of open regions, and the self time of
+ * each stack (time not spent in a nested region) is summed per path, so the
+ * dump ends with folded stacks ready for flamegraph.pl.
+ *
+ * CCOUNT is per core and the tasks are pinned (network task on core 0,
+ * display loop on core 1), so a region always starts and ends on the same
+ * counter. It wraps after about 18 s at 240 MHz, far longer than any region
+ * here. Cycles are converted to microseconds at the current CPU clock.
+ *
+ * Off unless ISS_PROFILE is defined as 1; compiled out, PROFILE_SCOPE is
+ * empty and the serial commands are inline no-ops, so the normal build
+ * carries no code or data for it.
+ *
+ * Serial commands, read by profilePoll() from the display loop:
+ *   p   print the summary and folded stacks
+ *   r   reset all figures
+ *
+ * Usage:
+ *   void displayScrollingData() {
+ *       PROFILE_SCOPE(PROFILE_FRAME);   // timed until the end of the block
+ *       ...
+ *   }
+ *   profilePoll();                       // display loop
+ */
+
+#ifndef ISS_PROFILE_H
+#define ISS_PROFILE_H
+
+#include <Arduino.h>
+
+#ifndef ISS_PROFILE
+#define ISS_PROFILE 0
+#endif
+
+// Samples kept per region for the p99
+#define PROFILE_RING_SIZE 128
+
+// Nesting depth tracked for the folded stacks; deeper regions are still timed
+#define PROFILE_MAX_DEPTH 4
+
+// Timed regions
+enum ProfileRegion {
+    PROFILE_FRAME,          // One display frame
+    PROFILE_SCROLL,         // Scroll windows copied into the framebuffer
+    PROFILE_LCD_WRITE,      // Framebuffer flush: the I2C writes to the LCD
+    PROFILE_SNAPSHOT,       // New content applied on the display loop
+    PROFILE_POSITION,       // Orbit propagation and the position field
+    PROFILE_FETCH_STEP,     // One step of the BFF request
+    PROFILE_PARSE,          // Body decode, CBOR or JSON
+    PROFILE_PUSH_STEP,      // One step of the push stream
+    PROFILE_PUBLISH,        // Formatting a location into a snapshot
+    PROFILE_TRANSLITERATE,  // UTF-8 to LCD characters
+    PROFILE_OTA_STEP,       // One step of a firmware check or update
+    PROFILE_REGION_COUNT
+};
+
+#if ISS_PROFILE
+
+/**
+ * Opens a region on the calling core (use PROFILE_SCOPE instead)
+ */
+void profileEnter(ProfileRegion region);
+
+/**
+ * Closes the innermost region on the calling core
+ * @param cycles Cycles since the matching profileEnter()
+ */
+void profileExit(ProfileRegion region, uint32_t cycles);
+
+// Times the rest of the enclosing block
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileRegion region) : region(region) {
+        profileEnter(region);
+        start = ESP.getCycleCount();
+    }
+    ~ProfileScope() { profileExit(region, ESP.getCycleCount() - start); }
+
+private:
+    ProfileRegion region;
+    uint32_t start;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(region) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(region)
+
+/**
+ * Handles a pending serial command, if any (display loop only)
+ */
+void profilePoll();
+
+/**
+ * Prints the per-region summary and the folded stacks over Serial
+ */
+void profileDump();
+
+/**
+ * Clears all figures; regions open at the time are still recorded
+ */
+void profileReset();
+
+#else
+
+#define PROFILE_SCOPE(region) ((void)0)
+
+inline void profilePoll() {}
+inline void profileDump() {}
+inline void profileReset() {}
+
+#endif
+
+#endif
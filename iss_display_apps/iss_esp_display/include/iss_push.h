@@ -0,0 +1,80 @@
+/*
+ * ISS Push Channel
+ * ================
+ *
+ * Keeps one long-lived server-sent event stream open to the BFF's stream
+ * service (?stream=1 on bffStreamHost, see iss_http.h), which announces
+ * each new stored location within seconds of iss_api_store_realtime_loc
+ * writing it. The announcement is small; the caller fetches the location
+ * and fact through iss_fetch as usual, so the display logic, batching and
+ * caching stay the same and only the trigger changes from a timer to the
+ * push.
+ *
+ * The stream is read step by step from the network task like a fetch, on
+ * its own TLS connection. The server ends each stream after a while (and
+ * proxies may drop it); the client reconnects with Last-Event-ID, and the
+ * server repeats the newest location if it is not the one last seen, so no
+ * announcement is lost across a reconnect. Failed connections back off up
+ * to five minutes. A server without stream support disables the channel.
+ *
+ * While the stream is up, timer polls are only a fallback; PUSH_LOST tells
+ * the caller to go back to its regular polling.
+ *
+ * Enabled unless ISS_PUSH is defined as 0, and always off in
+ * POWER_MODE_LIGHT_SLEEP, where the radio is off between fetches.
+ *
+ * Usage:
+ *   pushBegin();                          // once WiFi is up
+ *   PushEvent event = pushStep();         // each network task iteration
+ *   if (event == PUSH_LOCATION) ...       // pushLastTimestamp() is new
+ */
+
+#ifndef ISS_PUSH_H
+#define ISS_PUSH_H
+
+#include <Arduino.h>
+#include "iss_power.h"
+
+#ifndef ISS_PUSH
+#define ISS_PUSH 1
+#endif
+#if ISS_POWER_MODE == POWER_MODE_LIGHT_SLEEP
+#undef ISS_PUSH
+#define ISS_PUSH 0
+#endif
+
+// Outcome of a push step
+enum PushEvent {
+    PUSH_NONE,       // Nothing new
+    PUSH_LOCATION,   // A location other than the last one was announced
+    PUSH_LOST        // The stream went down; poll on the regular schedule
+};
+
+/**
+ * Starts connecting the stream; does nothing if push is disabled
+ */
+void pushBegin();
+
+/**
+ * Advances the connection or reads what has arrived on the stream
+ * @return The event, if any, from this step
+ */
+PushEvent pushStep();
+
+/**
+ * @return True while the stream is up (or reconnecting after a clean end),
+ *         i.e. new locations will be announced
+ */
+bool pushConnected();
+
+/**
+ * @return Timestamp of the last announced location, or "" before the first
+ */
+const char* pushLastTimestamp();
+
+/**
+ * Prints stream counters on one Serial line
+ */
+void pushLogStats();
+
+#endif
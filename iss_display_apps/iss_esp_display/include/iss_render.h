@@ -0,0 +1,66 @@
+/*
+ * ISS Render Clock
+ * ================
+ *
+ * Frame clock for the display loop, paced by a periodic esp_timer instead of
+ * the loop's own millis() checks. Each tick only counts a frame and wakes
+ * the display loop task (core 1); the frame itself (backlight fade step,
+ * scroll step, framebuffer flush) runs there, so the timer task on core 0
+ * spends a few microseconds per frame and the network task is not held up.
+ *
+ * A late or busy loop does not accumulate backlog: renderElapsedUs() returns
+ * the frame time of all ticks since the previous call, and animations
+ * advance by that much in a single frame.
+ *
+ * The HD44780 cannot scroll by pixels across a row: every cell of a shifted
+ * row shows a different glyph, and CGRAM holds eight (already used for the
+ * accented letters, iss_charset.h). The text therefore still moves by whole
+ * characters, timed by the frame clock rather than a scheduler job.
+ *
+ * ISS_RENDER_HZ defaults to 32. It is forced to 0 in POWER_MODE_LIGHT_SLEEP,
+ * where a frame clock would keep the CPU awake; the display loop then
+ * scrolls from a scheduler job and colour changes are immediate.
+ *
+ * Usage (display loop task):
+ *   renderBegin();
+ *   uint32_t elapsedUs = renderElapsedUs();
+ *   if (elapsedUs > 0) ...              // draw a frame, animations advanced
+ *   renderWait(maxMs);                  // until the next frame or maxMs
+ */
+
+#ifndef ISS_RENDER_H
+#define ISS_RENDER_H
+
+#include <Arduino.h>
+#include "iss_power.h"
+
+#ifndef ISS_RENDER_HZ
+#define ISS_RENDER_HZ 32
+#endif
+#if ISS_POWER_MODE == POWER_MODE_LIGHT_SLEEP
+#undef ISS_RENDER_HZ
+#define ISS_RENDER_HZ 0
+#endif
+
+#if ISS_RENDER_HZ
+// Time one frame stands for, in microseconds
+#define RENDER_FRAME_US (1000000UL / ISS_RENDER_HZ)
+#endif
+
+/**
+ * Starts the frame clock; frames wake the calling task
+ * @return False if the timer could not be started (or ISS_RENDER_HZ is 0)
+ */
+bool renderBegin();
+
+/**
+ * @return Frame time elapsed since the previous call (us), 0 if no tick
+ */
+uint32_t renderElapsedUs();
+
+/**
+ * Blocks until the next frame tick, or at most maxMs
+ */
+void renderWait(unsigned long maxMs);
+
+#endif
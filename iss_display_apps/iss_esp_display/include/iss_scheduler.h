@@ -0,0 +1,115 @@
+/*
+ * ISS Cooperative Scheduler
+ * =========================
+ *
+ * Small fixed-size scheduler for periodic and one-shot jobs, replacing
+ * hand-written millis() bookkeeping and delay() calls. Each task that needs
+ * timed work owns one Scheduler and calls runPending() from its loop; job
+ * callbacks must return quickly and never block.
+ *
+ * Every run records how late the job started relative to its due time, so
+ * timing problems show up in logStats() instead of as visible stutter.
+ *
+ * Usage:
+ *   Scheduler scheduler("display");
+ *   int scrollJob = scheduler.every("scroll", scrollTick, 450);
+ *   ...
+ *   scheduler.runPending();              // from loop()
+ *   scheduler.postpone(scrollJob, 1000); // e.g. pause at the end of a line
+ */
+
+#ifndef ISS_SCHEDULER_H
+#define ISS_SCHEDULER_H
+
+#include <Arduino.h>
+
+// Maximum number of jobs per scheduler
+#define SCHEDULER_MAX_JOBS 8
+
+typedef void (*JobCallback)();
+
+// Timing of a job's runs
+struct JobStats {
+    uint32_t runs;
+    unsigned long lastLateness;    // ms between due time and start of the last run
+    unsigned long maxLateness;     // Worst lateness since boot
+    unsigned long totalLateness;   // Sum over all runs, for the mean
+};
+
+class Scheduler {
+public:
+    explicit Scheduler(const char* name);
+
+    /**
+     * Adds a periodic job, first due one interval from now
+     * @param name Short name for logging
+     * @param callback Function to run
+     * @param interval Period in milliseconds
+     * @param enabled False to add the job paused
+     * @return Job id, or -1 if the scheduler is full
+     */
+    int every(const char* name, JobCallback callback, unsigned long interval, bool enabled = true);
+
+    /**
+     * Adds a one-shot job, initially idle; arm it with runIn()
+     * @return Job id, or -1 if the scheduler is full
+     */
+    int once(const char* name, JobCallback callback);
+
+    /**
+     * (Re)arms a job to run after a delay
+     * @param job Job id
+     * @param delayMs Delay in milliseconds (0 runs it on the next runPending())
+     */
+    void runIn(int job, unsigned long delayMs);
+
+    /**
+     * Pushes a job's next run back by extra time
+     * May be called from the job's own callback
+     */
+    void postpone(int job, unsigned long extraMs);
+
+    /**
+     * Pauses or resumes a job; a resumed periodic job is due one interval later
+     */
+    void setEnabled(int job, bool enabled);
+
+    /**
+     * Runs every job that is due
+     */
+    void runPending();
+
+    /**
+     * @return Milliseconds until the next job is due (0 if one is due now)
+     */
+    unsigned long msUntilNext() const;
+
+    /**
+     * @return Timing statistics for a job
+     */
+    const JobStats& stats(int job) const;
+
+    /**
+     * Prints one line per job with its run count and lateness
+     */
+    void logStats() const;
+
+private:
+    struct Job {
+        const char* name;
+        JobCallback callback;
+        unsigned long interval;   // 0 for one-shot jobs
+        unsigned long nextRun;    // millis() when due
+        bool enabled;
+        JobStats stats;
+    };
+
+    int add(const char* name, JobCallback callback, unsigned long interval, bool enabled);
+    bool valid(int job) const { return job >= 0 && job < jobCount; }
+
+    const char* name;
+    Job jobs[SCHEDULER_MAX_JOBS];
+    int jobCount;
+};
+
+#endif
@@ -0,0 +1,85 @@
+/*
+ * ISS Line Scroller
+ * =================
+ *
+ * Scroll engine for one display row. Each row owns its own engine, so a
+ * short line is never dragged along by the length of the other one.
+ *
+ * setText() lays the message out once as a padded ring: the text, a gap of
+ * spaces, then the first LCD_COLUMNS characters again. Any window of the
+ * ring is therefore one contiguous LCD_COLUMNS-byte slice, and a tick only
+ * moves an offset; no per-frame string work is done.
+ *
+ * Text that fits on the display is shown padded and does not scroll.
+ *
+ * Usage:
+ *   ScrollEngine row0;
+ *   row0.setText(line, length, pauseTicks);  // when new content arrives
+ *   framebufferSetRow(0, row0.window(), LCD_COLUMNS);
+ *   row0.tick();                              // once per scroll step
+ */
+
+#ifndef ISS_SCROLLER_H
+#define ISS_SCROLLER_H
+
+#include <Arduino.h>
+#include "iss_framebuffer.h"
+#include "iss_snapshot.h"
+
+// Spaces between the end of a message and its start coming round again
+#define SCROLL_GAP 4
+
+class ScrollEngine {
+public:
+    ScrollEngine();
+
+    /**
+     * Lays out a new message and rewinds to its start
+     * @param text Characters to show (need not be terminated)
+     * @param length Number of characters; cut to SNAPSHOT_LINE_SIZE - 1
+     * @param pauseTicks Ticks to hold the start of the message in view
+     */
+    void setText(const char* text, int length, int pauseTicks);
+
+    /**
+     * Overwrites part of the message in place, keeping the scroll position
+     * Used for fields that change between updates, such as the live position
+     * @param start Offset of the first character to replace
+     * @param text Replacement characters
+     * @param count Number of characters; the message length never changes
+     */
+    void patch(int start, const char* text, int count);
+
+    /**
+     * @return LCD_COLUMNS characters for the current frame (not terminated)
+     */
+    const char* window() const { return ring + offset; }
+
+    /**
+     * Advances the window by one character, holding at the start of the
+     * message for the configured number of ticks
+     */
+    void tick();
+
+    /**
+     * @return True if the message is longer than the display
+     */
+    bool scrolls() const { return period > 0; }
+
+    /**
+     * @return True once the whole message has been in view: at once if it
+     *         fits, otherwise after it has come round to its start again
+     */
+    bool shownInFull() const { return period == 0 || wrapped; }
+
+private:
+    char ring[SNAPSHOT_LINE_SIZE + SCROLL_GAP + LCD_COLUMNS];
+    int length;      // Message length
+    int period;      // Text plus gap, 0 for text that fits
+    int offset;      // Start of the current window in ring
+    int pauseTicks;
+    int holdLeft;    // Ticks left before leaving the start
+    bool wrapped;    // Came round to the start since setText()
+};
+
+#endif
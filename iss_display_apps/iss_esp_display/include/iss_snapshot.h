@@ -0,0 +1,37 @@
+/*
+ * ISS Display Snapshot
+ * ====================
+ *
+ * One item of display content: both lines, ready for the LCD, with the
+ * backlight colour and the live position field. Items are handed from the
+ * network task to the display loop through the playlist (iss_playlist.h)
+ * and the last good one is kept in flash (iss_last_known.h).
+ */
+
+#ifndef ISS_SNAPSHOT_H
+#define ISS_SNAPSHOT_H
+
+#include <Arduino.h>
+#include "iss_orbit.h"
+
+// Capacity of each display line, including the null terminator
+#define SNAPSHOT_LINE_SIZE 512
+
+// Content the display loop should show
+struct DisplaySnapshot {
+    char line1[SNAPSHOT_LINE_SIZE];
+    char line2[SNAPSHOT_LINE_SIZE];
+    uint8_t red;        // Backlight colour
+    uint8_t green;
+    uint8_t blue;
+    bool hasLines;      // False to keep the text currently shown
+    bool redrawNow;     // Show immediately instead of waiting for the next scroll tick
+
+    // Live position shown in line1 (only used with hasLines)
+    int positionColumn;     // Offset of the position field in line1, -1 if none
+    float latitude;         // Position reported by the server, degrees
+    float longitude;
+    OrbitElements orbit;    // Propagated every second when valid
+};
+
+#endif
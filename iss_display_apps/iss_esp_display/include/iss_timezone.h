@@ -0,0 +1,75 @@
+/*
+ * ISS Timezone and Clock
+ * ======================
+ *
+ * Resolves the local timezone and keeps the clock synced over NTP.
+ *
+ * The IANA zone name from IP geolocation (ip-api.com) is mapped to a POSIX
+ * TZ rule through a sorted table in flash (src/iss_tz_table.cpp, generated
+ * by scripts/generate_tz_table.py), found by binary search. The result is
+ * cached in NVS, so warm boots apply it straight away and skip the
+ * geolocation request entirely.
+ *
+ * NTP runs in the background (lwIP SNTP). timezonePollSync() checks on it
+ * without blocking and restarts it if no time arrives before the deadline.
+ *
+ * Usage (network task):
+ *   if (!timezoneBegin()) {
+ *       timezoneResolve();            // cold boot: one bounded HTTP request
+ *   }
+ *   ...
+ *   timezonePollSync();               // every few hundred ms until it returns true
+ */
+
+#ifndef ISS_TIMEZONE_H
+#define ISS_TIMEZONE_H
+
+#include <Arduino.h>
+
+// One IANA zone and its POSIX rule
+struct TimezoneEntry {
+    const char* name;
+    const char* posix;
+};
+
+// Generated table, sorted by name
+extern const TimezoneEntry timezoneTable[];
+extern const size_t timezoneTableSize;
+
+/**
+ * Finds the POSIX rule for an IANA zone name
+ * @param name Zone name, e.g. "Europe/Paris"
+ * @return The POSIX rule, or NULL if the zone is unknown
+ */
+const char* timezoneLookup(const char* name);
+
+/**
+ * Applies the cached timezone (or UTC) and starts NTP
+ * @return True if a cached timezone was applied
+ */
+bool timezoneBegin();
+
+/**
+ * Looks up the timezone from IP geolocation, applies it and caches it
+ * Blocks for at most a few seconds; call from the network task
+ * @return True if a timezone was resolved
+ */
+bool timezoneResolve();
+
+/**
+ * Checks on NTP without blocking, restarting it after the sync deadline
+ * @return True once the clock has been set
+ */
+bool timezonePollSync();
+
+/**
+ * @return True once the clock has been set from NTP
+ */
+bool timezoneSynced();
+
+/**
+ * @return The IANA name of the active timezone, or "UTC"
+ */
+const char* timezoneName();
+
+#endif
@@ -0,0 +1,143 @@
+/*
+ * ISS TLS Client
+ * ==============
+ *
+ * Long-lived TLS client built directly on mbedTLS and a non-blocking lwIP
+ * socket. Compared to WiFiClientSecure it adds:
+ * - Separate, non-blocking TCP connect and TLS handshake steps
+ * - Session ticket caching, so a reconnect resumes the previous session with
+ *   an abbreviated handshake and falls back to a full one only when the
+ *   server rejects the ticket
+ * - Connection state that can be checked cheaply between requests, so an
+ *   HTTP keep-alive connection can be reused
+ * - Server verification against a small bundle of roots (src/iss_ca_bundle.cpp,
+ *   generated by scripts/generate_ca_bundle.py). The DER certificates are
+ *   parsed in place from flash once and shared by every client, so a full
+ *   handshake checks a two-link chain against five roots instead of a PEM
+ *   decode or a search of the whole Mozilla bundle, and a resumed one skips
+ *   the certificate entirely. Until NTP has set the clock the validity
+ *   dates cannot be judged and only the chain and the host name are checked.
+ *
+ * The client implements Arduino's Client interface for reading and writing.
+ */
+
+#ifndef ISS_TLS_H
+#define ISS_TLS_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/x509_crt.h>
+
+// A trusted root certificate, DER encoded
+struct CaCertificate {
+    const char* name;
+    const uint8_t* der;
+    size_t length;
+};
+
+// Roots the server chain must lead to (generated table)
+extern const CaCertificate caBundle[];
+extern const size_t caBundleSize;
+
+// Connection lifecycle
+enum TlsPhase {
+    TLS_CLOSED,          // No socket
+    TLS_TCP_CONNECTING,  // Waiting for the TCP connect to complete
+    TLS_HANDSHAKING,     // TLS handshake in progress
+    TLS_OPEN,            // Ready for application data
+    TLS_PEER_CLOSED      // Server closed; buffered data may still be read
+};
+
+class IssTlsClient : public Client {
+public:
+    IssTlsClient();
+    ~IssTlsClient();
+
+    /**
+     * Starts a non-blocking TCP connection
+     * @param ip Server address
+     * @param port Server port
+     * @param host Server name for SNI (must outlive the connection)
+     * @return False if the socket could not be created
+     */
+    bool beginConnect(IPAddress ip, uint16_t port, const char* host);
+
+    /**
+     * Checks whether the TCP connection has completed
+     * @return 1 when connected, 0 while in progress, -1 on failure
+     */
+    int pollConnect();
+
+    /**
+     * Advances the TLS handshake as far as the received data allows
+     * Uses the cached session ticket, if any
+     * @return 1 when the handshake is complete, 0 while in progress, -1 on failure
+     */
+    int pollHandshake();
+
+    /**
+     * @return True if the connection is open with nothing left unread,
+     *         i.e. a new request can be sent on it
+     */
+    bool isReusable();
+
+    /**
+     * @return True if the last completed handshake resumed a cached session
+     */
+    bool lastHandshakeResumed() const { return resumed; }
+
+    /**
+     * Drops the cached session so the next handshake is a full one
+     */
+    void forgetSession();
+
+    /**
+     * Sets the time limit for blocking calls (connect() and write())
+     */
+    void setTimeout(unsigned long timeoutMs) { this->timeoutMs = timeoutMs; }
+
+    TlsPhase phase() const { return currentPhase; }
+
+    // Client interface
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char* host, uint16_t port) override;
+    size_t write(uint8_t b) override;
+    size_t write(const uint8_t* buf, size_t size) override;
+    int available() override;
+    int read() override;
+    int read(uint8_t* buf, size_t size) override;
+    int peek() override;
+    void flush() override;
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() override { return connected(); }
+
+private:
+    bool init();
+    void closeSocket();
+    void markPeerClosed();
+
+    bool initialized;
+    mbedtls_ssl_context ssl;
+    mbedtls_ssl_config conf;
+    mbedtls_entropy_context entropy;
+    mbedtls_ctr_drbg_context drbg;
+    mbedtls_net_context net;
+
+    mbedtls_ssl_session session;   // Last negotiated session, including its ticket
+    bool sessionCached;
+    bool resumed;
+    bool sawCertificate;           // Server sent a certificate, i.e. a full handshake
+
+    TlsPhase currentPhase;
+    int socketFd;
+    const char* serverHost;
+    int peekedByte;
+    unsigned long timeoutMs;
+};
+
+#endif
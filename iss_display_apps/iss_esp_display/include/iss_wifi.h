@@ -0,0 +1,62 @@
+/*
+ * ISS WiFi Fast Connect
+ * =====================
+ *
+ * WiFi bring-up that skips the channel scan and, where possible, DHCP.
+ *
+ * After each successful connection the AP's BSSID and channel are cached in
+ * NVS (surviving power loss), and with the DHCP lease also in RTC memory
+ * (surviving resets and deep sleep, but not power loss). The next connection
+ * goes straight to that AP on that channel, and reuses the lease as a static
+ * configuration when it came from RTC memory, which usually brings the link up
+ * in a few hundred ms instead of seconds. A lease is only reused until the
+ * time the DHCP client would have renewed it (T1, at most 12 hours after it
+ * was granted); after that a new connection runs DHCP, and wifiCheckLease()
+ * switches a link still running on the reused address over to DHCP, so an
+ * address the router may hand to another host is never kept. A fixed address can be set instead
+ * with WIFI_STATIC_IP / WIFI_GATEWAY / WIFI_SUBNET / WIFI_DNS in secrets.h.
+ *
+ * If the direct attempt does not connect within fastConnectTimeout (AP moved
+ * channel, lease no longer valid, ...) wifiPoll() forgets the cache and falls
+ * back to a normal scan with DHCP.
+ *
+ * Usage:
+ *   wifiBegin(ssid, password);   // setup()
+ *   if (wifiPoll()) { ... }      // every ~100 ms while connecting
+ *   wifiReconnect();             // after the link was lost
+ *   wifiCheckLease();            // every minute or so
+ */
+
+#ifndef ISS_WIFI_H
+#define ISS_WIFI_H
+
+#include <Arduino.h>
+
+/**
+ * Starts connecting, directly to the cached AP if there is one
+ * Returns at once; poll with wifiPoll()
+ * @param ssid Network name
+ * @param password Network password (kept by pointer)
+ */
+void wifiBegin(const char* ssid, const char* password);
+
+/**
+ * Drops the current link and starts connecting again
+ */
+void wifiReconnect();
+
+/**
+ * Checks on the connection without blocking
+ * Falls back to a full scan when a direct attempt times out, and caches the
+ * AP details once connected
+ * @return True while connected
+ */
+bool wifiPoll();
+
+/**
+ * Moves a link running on a reused lease over to DHCP once the lease is due
+ * for renewal, and caches the new lease when DHCP has bound
+ */
+void wifiCheckLease();
+
+#endif
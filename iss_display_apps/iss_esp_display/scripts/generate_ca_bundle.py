@@ -0,0 +1,94 @@
+"""
+Generates src/iss_ca_bundle.cpp, the root certificates the TLS client trusts.
+
+Cloud Run (*.run.app) certificates are issued by Google Trust Services, so
+the bundle holds the GTS roots and GlobalSign Root CA, which cross-signs
+GTS Root R1 for older chains. The certificates are stored as DER, which
+mbedTLS parses in place from flash without a PEM decode or a heap copy.
+
+Usage:
+    python3 scripts/generate_ca_bundle.py [certs_dir]
+"""
+
+import base64
+import os
+import re
+import sys
+
+DEFAULT_CERTS_DIR = '/etc/ssl/certs'
+ROOTS = [
+    'GTS_Root_R1',
+    'GTS_Root_R2',
+    'GTS_Root_R3',
+    'GTS_Root_R4',
+    'GlobalSign_Root_CA',
+]
+OUTPUT_PATH = os.path.join(os.path.dirname(__file__), '..', 'src',
+                           'iss_ca_bundle.cpp')
+
+HEADER = """/*
+ * ISS CA Bundle
+ * =============
+ *
+ * Root certificates for the BFF (Google Trust Services), as DER.
+ * Generated by scripts/generate_ca_bundle.py; do not edit by hand.
+ */
+
+#include "iss_tls.h"
+
+"""
+
+PEM_PATTERN = re.compile(
+    r'-----BEGIN CERTIFICATE-----(.+?)-----END CERTIFICATE-----', re.S)
+
+
+def read_der(path):
+    """
+    Returns:
+        bytes: The first certificate of a PEM file, as DER
+    """
+    with open(path) as pem:
+        match = PEM_PATTERN.search(pem.read())
+    if not match:
+        raise ValueError(f'No certificate in {path}')
+    return base64.b64decode(''.join(match.group(1).split()))
+
+
+def c_array(name, der):
+    """
+    Returns:
+        str: A const byte array definition, 16 bytes per line
+    """
+    rows = []
+    for offset in range(0, len(der), 16):
+        chunk = der[offset:offset + 16]
+        rows.append('    ' + ', '.join(f'0x{b:02x}' for b in chunk) + ',')
+    return (f'static const uint8_t {name}[] = {{\n' + '\n'.join(rows) +
+            '\n};\n')
+
+
+def main():
+    certs_dir = sys.argv[1] if len(sys.argv) > 1 else DEFAULT_CERTS_DIR
+    arrays = []
+    entries = []
+    total = 0
+    for index, root in enumerate(ROOTS):
+        der = read_der(os.path.join(certs_dir, root + '.pem'))
+        arrays.append(c_array(f'root{index}', der))
+        entries.append(f'    {{"{root}", root{index}, sizeof(root{index})}},')
+        total += len(der)
+
+    with open(OUTPUT_PATH, 'w') as output:
+        output.write(HEADER)
+        output.write('\n'.join(arrays) + '\n')
+        output.write('const CaCertificate caBundle[] = {\n')
+        output.write('\n'.join(entries) + '\n')
+        output.write('};\n\n')
+        output.write('const size_t caBundleSize = '
+                     'sizeof(caBundle) / sizeof(caBundle[0]);\n')
+    print(f'Wrote {len(entries)} roots ({total} bytes) to '
+          f'{os.path.normpath(OUTPUT_PATH)}')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,95 @@
+"""
+Generates src/iss_tz_table.cpp, the IANA to POSIX timezone table.
+
+Reads the POSIX TZ rule from the footer of each compiled TZif file in the
+system zoneinfo database (tzdata 2018 or later) and writes the entries
+sorted by name, so the firmware can binary search them.
+
+Usage:
+    python3 scripts/generate_tz_table.py [zoneinfo_dir]
+"""
+
+import os
+import sys
+import zoneinfo
+
+DEFAULT_ZONEINFO_DIR = '/usr/share/zoneinfo'
+
+# Areas of the Area/Location names; US/, Canada/ and the like are legacy
+GEOGRAPHIC_AREAS = {
+    'Africa', 'America', 'Antarctica', 'Arctic', 'Asia', 'Atlantic',
+    'Australia', 'Europe', 'Indian', 'Pacific',
+}
+OUTPUT_PATH = os.path.join(os.path.dirname(__file__), '..', 'src',
+                           'iss_tz_table.cpp')
+
+HEADER = """/*
+ * ISS Timezone Table
+ * ==================
+ *
+ * IANA zone name -> POSIX TZ rule, sorted by name for binary search.
+ * Generated by scripts/generate_tz_table.py from tzdata {version};
+ * do not edit by hand.
+ */
+
+#include "iss_timezone.h"
+
+const TimezoneEntry timezoneTable[] = {{
+"""
+
+FOOTER = """}};
+
+const size_t timezoneTableSize = sizeof(timezoneTable) / sizeof(timezoneTable[0]);
+"""
+
+
+def read_posix_rule(path):
+    """
+    Reads the POSIX TZ footer from a TZif version 2+ file.
+
+    Returns:
+        str: The rule, or None if the file has no footer
+    """
+    with open(path, 'rb') as tzif:
+        data = tzif.read()
+    if not data.startswith(b'TZif') or data[4:5] < b'2':
+        return None
+    footer = data.rstrip(b'\n').rsplit(b'\n', 1)[-1]
+    return footer.decode('ascii') or None
+
+
+def read_version(zoneinfo_dir):
+    """
+    Returns:
+        str: The tzdata version, or 'unknown'
+    """
+    try:
+        with open(os.path.join(zoneinfo_dir, 'tzdata.zi')) as tzdata:
+            first = tzdata.readline().split()
+        return first[-1] if first and first[0] == '#' else 'unknown'
+    except OSError:
+        return 'unknown'
+
+
+def main():
+    zoneinfo_dir = sys.argv[1] if len(sys.argv) > 1 else DEFAULT_ZONEINFO_DIR
+    entries = []
+    for name in sorted(zoneinfo.available_timezones()):
+        # Only Area/Location names. Renamed zones such as Asia/Calcutta stay:
+        # IP geolocation databases still report some of the old names
+        if '/' not in name or name.split('/', 1)[0] not in GEOGRAPHIC_AREAS:
+            continue
+        rule = read_posix_rule(os.path.join(zoneinfo_dir, name))
+        if rule:
+            entries.append((name, rule))
+
+    lines = [f'    {{"{name}", "{rule}"}},' for name, rule in entries]
+    with open(OUTPUT_PATH, 'w') as output:
+        output.write(HEADER.format(version=read_version(zoneinfo_dir)))
+        output.write('\n'.join(lines) + '\n')
+        output.write(FOOTER.format())
+    print(f'Wrote {len(entries)} zones to {os.path.normpath(OUTPUT_PATH)}')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,299 @@
+"""
+Builds an OTA release of the firmware for the BFF to serve (see iss_ota.h).
+
+For the new image it writes a compressed full image and, for every image
+released before it, a compressed delta patch from that image, in the format
+iss_ota_patch.h decodes. Images are identified by the SHA-256 that esptool
+appends to them, which is what the device reports as its own id.
+
+The delta is a bsdiff-style diff: matches between the two images are found
+through a hash index of the old one and extended forwards and backwards
+while they mostly agree, so code that moved with only its addresses changed
+becomes runs of zero bytes that deflate to almost nothing.
+
+Release directory layout (mirrored to the firmware bucket):
+    latest.json              {"version", "image_id", "size", "patches"}
+    full.issd                The new image against no source
+    patches/<image_id>.issd  The new image against an earlier one
+    images/<image_id>.bin    Every released image, the sources of later patches
+
+Usage:
+    python3 scripts/make_ota_patch.py firmware.bin version release_dir
+"""
+
+import glob
+import hashlib
+import json
+import os
+import shutil
+import struct
+import sys
+import zlib
+
+PATCH_MAGIC = b'ISD1'
+IMAGE_ID_SIZE = 32
+HASH_APPENDED_OFFSET = 23   # esp_image_header_t.hash_appended
+GRAM_SIZE = 8               # Bytes indexed per position of the old image
+MAX_CANDIDATES = 8          # Positions kept per indexed gram
+COMPRESSION_LEVEL = 9
+
+
+def image_id(image):
+    """
+    Returns:
+        bytes: The id esp_partition_get_sha256() reports for the image
+    """
+    if len(image) > HASH_APPENDED_OFFSET and image[HASH_APPENDED_OFFSET] == 1:
+        return image[-IMAGE_ID_SIZE:]
+    return hashlib.sha256(image).digest()
+
+
+def varint(value):
+    """
+    Returns:
+        bytes: The value as an unsigned LEB128 varint
+    """
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def zigzag(value):
+    """
+    Returns:
+        int: A signed value mapped to an unsigned one, small magnitudes first
+    """
+    return (value << 1) ^ (value >> 63)
+
+
+def match_length(old, old_pos, new, new_pos):
+    """
+    Returns:
+        int: Length of the exact match of old from old_pos and new from new_pos
+    """
+    limit = min(len(old) - old_pos, len(new) - new_pos)
+    length = 0
+    step = 64
+    while length < limit:
+        count = min(step, limit - length)
+        if old[old_pos + length:old_pos + length + count] == \
+                new[new_pos + length:new_pos + length + count]:
+            length += count
+            continue
+        while old[old_pos + length] == new[new_pos + length]:
+            length += 1
+        break
+    return length
+
+
+class MatchIndex:
+    """Finds long exact matches in the old image by its 8-byte grams."""
+
+    def __init__(self, old):
+        self.old = old
+        self.positions = {}
+        for pos in range(len(old) - GRAM_SIZE + 1):
+            candidates = self.positions.setdefault(old[pos:pos + GRAM_SIZE], [])
+            if len(candidates) < MAX_CANDIDATES:
+                candidates.append(pos)
+
+    def search(self, new, scan):
+        """
+        Returns:
+            tuple: (length, position) of the longest match for new[scan:],
+                   or (0, 0) if none
+        """
+        best_length, best_pos = 0, 0
+        for pos in self.positions.get(new[scan:scan + GRAM_SIZE], ()):
+            length = match_length(self.old, pos, new, scan)
+            if length > best_length:
+                best_length, best_pos = length, pos
+        return best_length, best_pos
+
+
+def diff_records(old, new):
+    """
+    Splits the new image into bsdiff records against the old one
+
+    Returns:
+        list: (diff, extra, seek) tuples; diff is added to the old bytes at
+              the current source position, extra is copied as it is, seek
+              moves the source position for the next record
+    """
+    index = MatchIndex(old)
+    records = []
+    scan = length = pos = 0
+    last_scan = last_pos = last_offset = 0
+    old_size, new_size = len(old), len(new)
+
+    while scan < new_size:
+        old_score = 0
+        scan += length
+        score_scan = scan
+        while scan < new_size:
+            length, pos = index.search(new, scan)
+            while score_scan < scan + length:
+                if score_scan + last_offset < old_size and \
+                        old[score_scan + last_offset] == new[score_scan]:
+                    old_score += 1
+                score_scan += 1
+            # A new match, unless the current alignment does about as well
+            if (length == old_score and length != 0) or length > old_score + 8:
+                break
+            if scan + last_offset < old_size and old[scan + last_offset] == new[scan]:
+                old_score -= 1
+            scan += 1
+
+        if length == old_score and scan != new_size:
+            continue
+
+        # Extend the previous match forwards while it mostly agrees
+        matched = best = forward = i = 0
+        while last_scan + i < scan and last_pos + i < old_size:
+            if old[last_pos + i] == new[last_scan + i]:
+                matched += 1
+            i += 1
+            if matched * 2 - i > best * 2 - forward:
+                best, forward = matched, i
+
+        # And the new one backwards
+        backward = 0
+        if scan < new_size:
+            matched = best = 0
+            i = 1
+            while scan >= last_scan + i and pos >= i:
+                if old[pos - i] == new[scan - i]:
+                    matched += 1
+                if matched * 2 - i > best * 2 - backward:
+                    best, backward = matched, i
+                i += 1
+
+        # Split any overlap where the two extensions agree best
+        if last_scan + forward > scan - backward:
+            overlap = (last_scan + forward) - (scan - backward)
+            matched = best = split = 0
+            for i in range(overlap):
+                if new[last_scan + forward - overlap + i] == old[last_pos + forward - overlap + i]:
+                    matched += 1
+                if new[scan - backward + i] == old[pos - backward + i]:
+                    matched -= 1
+                if matched > best:
+                    best, split = matched, i + 1
+            forward += split - overlap
+            backward -= split
+
+        diff = bytes((new[last_scan + i] - old[last_pos + i]) & 0xFF for i in range(forward))
+        extra = new[last_scan + forward:scan - backward]
+        seek = (pos - backward) - (last_pos + forward)
+        records.append((diff, extra, seek))
+
+        last_scan = scan - backward
+        last_pos = pos - backward
+        last_offset = pos - scan
+
+    return records
+
+
+def encode_patch(source, target, records):
+    """
+    Returns:
+        bytes: The patch file: header, then the zlib-compressed records
+    """
+    stream = bytearray()
+    for diff, extra, seek in records:
+        stream += varint(len(diff)) + varint(len(extra)) + varint(zigzag(seek))
+        stream += diff + extra
+    source_id = image_id(source) if source else bytes(IMAGE_ID_SIZE)
+    header = PATCH_MAGIC + struct.pack('<II', len(source), len(target))
+    header += source_id + image_id(target)
+    return header + zlib.compress(bytes(stream), COMPRESSION_LEVEL)
+
+
+def apply_patch(source, patch):
+    """
+    Rebuilds the target image from a patch, to check the patch before release
+
+    Returns:
+        bytes: The target image
+    """
+    target_size = struct.unpack_from('<I', patch, 8)[0]
+    stream = zlib.decompress(patch[12 + 2 * IMAGE_ID_SIZE:])
+    target = bytearray()
+    read = source_pos = 0
+
+    def next_varint():
+        nonlocal read
+        value = shift = 0
+        while True:
+            byte = stream[read]
+            read += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                return value
+
+    while len(target) < target_size:
+        add, copy, seek = next_varint(), next_varint(), next_varint()
+        target += bytes((stream[read + i] + source[source_pos + i]) & 0xFF for i in range(add))
+        read += add
+        target += stream[read:read + copy]
+        read += copy
+        source_pos += add + ((seek >> 1) ^ -(seek & 1))
+    return bytes(target)
+
+
+def write_file(path, data):
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, 'wb') as out:
+        out.write(data)
+
+
+def main():
+    if len(sys.argv) != 4:
+        print(__doc__)
+        sys.exit(1)
+    image_path, version, release_dir = sys.argv[1:]
+    with open(image_path, 'rb') as image_file:
+        target = image_file.read()
+    target_id = image_id(target).hex()
+
+    full = encode_patch(b'', target, [(b'', target, 0)])
+    write_file(os.path.join(release_dir, 'full.issd'), full)
+    print(f'full image: {len(target)} bytes, {len(full)} compressed')
+
+    patches = {}
+    for source_path in sorted(glob.glob(os.path.join(release_dir, 'images', '*.bin'))):
+        with open(source_path, 'rb') as source_file:
+            source = source_file.read()
+        source_id = image_id(source).hex()
+        if source_id == target_id:
+            continue
+        patch = encode_patch(source, target, diff_records(source, target))
+        if apply_patch(source, patch) != target:
+            raise RuntimeError(f'Patch from {source_id} does not rebuild the image')
+        write_file(os.path.join(release_dir, 'patches', f'{source_id}.issd'), patch)
+        patches[source_id] = len(patch)
+        print(f'patch from {source_id[:16]}: {len(patch)} bytes')
+
+    os.makedirs(os.path.join(release_dir, 'images'), exist_ok=True)
+    shutil.copyfile(image_path, os.path.join(release_dir, 'images', f'{target_id}.bin'))
+    manifest = {
+        'version': version,
+        'image_id': target_id,
+        'size': len(target),
+        'patches': patches,
+    }
+    with open(os.path.join(release_dir, 'latest.json'), 'w') as out:
+        json.dump(manifest, out, indent=2)
+        out.write('\n')
+    print(f'{version} is image {target_id}')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,78 @@
+/*
+ * ISS Backlight
+ * =============
+ *
+ * Fades in perceived brightness. See iss_backlight.h.
+ */
+
+#include "iss_backlight.h"
+#include "iss_lcd.h"
+
+static const float perceptualGamma = 2.2f;
+
+// Duty <-> perceived level, both 0-255
+static uint8_t dutyForLevel[256];
+static uint8_t levelForDuty[256];
+
+static uint8_t target[3] = {0, 0, 0};       // Duty at the end of the fade
+static uint8_t fromLevel[3] = {0, 0, 0};    // Perceived level at the start
+static uint8_t currentLevel[3] = {0, 0, 0};
+static uint32_t fadeUs = 0;                 // 0 when no fade is running
+static uint32_t fadeElapsedUs = 0;
+static bool fadesStepped = false;           // backlightStep() runs every frame
+
+void backlightBegin(bool frameClock) {
+    fadesStepped = frameClock;
+    for (int i = 0; i < 256; i++) {
+        dutyForLevel[i] = (uint8_t)(powf(i / 255.0f, perceptualGamma) * 255.0f + 0.5f);
+        levelForDuty[i] = (uint8_t)(powf(i / 255.0f, 1.0f / perceptualGamma) * 255.0f + 0.5f);
+    }
+}
+
+/**
+ * Sends the target colour and ends the fade
+ */
+static void settle() {
+    lcdSetRGB(target[0], target[1], target[2]);
+    for (int i = 0; i < 3; i++) {
+        currentLevel[i] = levelForDuty[target[i]];
+    }
+    fadeUs = 0;
+}
+
+void backlightSet(uint8_t red, uint8_t green, uint8_t blue, unsigned long fadeMs) {
+    target[0] = red;
+    target[1] = green;
+    target[2] = blue;
+    if (fadeMs > 0 && fadesStepped) {
+        memcpy(fromLevel, currentLevel, sizeof(fromLevel));
+        fadeUs = fadeMs * 1000;
+        fadeElapsedUs = 0;
+        return;
+    }
+    settle();
+}
+
+void backlightStep(uint32_t elapsedUs) {
+    if (fadeUs == 0) {
+        return;
+    }
+    fadeElapsedUs += elapsedUs;
+    if (fadeElapsedUs >= fadeUs) {
+        settle();
+        return;
+    }
+
+    uint8_t duty[3];
+    float progress = (float)fadeElapsedUs / fadeUs;
+    for (int i = 0; i < 3; i++) {
+        int to = levelForDuty[target[i]];
+        currentLevel[i] = (uint8_t)(fromLevel[i] + (to - fromLevel[i]) * progress + 0.5f);
+        duty[i] = dutyForLevel[currentLevel[i]];
+    }
+    lcdSetRGB(duty[0], duty[1], duty[2]);
+}
+
+bool backlightFading() {
+    return fadeUs > 0;
+}
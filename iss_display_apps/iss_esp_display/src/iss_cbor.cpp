@@ -0,0 +1,296 @@
+/*
+ * ISS CBOR Reader
+ * ===============
+ *
+ * Streaming fixed-schema CBOR decoding. See iss_cbor.h.
+ */
+
+#include "iss_cbor.h"
+#include <math.h>
+
+// Nesting allowed when skipping unknown items
+static const int maxSkipDepth = 8;
+
+// Additional information values (low five bits of the initial byte)
+static const uint8_t argumentOneByte = 24;
+static const uint8_t argumentEightBytes = 27;
+
+// Simple values (major type 7)
+static const uint8_t simpleNull = 22;
+static const uint8_t floatHalf = 25;
+static const uint8_t floatSingle = 26;
+static const uint8_t floatDouble = 27;
+
+/**
+ * Converts an IEEE 754 half-precision value
+ */
+static float halfToFloat(uint16_t half) {
+    int exponent = (half >> 10) & 0x1F;
+    int mantissa = half & 0x3FF;
+    float value;
+    if (exponent == 0) {
+        value = ldexpf(mantissa, -24);                      // Subnormal
+    } else if (exponent == 31) {
+        value = mantissa == 0 ? INFINITY : NAN;
+    } else {
+        value = ldexpf(mantissa + 1024, exponent - 25);
+    }
+    return (half & 0x8000) ? -value : value;
+}
+
+CborReader::CborReader(Stream& input)
+    : input(input),
+      hasPending(false),
+      pendingMajor(0),
+      pendingInfo(0),
+      pendingArgument(0),
+      error(false) {
+}
+
+int CborReader::nextByte() {
+    int value = input.read();
+    if (value < 0) {
+        error = true;
+    }
+    return value;
+}
+
+bool CborReader::readBytes(uint8_t* buffer, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        int value = nextByte();
+        if (value < 0) {
+            return false;
+        }
+        buffer[i] = (uint8_t)value;
+    }
+    return true;
+}
+
+bool CborReader::discard(uint64_t length) {
+    for (uint64_t i = 0; i < length; i++) {
+        if (nextByte() < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Reads the next head (initial byte and argument), skipping tags
+ * Returns the head stored by peekType() first, if there is one.
+ * Indefinite lengths and reserved values set the error
+ */
+bool CborReader::readHead(uint8_t& major, uint8_t& info, uint64_t& argument) {
+    if (hasPending) {
+        hasPending = false;
+        major = pendingMajor;
+        info = pendingInfo;
+        argument = pendingArgument;
+        return true;
+    }
+    do {
+        int initial = nextByte();
+        if (initial < 0) {
+            return false;
+        }
+        major = initial >> 5;
+        info = initial & 0x1F;
+
+        if (info < argumentOneByte) {
+            argument = info;
+        } else if (info <= argumentEightBytes) {
+            uint8_t bytes[8];
+            size_t length = (size_t)1 << (info - argumentOneByte);
+            if (!readBytes(bytes, length)) {
+                return false;
+            }
+            argument = 0;
+            for (size_t i = 0; i < length; i++) {
+                argument = (argument << 8) | bytes[i];
+            }
+        } else {
+            error = true;  // Reserved values and indefinite lengths
+            return false;
+        }
+    } while (major == CBOR_TAG);
+    return true;
+}
+
+CborType CborReader::peekType() {
+    if (!hasPending) {
+        if (error || !readHead(pendingMajor, pendingInfo, pendingArgument)) {
+            return CBOR_END;
+        }
+        hasPending = true;
+    }
+    return (CborType)pendingMajor;
+}
+
+bool CborReader::readMap(size_t& count) {
+    if (peekType() != CBOR_MAP) {
+        skip();
+        return false;
+    }
+    uint8_t major, info;
+    uint64_t argument;
+    readHead(major, info, argument);
+    count = (size_t)argument;
+    return true;
+}
+
+bool CborReader::readArray(size_t& count) {
+    if (peekType() != CBOR_ARRAY) {
+        skip();
+        return false;
+    }
+    uint8_t major, info;
+    uint64_t argument;
+    readHead(major, info, argument);
+    count = (size_t)argument;
+    return true;
+}
+
+bool CborReader::readText(char* output, size_t outputSize) {
+    output[0] = '\0';
+    CborType type = peekType();
+    if (type == CBOR_SIMPLE && pendingInfo == simpleNull) {
+        skip();
+        return true;
+    }
+    if (type != CBOR_TEXT) {
+        skip();
+        return false;
+    }
+    uint8_t major, info;
+    uint64_t argument;
+    readHead(major, info, argument);
+
+    size_t kept = argument < outputSize - 1 ? (size_t)argument : outputSize - 1;
+    if (!readBytes((uint8_t*)output, kept) || !discard(argument - kept)) {
+        output[0] = '\0';
+        return false;
+    }
+    // Don't leave half a UTF-8 sequence at a truncation point
+    if (kept < argument) {
+        size_t start = kept;
+        while (start > 0 && ((uint8_t)output[start - 1] & 0xC0) == 0x80) {
+            start--;
+        }
+        if (start > 0 && ((uint8_t)output[start - 1] & 0x80)) {
+            uint8_t lead = output[start - 1];
+            size_t sequence = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : 2;
+            if (start - 1 + sequence > kept) {
+                kept = start - 1;
+            }
+        }
+    }
+    output[kept] = '\0';
+    return true;
+}
+
+bool CborReader::readByteString(uint8_t* output, size_t outputSize, size_t& length) {
+    length = 0;
+    if (peekType() != CBOR_BYTES) {
+        skip();
+        return false;
+    }
+    uint8_t major, info;
+    uint64_t argument;
+    readHead(major, info, argument);
+
+    if (argument > outputSize) {
+        discard(argument);
+        return false;
+    }
+    if (!readBytes(output, (size_t)argument)) {
+        return false;
+    }
+    length = (size_t)argument;
+    return true;
+}
+
+bool CborReader::readFloat(float& output) {
+    CborType type = peekType();
+    if (type == CBOR_TEXT) {
+        char text[24];
+        char* end = NULL;
+        if (!readText(text, sizeof(text))) {
+            return false;
+        }
+        output = strtof(text, &end);
+        return end != text;
+    }
+    bool isFloat = type == CBOR_SIMPLE &&
+                   (pendingInfo == floatHalf || pendingInfo == floatSingle || pendingInfo == floatDouble);
+    if (type != CBOR_UNSIGNED && type != CBOR_NEGATIVE && !isFloat) {
+        skip();
+        return false;
+    }
+
+    uint8_t major, info;
+    uint64_t argument;
+    readHead(major, info, argument);
+    if (major == CBOR_UNSIGNED) {
+        output = (float)argument;
+    } else if (major == CBOR_NEGATIVE) {
+        output = -1.0f - (float)argument;
+    } else if (info == floatHalf) {
+        // The argument holds the float bits, in the width given by info
+        output = halfToFloat((uint16_t)argument);
+    } else if (info == floatSingle) {
+        uint32_t bits = (uint32_t)argument;
+        memcpy(&output, &bits, sizeof(output));
+    } else {
+        double value;
+        memcpy(&value, &argument, sizeof(value));
+        output = (float)value;
+    }
+    return true;
+}
+
+bool CborReader::readInt(int64_t& output) {
+    CborType type = peekType();
+    if (type != CBOR_UNSIGNED && type != CBOR_NEGATIVE) {
+        skip();
+        return false;
+    }
+    uint8_t major, info;
+    uint64_t argument;
+    readHead(major, info, argument);
+    output = major == CBOR_UNSIGNED ? (int64_t)argument : -1 - (int64_t)argument;
+    return true;
+}
+
+bool CborReader::skipDepth(int depth) {
+    uint8_t major, info;
+    uint64_t argument;
+    if (depth > maxSkipDepth || !readHead(major, info, argument)) {
+        error = true;
+        return false;
+    }
+    switch (major) {
+        case CBOR_BYTES:
+        case CBOR_TEXT:
+            return discard(argument);
+        case CBOR_ARRAY:
+            for (uint64_t i = 0; i < argument; i++) {
+                if (!skipDepth(depth + 1)) {
+                    return false;
+                }
+            }
+            return true;
+        case CBOR_MAP:
+            for (uint64_t i = 0; i < argument * 2; i++) {
+                if (!skipDepth(depth + 1)) {
+                    return false;
+                }
+            }
+            return true;
+        default:
+            return true;  // Integers and simple values are all head
+    }
+}
+
+bool CborReader::skip() {
+    return skipDepth(0);
+}
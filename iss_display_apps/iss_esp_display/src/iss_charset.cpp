@@ -0,0 +1,165 @@
+/*
+ * ISS LCD Character Set
+ * =====================
+ *
+ * UTF-8 decoder and transliteration table. See iss_charset.h.
+ *
+ * HD44780 character codes 0x08-0x0F address the same eight CGRAM glyphs as
+ * 0x00-0x07, so the table uses the upper range and glyphs can live in
+ * ordinary null-terminated strings.
+ */
+
+#include "iss_charset.h"
+#include "iss_profile.h"
+
+// First CGRAM character code, see above
+#define GLYPH_BASE 0x08
+
+// Replacement text for one codepoint, at most three bytes
+struct Transliteration {
+    char text[4];
+};
+
+// First codepoint in the table
+static const uint16_t tableStart = 0x00A0;
+
+// U+00A0..U+017F: Latin-1 Supplement and Latin Extended-A.
+// \x08..\x0F are the CGRAM glyphs below, \xDF is the ROM's degree sign.
+static constexpr Transliteration latinTable[] = {
+    " ",    "!",    "c",    "L",    "$",    "Y",    "|",    "S",     // U+00A0
+    "\"",   "(c)",  "a",    "<<",   "-",    "",     "(R)",  "-",     // U+00A8
+    "\xDF", "+-",   "2",    "3",    "'",    "u",    "P",    ".",     // U+00B0
+    ",",    "1",    "o",    ">>",   "1/4",  "1/2",  "3/4",  "?",     // U+00B8
+    "A",    "A",    "A",    "A",    "A",    "A",    "AE",   "C",     // U+00C0
+    "E",    "E",    "E",    "E",    "I",    "I",    "I",    "I",     // U+00C8
+    "D",    "N",    "O",    "O",    "O",    "O",    "O",    "x",     // U+00D0
+    "O",    "U",    "U",    "U",    "U",    "Y",    "Th",   "ss",    // U+00D8
+    "a",    "a",    "a",    "\x0F", "\x0B", "a",    "ae",   "\x0D",  // U+00E0
+    "e",    "\x08", "e",    "e",    "i",    "i",    "i",    "i",     // U+00E8
+    "d",    "\x0C", "o",    "o",    "o",    "o",    "\x0A", "/",     // U+00F0
+    "\x0E", "u",    "u",    "u",    "\x09", "y",    "th",   "y",     // U+00F8
+    "A",    "a",    "A",    "a",    "A",    "a",    "C",    "c",     // U+0100
+    "C",    "c",    "C",    "c",    "C",    "c",    "D",    "d",     // U+0108
+    "D",    "d",    "E",    "e",    "E",    "e",    "E",    "e",     // U+0110
+    "E",    "e",    "E",    "e",    "G",    "g",    "G",    "g",     // U+0118
+    "G",    "g",    "G",    "g",    "H",    "h",    "H",    "h",     // U+0120
+    "I",    "i",    "I",    "i",    "I",    "i",    "I",    "i",     // U+0128
+    "I",    "i",    "IJ",   "ij",   "J",    "j",    "K",    "k",     // U+0130
+    "k",    "L",    "l",    "L",    "l",    "L",    "l",    "L",     // U+0138
+    "l",    "L",    "l",    "N",    "n",    "N",    "n",    "N",     // U+0140
+    "n",    "'n",   "N",    "n",    "O",    "o",    "O",    "o",     // U+0148
+    "O",    "o",    "OE",   "oe",   "R",    "r",    "R",    "r",     // U+0150
+    "R",    "r",    "S",    "s",    "S",    "s",    "S",    "s",     // U+0158
+    "S",    "s",    "T",    "t",    "T",    "t",    "T",    "t",     // U+0160
+    "U",    "u",    "U",    "u",    "U",    "u",    "U",    "u",     // U+0168
+    "U",    "u",    "U",    "u",    "W",    "w",    "Y",    "y",     // U+0170
+    "Y",    "Z",    "z",    "Z",    "z",    "Z",    "z",    "s",     // U+0178
+};
+
+static_assert(sizeof(latinTable) / sizeof(latinTable[0]) == 0x0180 - tableStart,
+              "latinTable must cover U+00A0..U+017F");
+
+// Custom glyphs, 5x8 pixels, in CGRAM order
+static const uint8_t glyphs[8][8] = {
+    {0x02, 0x04, 0x0E, 0x11, 0x1F, 0x10, 0x0E, 0x00},  // e acute
+    {0x0A, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0D, 0x00},  // u diaeresis
+    {0x0A, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E, 0x00},  // o diaeresis
+    {0x0A, 0x00, 0x0E, 0x01, 0x0F, 0x11, 0x0F, 0x00},  // a diaeresis
+    {0x0D, 0x12, 0x00, 0x16, 0x19, 0x11, 0x11, 0x00},  // n tilde
+    {0x00, 0x0E, 0x10, 0x10, 0x11, 0x0E, 0x04, 0x0C},  // c cedilla
+    {0x00, 0x01, 0x0E, 0x13, 0x15, 0x19, 0x0E, 0x10},  // o stroke
+    {0x0D, 0x12, 0x0E, 0x01, 0x0F, 0x11, 0x0F, 0x00},  // a tilde
+};
+
+void charsetLoadGlyphs(rgb_lcd& lcd) {
+    for (uint8_t slot = 0; slot < 8; slot++) {
+        uint8_t bitmap[8];  // createChar() takes a mutable array
+        memcpy(bitmap, glyphs[slot], sizeof(bitmap));
+        lcd.createChar(slot, bitmap);
+    }
+}
+
+/**
+ * Looks up the replacement for a codepoint outside ASCII
+ * @param codepoint Decoded codepoint (0x80 or above)
+ * @return Replacement text, possibly empty (e.g. soft hyphen)
+ */
+static const char* replacementFor(uint32_t codepoint) {
+    if (codepoint >= tableStart &&
+        codepoint < tableStart + sizeof(latinTable) / sizeof(latinTable[0])) {
+        return latinTable[codepoint - tableStart].text;
+    }
+    switch (codepoint) {
+        case 0x2010: case 0x2011: case 0x2012:
+        case 0x2013: case 0x2014: case 0x2212:
+            return "-";
+        case 0x2018: case 0x2019: case 0x201A: case 0x2032:
+            return "'";
+        case 0x201C: case 0x201D: case 0x201E: case 0x2033:
+            return "\"";
+        case 0x2022:
+            return "*";
+        case 0x2026:
+            return "...";
+        case 0x2009: case 0x200A: case 0x202F:
+            return " ";
+        case 0x200B: case 0xFEFF:
+            return "";  // Zero-width space, byte order mark
+    }
+    return "?";
+}
+
+size_t charsetTransliterate(const char* input, char* output, size_t outputSize) {
+    PROFILE_SCOPE(PROFILE_TRANSLITERATE);
+    if (outputSize == 0) {
+        return 0;
+    }
+
+    const uint8_t* in = (const uint8_t*)input;
+    size_t length = 0;
+    while (*in != '\0') {
+        uint8_t lead = *in++;
+        char ascii[2] = {(char)lead, '\0'};
+        const char* text = ascii;
+
+        if (lead < 0x20) {
+            ascii[0] = ' ';  // Control codes would select CGRAM glyphs
+        } else if (lead >= 0x80) {
+            // Sequence length and payload bits of the lead byte
+            int continuation;
+            uint32_t codepoint;
+            if ((lead & 0xE0) == 0xC0) {
+                continuation = 1;
+                codepoint = lead & 0x1F;
+            } else if ((lead & 0xF0) == 0xE0) {
+                continuation = 2;
+                codepoint = lead & 0x0F;
+            } else if ((lead & 0xF8) == 0xF0) {
+                continuation = 3;
+                codepoint = lead & 0x07;
+            } else {
+                continuation = -1;  // Stray continuation or invalid lead byte
+                codepoint = 0;
+            }
+
+            for (int i = 0; i < continuation; i++) {
+                if ((*in & 0xC0) != 0x80) {
+                    continuation = -1;  // Truncated; resync on this byte
+                    break;
+                }
+                codepoint = (codepoint << 6) | (*in++ & 0x3F);
+            }
+            text = continuation < 0 ? "?" : replacementFor(codepoint);
+        }
+
+        size_t textLength = strlen(text);
+        if (length + textLength >= outputSize) {
+            break;
+        }
+        memcpy(output + length, text, textLength);
+        length += textLength;
+    }
+
+    output[length] = '\0';
+    return length;
+}
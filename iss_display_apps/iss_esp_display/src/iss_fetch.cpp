@@ -0,0 +1,474 @@
+/*
+ * ISS BFF Fetch
+ * =============
+ *
+ * Step-driven HTTPS client for the iss-api-bff-esp endpoint.
+ * See iss_fetch.h for the public interface.
+ *
+ * Each call to fetchStep() performs at most one bounded piece of work and
+ * returns. Waiting for the server (headers and the start of the body) only
+ * ever checks what has already arrived, and the pause between retries is
+ * timed with millis() instead of delay(), so the display keeps scrolling
+ * throughout a request. The one exception is the parse step: the decoders
+ * read the body straight from the connection and wait for the rest of it,
+ * for at most parseTimeout.
+ */
+
+#include "iss_fetch.h"
+#include "iss_tls.h"
+#include "iss_http.h"
+#include "iss_http_body.h"
+#include "iss_metrics.h"
+#include "iss_profile.h"
+
+// Request limits
+static const unsigned long attemptTimeout = 10000;  // 10 second timeout per attempt
+static const unsigned long retryDelay = 1000;       // Wait a second before retrying
+static const int maxAttempts = 3;                   // Try up to 3 times
+static const size_t maxReadPerStep = 256;           // Bytes consumed per step
+static const unsigned long parseTimeout = 1000;     // Rest of the body once it starts
+
+// Negative status codes for attempts that never received an HTTP status
+static const int ERROR_RESOLVE = -1;
+static const int ERROR_CONNECT = -2;
+static const int ERROR_SEND = -3;
+static const int ERROR_TIMEOUT = -4;
+static const int ERROR_CONNECTION_LOST = -5;
+
+// Connection and attempt state
+static IssTlsClient client;
+static ConnectionStats stats = {0, 0, 0};
+static bool reusingConnection = false;  // Current attempt uses a kept-alive connection
+static FetchState state = FETCH_IDLE;
+static int attempt = 0;
+static int lastStatus = 0;
+static unsigned long attemptStart = 0;
+static unsigned long retryStart = 0;
+static uint32_t phaseStart = 0;            // micros() at the start of the timed phase
+static bool awaitingFirstByte = false;     // Request sent, nothing received yet
+
+// Response parsing state
+static HttpResponseHead head;
+static bool serverCloses = false;       // Response carried "Connection: close"
+static bool cborBody = false;           // Content-Type: application/cbor
+static long pollHint = -1;              // max-age or Retry-After in seconds
+static char responseEtag[64];           // Validators of the current response,
+static char responseLastModified[40];   // kept only once its body parses
+
+// Validators of the last good response, sent back as conditions
+static char etag[64] = "";
+static char lastModified[40] = "";
+
+// Response body, decoded straight from the connection while parsing
+static HttpBodyStream body;
+
+// Last good result, and the buffer the next body is decoded into. They swap
+// when a body parses, so a truncated or unparseable body never touches what
+// the display is playing back
+static ISSData results[2];
+static ISSData* result = &results[0];
+static ISSData* decoding = &results[1];
+static bool resultChanged = false;       // The last FETCH_DONE swapped in a new result
+
+static void processHeaderLine(const char* line);
+
+/**
+ * Clears all per-attempt response state
+ */
+static void resetResponse() {
+    head.begin(processHeaderLine);
+    serverCloses = false;
+    cborBody = false;
+    pollHint = -1;
+    responseEtag[0] = '\0';
+    responseLastModified[0] = '\0';
+}
+
+/**
+ * Starts the next attempt
+ * Goes straight to the request when the previous connection is still open
+ */
+static void startAttempt() {
+    attempt++;
+    attemptStart = millis();
+    resetResponse();
+
+    reusingConnection = client.isReusable();
+    if (reusingConnection) {
+        stats.reusedConnections++;
+        state = FETCH_REQUEST;
+    } else {
+        client.stop();
+        state = FETCH_RESOLVE;
+    }
+}
+
+/**
+ * Ends the current attempt and schedules a retry or gives up
+ * @param status HTTP status or negative error code of the failed attempt
+ */
+static void failAttempt(int status) {
+    client.stop();
+
+    // A kept-alive connection can be closed by the server just as we reuse
+    // it; that is not a real failure, so reconnect without using up an attempt
+    if (reusingConnection && !head.started()) {
+        Serial.println("Keep-alive connection was closed, reconnecting");
+        stats.reusedConnections--;
+        attempt--;
+        startAttempt();
+        return;
+    }
+
+    lastStatus = status;
+
+    Serial.printf("Attempt %d failed with code: %d\n", attempt, status);
+    if (status == 411) {
+        Serial.println("411 Length Required error - check headers");
+    }
+
+    if (attempt < maxAttempts) {
+        retryStart = millis();
+        state = FETCH_RETRY_WAIT;
+    } else {
+        Serial.printf("Error in HTTP request after %d attempts\n", attempt);
+        state = FETCH_FAILED;
+    }
+}
+
+/**
+ * Handles one header line that iss_http does not
+ * @param line The line without the trailing CRLF
+ */
+static void processHeaderLine(const char* line) {
+    const char* value = httpHeaderValue(line, "Connection");
+    if (value && strncasecmp(value, "close", 5) == 0) {
+        serverCloses = true;
+        return;
+    }
+
+    value = httpHeaderValue(line, "Content-Type");
+    if (value) {
+        cborBody = strncasecmp(value, "application/cbor", 16) == 0;
+        return;
+    }
+
+    value = httpHeaderValue(line, "ETag");
+    if (value) {
+        strlcpy(responseEtag, value, sizeof(responseEtag));
+        return;
+    }
+
+    value = httpHeaderValue(line, "Last-Modified");
+    if (value) {
+        strlcpy(responseLastModified, value, sizeof(responseLastModified));
+        return;
+    }
+
+    value = httpHeaderValue(line, "Cache-Control");
+    if (value) {
+        const char* maxAge = strstr(value, "max-age=");
+        if (maxAge) {
+            pollHint = atol(maxAge + 8);
+        }
+        return;
+    }
+
+    // Only the delay-seconds form; an HTTP date is ignored
+    value = httpHeaderValue(line, "Retry-After");
+    if (value && isdigit((unsigned char)*value)) {
+        pollHint = atol(value);
+    }
+}
+
+/**
+ * Finishes a request answered with 304 Not Modified
+ * The response has no body, so the connection is ready for the next request
+ */
+static void finishUnchanged() {
+    if (serverCloses) {
+        client.stop();
+    }
+    if (responseEtag[0] != '\0') {
+        strlcpy(etag, responseEtag, sizeof(etag));
+    }
+    if (responseLastModified[0] != '\0') {
+        strlcpy(lastModified, responseLastModified, sizeof(lastModified));
+    }
+    Serial.println("ISS data not modified");
+    state = FETCH_UNCHANGED;
+}
+
+/**
+ * Resolves the BFF host name and starts the TCP connection
+ */
+static void stepResolve() {
+    HttpConnectResult ret = httpBeginConnect(client, bffHost);
+    if (ret != HTTP_CONNECTING) {
+        failAttempt(ret == HTTP_RESOLVE_FAILED ? ERROR_RESOLVE : ERROR_CONNECT);
+        return;
+    }
+    state = FETCH_CONNECT;
+}
+
+/**
+ * Waits for the TCP connection to complete
+ */
+static void stepConnect() {
+    int ret = client.pollConnect();
+    if (ret < 0) {
+        failAttempt(ERROR_CONNECT);
+    } else if (ret > 0) {
+        phaseStart = micros();
+        state = FETCH_TLS;
+    }
+}
+
+/**
+ * Advances the TLS handshake, resuming the cached session when possible
+ */
+static void stepTls() {
+    int ret = client.pollHandshake();
+    if (ret < 0) {
+        failAttempt(ERROR_CONNECT);
+        return;
+    }
+    if (ret == 0) {
+        return;
+    }
+
+    metricsRecord(METRIC_TLS_HANDSHAKE, micros() - phaseStart);
+    if (client.lastHandshakeResumed()) {
+        stats.resumedHandshakes++;
+    } else {
+        stats.fullHandshakes++;
+    }
+    state = FETCH_REQUEST;
+}
+
+/**
+ * Sends the GET request in a single write
+ * Includes the validators of the last good response, if any
+ */
+static void stepRequest() {
+    char headers[256];
+    int headersLength = snprintf(headers, sizeof(headers),
+        "Content-Length: 0\r\n"   // Avoids 411 Length Required
+        "Connection: keep-alive\r\n"
+        "Accept: application/cbor, application/json;q=0.5\r\n");
+    if (etag[0] != '\0') {
+        headersLength += snprintf(headers + headersLength, sizeof(headers) - headersLength,
+                                  "If-None-Match: %s\r\n", etag);
+    }
+    if (lastModified[0] != '\0' && headersLength < (int)sizeof(headers)) {
+        snprintf(headers + headersLength, sizeof(headers) - headersLength,
+                 "If-Modified-Since: %s\r\n", lastModified);
+    }
+
+    char query[48];
+    snprintf(query, sizeof(query), "batch=%d&history=%d", FETCH_BATCH_SIZE, HISTORY_MINUTES);
+    if (!httpSendGet(client, bffHost, query, headers)) {
+        failAttempt(ERROR_SEND);
+        return;
+    }
+    phaseStart = micros();
+    awaitingFirstByte = true;
+    state = FETCH_HEADERS;
+}
+
+/**
+ * Reads whatever part of the response head has arrived
+ */
+static void stepHeaders() {
+    if (awaitingFirstByte && client.available()) {
+        metricsRecord(METRIC_TTFB, micros() - phaseStart);
+        awaitingFirstByte = false;
+    }
+    if (head.read(client, maxReadPerStep)) {
+        lastStatus = head.status();
+        if (lastStatus == 304) {
+            finishUnchanged();
+        } else if (lastStatus != 200) {
+            failAttempt(lastStatus);
+        } else {
+            state = FETCH_BODY;
+        }
+        return;
+    }
+
+    if (!client.available() && !client.connected()) {
+        failAttempt(head.started() ? head.status() : ERROR_CONNECTION_LOST);
+    }
+}
+
+/**
+ * Waits, without blocking, for the body to start arriving
+ * Once it has, the parse step reads the rest straight from the connection.
+ * The rest of a body this size follows in a few tens of milliseconds, so
+ * the parse gets a short deadline of its own, not what is left of the
+ * attempt's
+ */
+static void stepBody() {
+    if (head.contentLength() != 0 && !client.available()) {
+        if (!client.connected()) {
+            failAttempt(ERROR_CONNECTION_LOST);
+        }
+        return;
+    }
+    body.begin(client, head.contentLength(), head.chunked(), millis() + parseTimeout);
+    state = FETCH_PARSE;
+}
+
+/**
+ * Parses the body in the format the server chose, directly from the connection
+ * Blocks the network task until the body is read or parseTimeout has passed
+ */
+static void stepParse() {
+    unsigned long parseStart = micros();
+    bool parsed;
+    {
+        PROFILE_SCOPE(PROFILE_PARSE);
+        parsed = cborBody ? payloadParseCbor(body, *decoding) : payloadParseJson(body, *decoding);
+    }
+    unsigned long parseTime = micros() - parseStart;
+    metricsSampleHeap();  // Document and TLS buffers in use: the low point
+
+    if (body.failed()) {
+        // Timed out or lost the connection part way through the body
+        failAttempt(client.connected() ? ERROR_TIMEOUT : ERROR_CONNECTION_LOST);
+        return;
+    }
+
+    // Keep the connection for the next poll unless the server is closing it
+    // or the rest of the body cannot be skipped cleanly
+    if (!body.drain() || serverCloses || (head.contentLength() < 0 && !head.chunked())) {
+        client.stop();
+    }
+
+    resultChanged = parsed;
+    if (parsed) {
+        decoding->valid = true;
+        ISSData* previous = result;
+        result = decoding;
+        decoding = previous;
+        metricsRecord(METRIC_PARSE, parseTime);
+        strlcpy(etag, responseEtag, sizeof(etag));
+        strlcpy(lastModified, responseLastModified, sizeof(lastModified));
+        Serial.printf("Read and parsed %u byte %s body in %lu us, %d upcoming (free heap %u)\n",
+                      (unsigned)body.consumed(), cborBody ? "CBOR" : "JSON", parseTime,
+                      result->upcomingCount, (unsigned)ESP.getFreeHeap());
+    }
+
+    Serial.printf("TLS: %u full, %u resumed, %u reused (%u handshakes avoided)\n",
+                  (unsigned)stats.fullHandshakes, (unsigned)stats.resumedHandshakes,
+                  (unsigned)stats.reusedConnections, (unsigned)fetchHandshakesAvoided());
+    state = FETCH_DONE;
+}
+
+void fetchBegin() {
+    if (fetchInProgress()) {
+        return;
+    }
+    Serial.printf("Connecting to: https://%s%s\n", bffHost, bffPath);  // Never log the key
+    attempt = 0;
+    lastStatus = 0;
+    resultChanged = false;
+    startAttempt();
+}
+
+FetchState fetchStep() {
+    PROFILE_SCOPE(PROFILE_FETCH_STEP);
+    // Abandon the attempt once it has used up its time budget
+    if (state >= FETCH_RESOLVE && state <= FETCH_BODY &&
+        millis() - attemptStart >= attemptTimeout) {
+        failAttempt(ERROR_TIMEOUT);
+    }
+
+    switch (state) {
+        case FETCH_RESOLVE:
+            stepResolve();
+            break;
+        case FETCH_CONNECT:
+            stepConnect();
+            break;
+        case FETCH_TLS:
+            stepTls();
+            break;
+        case FETCH_REQUEST:
+            stepRequest();
+            break;
+        case FETCH_HEADERS:
+            stepHeaders();
+            break;
+        case FETCH_BODY:
+            stepBody();
+            break;
+        case FETCH_PARSE:
+            stepParse();
+            break;
+        case FETCH_RETRY_WAIT:
+            if (millis() - retryStart >= retryDelay) {
+                startAttempt();
+            }
+            break;
+        default:
+            break;
+    }
+
+    // Report completion once, then go back to idle
+    FetchState reported = state;
+    if (state == FETCH_DONE || state == FETCH_UNCHANGED || state == FETCH_FAILED) {
+        state = FETCH_IDLE;
+    }
+    return reported;
+}
+
+bool fetchInProgress() {
+    return state != FETCH_IDLE;
+}
+
+const ISSData& fetchResult() {
+    return *result;
+}
+
+bool fetchResultChanged() {
+    return resultChanged;
+}
+
+int fetchLastStatus() {
+    return lastStatus;
+}
+
+long fetchPollHint() {
+    return pollHint;
+}
+
+int fetchAttempts() {
+    return attempt;
+}
+
+const ConnectionStats& fetchConnectionStats() {
+    return stats;
+}
+
+uint32_t fetchHandshakesAvoided() {
+    return stats.resumedHandshakes + stats.reusedConnections;
+}
+
+const char* fetchStateName(FetchState state) {
+    switch (state) {
+        case FETCH_IDLE:       return "idle";
+        case FETCH_RESOLVE:    return "resolve";
+        case FETCH_CONNECT:    return "connect";
+        case FETCH_TLS:        return "tls";
+        case FETCH_REQUEST:    return "request";
+        case FETCH_HEADERS:    return "headers";
+        case FETCH_BODY:       return "body";
+        case FETCH_PARSE:      return "parse";
+        case FETCH_RETRY_WAIT: return "retry-wait";
+        case FETCH_DONE:       return "done";
+        case FETCH_UNCHANGED:  return "unchanged";
+        case FETCH_FAILED:     return "failed";
+    }
+    return "unknown";
+}
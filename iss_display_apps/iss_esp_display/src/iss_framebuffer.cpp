@@ -0,0 +1,100 @@
+/*
+ * ISS LCD Framebuffer
+ * ===================
+ *
+ * Diffing renderer for the 16x2 LCD. See iss_framebuffer.h.
+ *
+ * Each run of changed cells is one I2C transaction (lcdWrite()), and the
+ * controller advances its address counter after each character, so a run
+ * that starts where the previous one ended needs no address command.
+ */
+
+#include "iss_framebuffer.h"
+#include "iss_profile.h"
+
+// Runs separated by this many unchanged cells or fewer are sent as one;
+// rewriting a cell is one byte, a new run costs four (device address,
+// address command and control byte) plus its start and stop
+static const int mergeGap = 4;
+
+static bool begun = false;
+static char frame[LCD_ROWS][LCD_COLUMNS];    // Next frame
+static char shown[LCD_ROWS][LCD_COLUMNS];    // What the panel shows
+static bool shownValid = false;              // False forces a full rewrite
+static FramebufferStats stats = {0, 0, 0};
+
+void framebufferBegin() {
+    begun = true;
+    lcdClear();
+    memset(frame, ' ', sizeof(frame));
+    memset(shown, ' ', sizeof(shown));
+    shownValid = true;
+}
+
+void framebufferSetRow(int row, const char* text, int length) {
+    if (row < 0 || row >= LCD_ROWS) {
+        return;
+    }
+    int count = constrain(length, 0, LCD_COLUMNS);
+    memcpy(frame[row], text, count);
+    memset(frame[row] + count, ' ', LCD_COLUMNS - count);
+}
+
+/**
+ * Writes a run of cells from the frame to the panel
+ */
+static void sendRun(int row, int start, int end) {
+    lcdWrite(row, start, &frame[row][start], end - start);
+    memcpy(&shown[row][start], &frame[row][start], end - start);
+    stats.cellsWritten += end - start;
+}
+
+void framebufferFlush() {
+    if (!begun) {
+        return;
+    }
+    PROFILE_SCOPE(PROFILE_LCD_WRITE);
+    stats.frames++;
+    uint32_t writtenBefore = stats.cellsWritten;
+
+    for (int row = 0; row < LCD_ROWS; row++) {
+        int runStart = -1;
+        int runEnd = -1;
+
+        for (int column = 0; column < LCD_COLUMNS; column++) {
+            if (shownValid && frame[row][column] == shown[row][column]) {
+                continue;
+            }
+            if (runStart >= 0 && column - runEnd > mergeGap) {
+                sendRun(row, runStart, runEnd);
+                runStart = -1;
+            }
+            if (runStart < 0) {
+                runStart = column;
+            }
+            runEnd = column + 1;
+        }
+        if (runStart >= 0) {
+            sendRun(row, runStart, runEnd);
+        }
+    }
+
+    // Cells written include merged unchanged ones; count the rest as skipped
+    shownValid = true;
+    stats.cellsSkipped += LCD_ROWS * LCD_COLUMNS - (stats.cellsWritten - writtenBefore);
+}
+
+void framebufferInvalidate() {
+    shownValid = false;
+}
+
+const FramebufferStats& framebufferStats() {
+    return stats;
+}
+
+void framebufferLogStats() {
+    Serial.printf("Display: %u frames, %u cells sent, %u skipped\n",
+                  (unsigned)stats.frames, (unsigned)stats.cellsWritten,
+                  (unsigned)stats.cellsSkipped);
+    lcdLogStats();
+}
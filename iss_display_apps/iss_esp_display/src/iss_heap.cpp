@@ -0,0 +1,36 @@
+/*
+ * ISS Heap Statistics
+ * ===================
+ *
+ * See iss_heap.h.
+ */
+
+#include "iss_heap.h"
+
+static HeapStats stats = {0, 0, 0, 0, 0, 0};
+
+void heapStatsSample() {
+    stats.freeBytes = ESP.getFreeHeap();
+    stats.largestFreeBlock = ESP.getMaxAllocHeap();
+    stats.minFreeBytes = ESP.getMinFreeHeap();
+
+    stats.fragmentation = 0;
+    if (stats.freeBytes > 0 && stats.largestFreeBlock < stats.freeBytes) {
+        stats.fragmentation = 100 - (uint8_t)((uint64_t)stats.largestFreeBlock * 100 / stats.freeBytes);
+    }
+    if (stats.fragmentation > stats.peakFragmentation) {
+        stats.peakFragmentation = stats.fragmentation;
+    }
+    stats.samples++;
+}
+
+const HeapStats& heapStats() {
+    return stats;
+}
+
+void heapStatsLog() {
+    Serial.printf("Heap: %u free, %u largest block, %u min free, %u%% fragmented (peak %u%%)\n",
+                  (unsigned)stats.freeBytes, (unsigned)stats.largestFreeBlock,
+                  (unsigned)stats.minFreeBytes, (unsigned)stats.fragmentation,
+                  (unsigned)stats.peakFragmentation);
+}
@@ -0,0 +1,168 @@
+/*
+ * ISS Ground Track
+ * ================
+ *
+ * Delta/varint track decoding and motion estimates. See iss_history.h.
+ */
+
+#include "iss_history.h"
+#include <math.h>
+
+static const uint8_t formatVersion = 1;
+static const int32_t fullTurn = 360 * HISTORY_SCALE;
+static const float earthRadiusKm = 6371.0f;
+
+/**
+ * Reads an unsigned LEB128 varint of up to 32 bits
+ */
+static bool readVarint(const uint8_t*& cursor, const uint8_t* end, uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 32; shift += 7) {
+        if (cursor == end) {
+            return false;
+        }
+        uint8_t byte = *cursor++;
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Reads a zigzag-encoded signed varint
+ */
+static bool readSigned(const uint8_t*& cursor, const uint8_t* end, int32_t& value) {
+    uint32_t raw;
+    if (!readVarint(cursor, end, raw)) {
+        return false;
+    }
+    value = (int32_t)(raw >> 1) ^ -(int32_t)(raw & 1);
+    return true;
+}
+
+bool historyDecode(const uint8_t* data, size_t length, GroundTrack& track) {
+    track.count = 0;
+    const uint8_t* cursor = data;
+    const uint8_t* end = data + length;
+    uint32_t count, step, start;
+    if (length == 0 || *cursor++ != formatVersion ||
+        !readVarint(cursor, end, count) || !readVarint(cursor, end, step) ||
+        !readVarint(cursor, end, start) || step == 0 || step > UINT16_MAX) {
+        return false;
+    }
+
+    // A longer track keeps its newest points
+    uint32_t dropped = count > HISTORY_CAPACITY ? count - HISTORY_CAPACITY : 0;
+    int32_t latitude = 0;
+    int32_t longitude = 0;
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t gap;
+        int32_t deltaLatitude, deltaLongitude;
+        if (!readVarint(cursor, end, gap) || !readSigned(cursor, end, deltaLatitude) ||
+            !readSigned(cursor, end, deltaLongitude)) {
+            track.count = 0;
+            return false;
+        }
+        offset += gap;
+        latitude += deltaLatitude;
+        longitude += deltaLongitude;
+        if (longitude >= fullTurn / 2) {
+            longitude -= fullTurn;
+        } else if (longitude < -fullTurn / 2) {
+            longitude += fullTurn;
+        }
+        if (abs(latitude) > 90 * HISTORY_SCALE || offset > UINT16_MAX) {
+            track.count = 0;
+            return false;
+        }
+        if (i < dropped) {
+            continue;
+        }
+        track.offset[track.count] = offset;
+        track.latitude[track.count] = latitude;
+        track.longitude[track.count] = longitude;
+        track.count++;
+    }
+    track.start = start;
+    track.step = step;
+    return true;
+}
+
+/**
+ * @return The 6-bit value of a base64 character, -1 for any other
+ */
+static int base64Value(char c) {
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A';
+    }
+    if (c >= 'a' && c <= 'z') {
+        return c - 'a' + 26;
+    }
+    if (c >= '0' && c <= '9') {
+        return c - '0' + 52;
+    }
+    return c == '+' ? 62 : c == '/' ? 63 : -1;
+}
+
+size_t historyDecodeBase64(const char* text, uint8_t* output, size_t outputSize) {
+    size_t written = 0;
+    uint32_t bits = 0;
+    int bitCount = 0;
+    for (const char* c = text; *c != '\0' && *c != '='; c++) {
+        int value = base64Value(*c);
+        if (value < 0) {
+            return 0;
+        }
+        bits = (bits << 6) | value;
+        bitCount += 6;
+        if (bitCount >= 8) {
+            bitCount -= 8;
+            if (written == outputSize) {
+                return 0;
+            }
+            output[written++] = (uint8_t)(bits >> bitCount);
+        }
+    }
+    return written;
+}
+
+bool historyMotion(const GroundTrack& track, float& speedKmh, float& headingDeg) {
+    if (track.count < 2) {
+        return false;
+    }
+    int last = track.count - 1;
+    float seconds = (float)(track.offset[last] - track.offset[last - 1]) * track.step;
+    if (seconds <= 0) {
+        return false;
+    }
+
+    const float toRadians = (float)M_PI / 180.0f / HISTORY_SCALE;
+    float lat1 = track.latitude[last - 1] * toRadians;
+    float lat2 = track.latitude[last] * toRadians;
+    int32_t lonSteps = track.longitude[last] - track.longitude[last - 1];
+    if (lonSteps >= fullTurn / 2) {
+        lonSteps -= fullTurn;  // Crossed the antimeridian
+    } else if (lonSteps < -fullTurn / 2) {
+        lonSteps += fullTurn;
+    }
+    float deltaLon = lonSteps * toRadians;
+
+    // Haversine distance and initial bearing
+    float a = sinf((lat2 - lat1) / 2) * sinf((lat2 - lat1) / 2) +
+              cosf(lat1) * cosf(lat2) * sinf(deltaLon / 2) * sinf(deltaLon / 2);
+    float distanceKm = 2 * earthRadiusKm * atan2f(sqrtf(a), sqrtf(1 - a));
+    speedKmh = distanceKm / seconds * 3600.0f;
+
+    float y = sinf(deltaLon) * cosf(lat2);
+    float x = cosf(lat1) * sinf(lat2) - sinf(lat1) * cosf(lat2) * cosf(deltaLon);
+    headingDeg = fmodf(atan2f(y, x) * 180.0f / (float)M_PI + 360.0f, 360.0f);
+    return true;
+}
+
+const char* historyCompass(float headingDeg) {
+    static const char* names[] = {"N", "NE", "E", "SE", "S", "SW", "W", "NW"};
+    return names[(int)((headingDeg + 22.5f) / 45.0f) % 8];
+}
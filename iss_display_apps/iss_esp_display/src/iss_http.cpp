@@ -0,0 +1,128 @@
+/*
+ * ISS HTTP
+ * ========
+ *
+ * Shared endpoint, request and response head handling of the BFF clients.
+ * See iss_http.h.
+ */
+
+#include "iss_http.h"
+#include <WiFi.h>
+#include "iss_metrics.h"
+#include "secrets.h"
+
+const char* const bffHost = "iss-api-bff-esp-768423610307.us-east1.run.app";
+const char* const bffStreamHost = "iss-api-bff-esp-stream-768423610307.us-east1.run.app";
+const char* const bffPath = "/";
+const uint16_t bffPort = 443;
+static const char* apiKey = API_KEY;
+
+HttpConnectResult httpBeginConnect(IssTlsClient& client, const char* host) {
+    IPAddress address;
+    uint32_t start = micros();
+    if (WiFi.hostByName(host, address) != 1) {
+        return HTTP_RESOLVE_FAILED;
+    }
+    metricsRecord(METRIC_DNS, micros() - start);
+    if (!client.beginConnect(address, bffPort, host)) {
+        return HTTP_CONNECT_FAILED;
+    }
+    return HTTP_CONNECTING;
+}
+
+bool httpSendGet(IssTlsClient& client, const char* host, const char* query, const char* headers) {
+    char request[512];
+    int length = snprintf(request, sizeof(request),
+        "GET %s?api_key=%s&%s HTTP/1.1\r\n"
+        "Host: %s\r\n"
+        "User-Agent: ESP32HTTPClient\r\n"
+        "%s"
+        "\r\n",
+        bffPath, apiKey, query, host, headers);
+
+    return length > 0 && length < (int)sizeof(request) &&
+           client.write((const uint8_t*)request, length) == (size_t)length;
+}
+
+const char* httpHeaderValue(const char* line, const char* name) {
+    size_t nameLength = strlen(name);
+    if (strncasecmp(line, name, nameLength) != 0 || line[nameLength] != ':') {
+        return NULL;
+    }
+    const char* value = line + nameLength + 1;
+    while (*value == ' ') {
+        value++;
+    }
+    return value;
+}
+
+bool HttpLineBuffer::add(char c) {
+    if (c == '\n') {
+        buffer[length] = '\0';
+        length = 0;
+        return true;
+    }
+    if (c != '\r' && length < sizeof(buffer) - 1) {
+        buffer[length++] = c;
+    }
+    return false;
+}
+
+HttpResponseHead::HttpResponseHead()
+    : handler(NULL), statusRead(false), statusCode(0), length(-1), isChunked(false) {}
+
+void HttpResponseHead::begin(HeaderHandler handler) {
+    this->handler = handler;
+    line.reset();
+    statusRead = false;
+    statusCode = 0;
+    length = -1;
+    isChunked = false;
+}
+
+/**
+ * Handles one complete line of the head other than the blank one ending it
+ */
+void HttpResponseHead::processLine(const char* text) {
+    if (!statusRead) {
+        // Status line, e.g. "HTTP/1.1 200 OK"
+        if (sscanf(text, "HTTP/%*d.%*d %d", &statusCode) != 1) {
+            statusCode = 0;
+        }
+        statusRead = true;
+        return;
+    }
+
+    const char* value = httpHeaderValue(text, "Content-Length");
+    if (value) {
+        length = atol(value);
+        return;
+    }
+    value = httpHeaderValue(text, "Transfer-Encoding");
+    if (value && strncasecmp(value, "chunked", 7) == 0) {
+        isChunked = true;
+        return;
+    }
+    if (handler != NULL) {
+        handler(text);
+    }
+}
+
+bool HttpResponseHead::read(Client& client, size_t maxRead) {
+    size_t consumed = 0;
+    while (client.available() && consumed < maxRead) {
+        int c = client.read();
+        consumed++;
+        if (c < 0) {
+            break;
+        }
+        if (!line.add((char)c)) {
+            continue;
+        }
+        if (line.line()[0] == '\0' && statusRead) {
+            return true;  // Blank line ends the head
+        }
+        processLine(line.line());
+    }
+    return false;
+}
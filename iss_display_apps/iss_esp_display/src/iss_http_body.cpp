@@ -0,0 +1,190 @@
+/*
+ * ISS HTTP Body Stream
+ * ====================
+ *
+ * Decodes an HTTP/1.1 response body on the fly. See iss_http_body.h.
+ */
+
+#include "iss_http_body.h"
+
+HttpBodyStream::HttpBodyStream()
+    : client(NULL),
+      remaining(-1),
+      chunked(false),
+      chunkRemaining(0),
+      chunkDataEnded(false),
+      deadline(0),
+      done(true),
+      error(false),
+      delivered(0),
+      bufferPos(0),
+      bufferLength(0) {
+    // read() does its own waiting; Stream's timed retries would only spin
+    setTimeout(0);
+}
+
+void HttpBodyStream::begin(Client& client, long contentLength, bool chunked, unsigned long deadline) {
+    this->client = &client;
+    this->remaining = chunked ? -1 : contentLength;
+    this->chunked = chunked;
+    this->deadline = deadline;
+    chunkRemaining = 0;
+    chunkDataEnded = false;
+    done = !chunked && contentLength == 0;
+    error = false;
+    delivered = 0;
+    bufferPos = 0;
+    bufferLength = 0;
+}
+
+bool HttpBodyStream::drain() {
+    while (fill()) {
+        bufferPos = bufferLength;
+    }
+    return complete() && !error;
+}
+
+int HttpBodyStream::available() {
+    return bufferLength - bufferPos;
+}
+
+int HttpBodyStream::read() {
+    if (!fill()) {
+        return -1;
+    }
+    delivered++;
+    return buffer[bufferPos++];
+}
+
+int HttpBodyStream::peek() {
+    if (!fill()) {
+        return -1;
+    }
+    return buffer[bufferPos];
+}
+
+/**
+ * Makes sure at least one decoded byte is buffered
+ * @return False at the end of the body or on failure
+ */
+bool HttpBodyStream::fill() {
+    if (bufferPos < bufferLength) {
+        return true;
+    }
+    if (done || error || client == NULL) {
+        return false;
+    }
+
+    size_t wanted = sizeof(buffer);
+    if (chunked) {
+        if (chunkRemaining == 0 && !readChunkSize()) {
+            return false;
+        }
+        wanted = min(wanted, chunkRemaining);
+    } else if (remaining >= 0) {
+        wanted = min(wanted, (size_t)remaining);
+    }
+
+    int count = readRaw(buffer, wanted);
+    if (count <= 0) {
+        // A body without length or chunking ends when the server closes
+        if (!chunked && remaining < 0 && !timedOut()) {
+            done = true;
+        } else {
+            error = true;
+        }
+        return false;
+    }
+
+    bufferPos = 0;
+    bufferLength = count;
+    if (chunked) {
+        chunkRemaining -= count;
+        chunkDataEnded = chunkRemaining == 0;
+    } else if (remaining > 0) {
+        remaining -= count;
+        done = remaining == 0;
+    }
+    return true;
+}
+
+/**
+ * Reads the next chunk size line (and the trailer after the last chunk)
+ * @return False at the end of the body or on failure
+ */
+bool HttpBodyStream::readChunkSize() {
+    char line[20];
+    size_t length = 0;
+    int c;
+
+    // Skip the CRLF that follows the previous chunk's data
+    if (chunkDataEnded) {
+        while ((c = readRawByte()) >= 0 && c != '\n') {
+        }
+        if (c < 0) {
+            error = true;
+            return false;
+        }
+        chunkDataEnded = false;
+    }
+
+    while ((c = readRawByte()) >= 0 && c != '\n') {
+        if (c != '\r' && length < sizeof(line) - 1) {
+            line[length++] = (char)c;
+        }
+    }
+    if (c < 0) {
+        error = true;
+        return false;
+    }
+    line[length] = '\0';
+    chunkRemaining = strtoul(line, NULL, 16);  // Stops at any ";extension"
+    if (chunkRemaining > 0) {
+        return true;
+    }
+
+    // Last chunk: consume trailer lines up to the terminating blank line
+    for (;;) {
+        length = 0;
+        while ((c = readRawByte()) >= 0 && c != '\n') {
+            if (c != '\r') {
+                length++;
+            }
+        }
+        if (c < 0) {
+            error = true;
+            return false;
+        }
+        if (length == 0) {
+            break;
+        }
+    }
+    done = true;
+    return false;
+}
+
+/**
+ * Reads raw bytes from the connection, waiting until some arrive
+ * @return Number of bytes read, or -1 if the connection closed or timed out
+ */
+int HttpBodyStream::readRaw(uint8_t* buf, size_t size) {
+    for (;;) {
+        int available = client->available();
+        if (available > 0) {
+            return client->read(buf, min(size, (size_t)available));
+        }
+        if (!client->connected() || timedOut()) {
+            return -1;
+        }
+        delay(1);
+    }
+}
+
+int HttpBodyStream::readRawByte() {
+    uint8_t b;
+    return readRaw(&b, 1) == 1 ? b : -1;
+}
+
+bool HttpBodyStream::timedOut() const {
+    return (long)(millis() - deadline) >= 0;
+}
@@ -0,0 +1,128 @@
+/*
+ * ISS Last-Known Display Content
+ * ==============================
+ *
+ * NVS storage of the last good display content. See iss_last_known.h.
+ */
+
+#include "iss_last_known.h"
+#include <Preferences.h>
+#include <ctype.h>
+
+// NVS namespace and keys
+static const char* prefsNamespace = "iss_last";
+static const char* prefsLine1Key = "line1";
+static const char* prefsLine2Key = "line2";
+static const char* prefsMetaKey = "meta";
+
+// Bump when LastKnownMeta changes, so stale blobs are ignored
+static const uint8_t metaVersion = 1;
+
+// Everything but the lines
+struct LastKnownMeta {
+    uint8_t version;
+    uint8_t red;
+    uint8_t green;
+    uint8_t blue;
+    int32_t positionColumn;
+    float latitude;
+    float longitude;
+    int64_t savedAt;            // Unix time, 0 if the clock was not set
+    OrbitElements orbit;
+};
+
+static time_t loadedSavedAt = 0;
+static uint32_t savedChecksum = 0;   // Of the lines last written this boot
+
+/**
+ * FNV-1a hash of both lines, to skip rewriting unchanged content
+ * Digits on line 1 are left out: they are the position and the clock, which
+ * differ in every update even when the place and the fact do not
+ */
+static uint32_t linesChecksum(const DisplaySnapshot& snapshot) {
+    const char* lines[] = {snapshot.line1, snapshot.line2};
+    uint32_t hash = 2166136261u;
+    for (const char* line : lines) {
+        for (const char* c = line; *c != '\0'; c++) {
+            if (line == snapshot.line1 && isdigit((unsigned char)*c)) {
+                continue;
+            }
+            hash = (hash ^ (uint8_t)*c) * 16777619u;
+        }
+        hash = (hash ^ 0xFF) * 16777619u;  // Line separator
+    }
+    return hash;
+}
+
+bool lastKnownLoad(DisplaySnapshot& snapshot) {
+    Preferences prefs;
+    if (!prefs.begin(prefsNamespace, true)) {
+        return false;
+    }
+
+    LastKnownMeta meta;
+    bool found = prefs.getBytes(prefsMetaKey, &meta, sizeof(meta)) == sizeof(meta) &&
+                 meta.version == metaVersion &&
+                 prefs.getString(prefsLine1Key, snapshot.line1, sizeof(snapshot.line1)) > 0;
+    if (found) {
+        if (prefs.getString(prefsLine2Key, snapshot.line2, sizeof(snapshot.line2)) == 0) {
+            snapshot.line2[0] = '\0';
+        }
+        snapshot.red = meta.red;
+        snapshot.green = meta.green;
+        snapshot.blue = meta.blue;
+        snapshot.hasLines = true;
+        snapshot.redrawNow = true;
+        snapshot.positionColumn = meta.positionColumn;
+        snapshot.latitude = meta.latitude;
+        snapshot.longitude = meta.longitude;
+        snapshot.orbit = meta.orbit;
+        loadedSavedAt = meta.savedAt;
+        savedChecksum = linesChecksum(snapshot);
+    }
+    prefs.end();
+    return found;
+}
+
+void lastKnownSave(const DisplaySnapshot& snapshot) {
+    if (!snapshot.hasLines) {
+        return;
+    }
+    uint32_t checksum = linesChecksum(snapshot);
+    if (checksum == savedChecksum) {
+        return;
+    }
+
+    LastKnownMeta meta;
+    memset(&meta, 0, sizeof(meta));
+    meta.version = metaVersion;
+    meta.red = snapshot.red;
+    meta.green = snapshot.green;
+    meta.blue = snapshot.blue;
+    meta.positionColumn = snapshot.positionColumn;
+    meta.latitude = snapshot.latitude;
+    meta.longitude = snapshot.longitude;
+    meta.savedAt = time(nullptr) >= 1000000000 ? time(nullptr) : 0;
+    meta.orbit = snapshot.orbit;
+
+    Preferences prefs;
+    if (!prefs.begin(prefsNamespace, false)) {
+        Serial.println("Could not open NVS for last-known content");
+        return;
+    }
+    // putString() reports the length written, so an empty line2 is not an error
+    bool ok = prefs.putString(prefsLine1Key, snapshot.line1) > 0 &&
+              (prefs.putString(prefsLine2Key, snapshot.line2) > 0 || snapshot.line2[0] == '\0') &&
+              prefs.putBytes(prefsMetaKey, &meta, sizeof(meta)) == sizeof(meta);
+    prefs.end();
+
+    if (ok) {
+        savedChecksum = checksum;
+    } else {
+        Serial.println("Saving last-known content failed");
+    }
+}
+
+time_t lastKnownSavedAt() {
+    return loadedSavedAt;
+}
@@ -0,0 +1,130 @@
+/*
+ * ISS LCD Driver
+ * ==============
+ *
+ * Batched I2C writes to the Grove RGB LCD. See iss_lcd.h.
+ */
+
+#include "iss_lcd.h"
+#include <Wire.h>
+
+// I2C addresses (7-bit)
+static const uint8_t lcdAddress = 0x3E;          // AiP31068 text controller
+static const uint8_t rgbAddress = 0x62;          // PCA9633 backlight
+static const uint8_t rgbAddressV5 = 0x30;        // Backlight chip of the v5 board
+
+// Control bytes of the text controller: Co (more control bytes follow) and RS
+static const uint8_t controlCommandMore = 0x80;  // One command byte, then another control byte
+static const uint8_t controlCommands = 0x00;     // Command bytes until the stop
+static const uint8_t controlData = 0x40;         // Data bytes until the stop
+
+// Commands
+static const uint8_t commandClear = 0x01;
+static const uint8_t commandSetAddress = 0x80;   // | DDRAM address
+static const uint8_t rowAddress[LCD_ROWS] = {0x00, 0x40};
+static const unsigned long clearTime = 2;        // ms the controller needs to clear
+
+// PCA9633: auto-increment over the PWM registers, starting at PWM0 (blue)
+static const uint8_t rgbBurstPwm0 = 0xA2;
+
+static rgb_lcd panel;
+static bool v5Backlight = false;
+static int addressRow = -1;                      // Where the address counter is, -1 if unknown
+static int addressColumn = -1;
+static int currentColour = -1;                   // 0xRRGGBB last sent, -1 if unknown
+static LcdStats stats = {0, 0, 0, 0};
+
+/**
+ * Sends one transaction and counts it
+ */
+static void send(uint8_t address, const uint8_t* data, size_t length) {
+    uint32_t start = micros();
+    Wire.beginTransmission(address);
+    Wire.write(data, length);
+    Wire.endTransmission();
+    stats.busyUs += micros() - start;
+    stats.transactions++;
+    stats.bytes += length;
+}
+
+void lcdBegin(int sda, int scl) {
+    Wire.begin(sda, scl);
+    panel.begin(LCD_COLUMNS, LCD_ROWS);
+
+    // Same probe as the library, which keeps its answer private
+    Wire.beginTransmission(rgbAddressV5);
+    v5Backlight = Wire.endTransmission() == 0;
+
+    // After the library's init, which runs at its own pace
+    Wire.setClock(ISS_LCD_I2C_HZ);
+    addressRow = -1;
+    currentColour = -1;
+    Serial.printf("LCD on I2C at %u kHz, %s backlight\n",
+                  (unsigned)(ISS_LCD_I2C_HZ / 1000), v5Backlight ? "v5" : "PCA9633");
+}
+
+rgb_lcd& lcdPanel() {
+    addressRow = -1;  // The caller may move the address counter
+    return panel;
+}
+
+void lcdClear() {
+    const uint8_t clear[] = {controlCommands, commandClear};
+    send(lcdAddress, clear, sizeof(clear));
+    delay(clearTime);
+    addressRow = 0;
+    addressColumn = 0;
+}
+
+void lcdWrite(int row, int column, const char* text, int count) {
+    if (row < 0 || row >= LCD_ROWS || column < 0 || column >= LCD_COLUMNS) {
+        return;
+    }
+    count = constrain(count, 0, LCD_COLUMNS - column);
+    if (count == 0) {
+        return;
+    }
+
+    uint8_t buffer[3 + LCD_COLUMNS];
+    size_t length = 0;
+    if (row != addressRow || column != addressColumn) {
+        buffer[length++] = controlCommandMore;
+        buffer[length++] = commandSetAddress | (rowAddress[row] + column);
+        stats.addressSets++;
+    }
+    buffer[length++] = controlData;
+    memcpy(buffer + length, text, count);
+    length += count;
+    send(lcdAddress, buffer, length);
+
+    addressRow = row;
+    addressColumn = column + count;
+}
+
+void lcdSetRGB(uint8_t red, uint8_t green, uint8_t blue) {
+    int colour = (red << 16) | (green << 8) | blue;
+    if (colour == currentColour) {
+        return;
+    }
+    currentColour = colour;
+
+    if (v5Backlight) {
+        const uint8_t registers[3][2] = {{0x06, red}, {0x07, green}, {0x08, blue}};
+        for (int i = 0; i < 3; i++) {
+            send(rgbAddressV5, registers[i], 2);
+        }
+        return;
+    }
+    const uint8_t burst[] = {rgbBurstPwm0, blue, green, red};
+    send(rgbAddress, burst, sizeof(burst));
+}
+
+const LcdStats& lcdStats() {
+    return stats;
+}
+
+void lcdLogStats() {
+    Serial.printf("LCD bus: %u transactions, %u bytes, %u address sets, %u ms busy\n",
+                  (unsigned)stats.transactions, (unsigned)stats.bytes,
+                  (unsigned)stats.addressSets, (unsigned)(stats.busyUs / 1000));
+}
@@ -0,0 +1,221 @@
+/*
+ * ISS Metrics
+ * ===========
+ *
+ * Lock-free histograms and a minimal Prometheus endpoint. See iss_metrics.h.
+ */
+
+#include "iss_metrics.h"
+#include <WiFi.h>
+
+// Upper bound of bucket 0, in microseconds
+static const uint32_t firstBucketUs = 64;
+
+// A scrape request must arrive within this long after connecting (ms);
+// it is read across calls, so a slow client does not hold the network task
+static const unsigned long requestTimeout = 500;
+static const size_t maxReadPerCall = 256;
+
+struct Histogram {
+    uint32_t counts[METRIC_BUCKETS + 1];  // Last entry: above the top bucket
+    uint32_t samples;
+    uint64_t sumUs;
+    uint32_t maxUs;
+};
+
+static const char* timerNames[METRIC_TIMER_COUNT] = {
+    "dns", "tls_handshake", "ttfb", "parse", "render", "loop_jitter"
+};
+static const char* counterNames[METRIC_COUNTER_COUNT] = {
+    "done", "unchanged", "failed"
+};
+
+static Histogram histograms[METRIC_TIMER_COUNT];
+static uint32_t counters[METRIC_COUNTER_COUNT];
+static uint32_t minFreeHeap = UINT32_MAX;
+static uint32_t minLargestBlock = UINT32_MAX;
+
+#if ISS_METRICS_PORT
+static WiFiServer server(ISS_METRICS_PORT);
+static bool serverStarted = false;
+
+// Scrape request being read; only the request line matters
+static WiFiClient pending;
+static unsigned long acceptedAt = 0;
+static char requestLine[64];
+static size_t requestLength = 0;
+static bool lineDone = false;
+static int newlines = 0;
+#endif
+
+/**
+ * @return The bucket for a duration: the first whose bound is above it
+ */
+static int bucketFor(uint32_t us) {
+    if (us < firstBucketUs) {
+        return 0;
+    }
+    int bucket = (32 - __builtin_clz(us)) - 6;  // 64..127 us -> 1
+    return bucket < METRIC_BUCKETS ? bucket : METRIC_BUCKETS;
+}
+
+/**
+ * Estimates a quantile as the upper bound of the bucket it falls in
+ * @return Microseconds, or the maximum if it falls above the top bucket
+ */
+static uint32_t quantile(const Histogram& histogram, float q) {
+    uint32_t target = (uint32_t)(histogram.samples * q + 0.5f);
+    uint32_t seen = 0;
+    for (int i = 0; i < METRIC_BUCKETS; i++) {
+        seen += histogram.counts[i];
+        if (seen >= target && seen > 0) {
+            return min(firstBucketUs << i, histogram.maxUs);
+        }
+    }
+    return histogram.maxUs;
+}
+
+void metricsRecord(MetricTimer timer, uint32_t us) {
+    Histogram& histogram = histograms[timer];
+    histogram.counts[bucketFor(us)]++;
+    histogram.sumUs += us;
+    if (us > histogram.maxUs) {
+        histogram.maxUs = us;
+    }
+    histogram.samples++;
+}
+
+void metricsCount(MetricCounter counter) {
+    counters[counter]++;
+}
+
+void metricsSampleHeap() {
+    uint32_t freeHeap = ESP.getFreeHeap();
+    uint32_t largestBlock = ESP.getMaxAllocHeap();
+    if (freeHeap < minFreeHeap) {
+        minFreeHeap = freeHeap;
+    }
+    if (largestBlock < minLargestBlock) {
+        minLargestBlock = largestBlock;
+    }
+}
+
+void metricsBegin() {
+#if ISS_METRICS_PORT
+    if (!serverStarted) {
+        server.begin();
+        serverStarted = true;
+        Serial.printf("Metrics on port %d\n", ISS_METRICS_PORT);
+    }
+#endif
+}
+
+#if ISS_METRICS_PORT
+/**
+ * Writes one histogram in Prometheus text format
+ */
+static void writeHistogram(WiFiClient& client, const char* name, const Histogram& histogram) {
+    client.printf("# TYPE iss_%s_seconds histogram\n", name);
+    uint32_t cumulative = 0;
+    for (int i = 0; i < METRIC_BUCKETS; i++) {
+        cumulative += histogram.counts[i];
+        client.printf("iss_%s_seconds_bucket{le=\"%g\"} %u\n", name,
+                      (firstBucketUs << i) / 1e6, (unsigned)cumulative);
+    }
+    client.printf("iss_%s_seconds_bucket{le=\"+Inf\"} %u\n", name, (unsigned)histogram.samples);
+    client.printf("iss_%s_seconds_sum %.6f\n", name, histogram.sumUs / 1e6);
+    client.printf("iss_%s_seconds_count %u\n", name, (unsigned)histogram.samples);
+}
+
+/**
+ * Writes the whole scrape body
+ */
+static void writeMetrics(WiFiClient& client) {
+    for (int i = 0; i < METRIC_TIMER_COUNT; i++) {
+        writeHistogram(client, timerNames[i], histograms[i]);
+    }
+
+    client.print("# TYPE iss_updates_total counter\n");
+    for (int i = 0; i < METRIC_COUNTER_COUNT; i++) {
+        client.printf("iss_updates_total{result=\"%s\"} %u\n", counterNames[i], (unsigned)counters[i]);
+    }
+
+    metricsSampleHeap();
+    client.print("# TYPE iss_heap_free_bytes gauge\n");
+    client.printf("iss_heap_free_bytes %u\n", (unsigned)ESP.getFreeHeap());
+    client.print("# TYPE iss_heap_min_free_bytes gauge\n");
+    client.printf("iss_heap_min_free_bytes %u\n", (unsigned)minFreeHeap);
+    client.print("# TYPE iss_heap_largest_free_block_bytes gauge\n");
+    client.printf("iss_heap_largest_free_block_bytes %u\n", (unsigned)ESP.getMaxAllocHeap());
+    client.print("# TYPE iss_heap_min_largest_free_block_bytes gauge\n");
+    client.printf("iss_heap_min_largest_free_block_bytes %u\n", (unsigned)minLargestBlock);
+    client.print("# TYPE iss_wifi_rssi_dbm gauge\n");
+    client.printf("iss_wifi_rssi_dbm %d\n", (int)WiFi.RSSI());
+    client.print("# TYPE iss_uptime_seconds counter\n");
+    client.printf("iss_uptime_seconds %lu\n", millis() / 1000);
+}
+#endif
+
+void metricsServe() {
+#if ISS_METRICS_PORT
+    if (!serverStarted) {
+        return;
+    }
+    if (!pending) {
+        pending = server.accept();
+        if (!pending) {
+            return;
+        }
+        acceptedAt = millis();
+        requestLength = 0;
+        lineDone = false;
+        newlines = 0;
+    }
+
+    // Take what has arrived of the head; the rest of it is skipped
+    for (size_t i = 0; i < maxReadPerCall && newlines < 2; i++) {
+        int c = pending.read();
+        if (c < 0) {
+            break;
+        }
+        if (c == '\n') {
+            lineDone = true;
+            newlines++;
+        } else if (c != '\r') {
+            newlines = 0;
+            if (!lineDone && requestLength < sizeof(requestLine) - 1) {
+                requestLine[requestLength++] = (char)c;
+            }
+        }
+    }
+    if (newlines < 2 && pending.connected() && millis() - acceptedAt < requestTimeout) {
+        return;  // Look again on the next call
+    }
+    requestLine[requestLength] = '\0';
+
+    if (strncmp(requestLine, "GET /metrics ", 13) == 0) {
+        pending.print("HTTP/1.1 200 OK\r\n"
+                      "Content-Type: text/plain; version=0.0.4\r\n"
+                      "Connection: close\r\n\r\n");
+        writeMetrics(pending);
+    } else {
+        pending.print("HTTP/1.1 404 Not Found\r\n"
+                      "Content-Length: 0\r\n"
+                      "Connection: close\r\n\r\n");
+    }
+    pending.stop();
+#endif
+}
+
+void metricsLogSummary() {
+    Serial.print("Metrics (p50/p90/max ms):");
+    for (int i = 0; i < METRIC_TIMER_COUNT; i++) {
+        const Histogram& histogram = histograms[i];
+        if (histogram.samples == 0) {
+            continue;
+        }
+        Serial.printf(" %s %.1f/%.1f/%.1f", timerNames[i], quantile(histogram, 0.5f) / 1000.0f,
+                      quantile(histogram, 0.9f) / 1000.0f, histogram.maxUs / 1000.0f);
+    }
+    Serial.printf(", min heap %u, min block %u\n", (unsigned)minFreeHeap, (unsigned)minLargestBlock);
+}
@@ -0,0 +1,176 @@
+/*
+ * ISS Orbit Propagator
+ * ====================
+ *
+ * TLE parsing and J2 secular propagation. See iss_orbit.h.
+ *
+ * Time terms are kept in double so the phase stays exact over days of
+ * propagation; each angle is reduced to one turn before the float trig.
+ */
+
+#include "iss_orbit.h"
+#include <math.h>
+
+// WGS-84 constants
+static const double earthMu = 398600.4418;          // km^3/s^2
+static const double earthRadius = 6378.137;         // km
+static const double earthJ2 = 1.08262668e-3;
+static const double earthFlattening = 1.0 / 298.257223563;
+
+static const double twoPi = 2.0 * M_PI;
+static const double secondsPerDay = 86400.0;
+static const double degToRad = M_PI / 180.0;
+
+/**
+ * Parses a fixed-column TLE field
+ * @param line TLE line
+ * @param start Zero-based first column
+ * @param length Field width
+ * @return The field's value
+ */
+static double tleField(const char* line, int start, int length) {
+    char field[16];
+    memcpy(field, line + start, length);
+    field[length] = '\0';
+    return strtod(field, NULL);
+}
+
+/**
+ * Checks a TLE line's length, line number and modulo-10 checksum
+ * @param line TLE line
+ * @param number Expected line number (1 or 2)
+ * @return True if the line is well formed
+ */
+static bool tleLineValid(const char* line, char number) {
+    if (line == NULL || strlen(line) < TLE_LINE_LENGTH || line[0] != number) {
+        return false;
+    }
+    int sum = 0;
+    for (int i = 0; i < TLE_LINE_LENGTH - 1; i++) {
+        if (isdigit((unsigned char)line[i])) {
+            sum += line[i] - '0';
+        } else if (line[i] == '-') {
+            sum += 1;
+        }
+    }
+    return line[TLE_LINE_LENGTH - 1] == '0' + sum % 10;
+}
+
+/**
+ * @param year Calendar year
+ * @return Days from 1970-01-01 to January 1st of the year
+ */
+static long daysToYear(int year) {
+    long y = year - 1;
+    long leaps = (y / 4 - 1969 / 4) - (y / 100 - 1969 / 100) + (y / 400 - 1969 / 400);
+    return 365L * (year - 1970) + leaps;
+}
+
+/**
+ * @param angle Angle in radians
+ * @return The angle reduced to [0, 2pi)
+ */
+static double wrapTurn(double angle) {
+    angle = fmod(angle, twoPi);
+    return angle < 0 ? angle + twoPi : angle;
+}
+
+bool orbitParseTle(const char* line1, const char* line2, OrbitElements& elements) {
+    elements.valid = false;
+    if (!tleLineValid(line1, '1') || !tleLineValid(line2, '2')) {
+        return false;
+    }
+
+    // Line 1: epoch as YYDDD.DDDDDDDD, then ndot/2 in rev/day^2
+    int year = (int)tleField(line1, 18, 2);
+    year += year < 57 ? 2000 : 1900;
+    double dayOfYear = tleField(line1, 20, 12);
+    double meanMotionHalfDot = tleField(line1, 33, 10);
+
+    // Line 2: angles in degrees, eccentricity with an implied leading decimal point
+    double inclination = tleField(line2, 8, 8) * degToRad;
+    double raan = tleField(line2, 17, 8) * degToRad;
+    double eccentricity = tleField(line2, 26, 7) * 1e-7;
+    double argPerigee = tleField(line2, 34, 8) * degToRad;
+    double meanAnomaly = tleField(line2, 43, 8) * degToRad;
+    double revsPerDay = tleField(line2, 52, 11);
+    if (revsPerDay <= 0 || eccentricity >= 1) {
+        return false;
+    }
+
+    double n = revsPerDay * twoPi / secondsPerDay;
+    double a = cbrt(earthMu / (n * n));
+    double p = a * (1 - eccentricity * eccentricity);
+    double k = 1.5 * earthJ2 * (earthRadius / p) * (earthRadius / p) * n;
+    double sinI = sin(inclination);
+
+    elements.epoch = (daysToYear(year) + dayOfYear - 1) * secondsPerDay;
+    elements.meanAnomaly = meanAnomaly;
+    elements.meanMotion = n;
+    elements.meanMotionDrift = meanMotionHalfDot * twoPi / (secondsPerDay * secondsPerDay);
+    elements.raan = raan;
+    elements.argPerigee = argPerigee;
+    elements.inclination = inclination;
+    elements.eccentricity = eccentricity;
+    elements.semiMajorAxis = a;
+    elements.raanRate = -k * cos(inclination);
+    elements.argPerigeeRate = k * (2.0 - 2.5 * sinI * sinI);
+    elements.valid = true;
+    return true;
+}
+
+bool orbitPosition(const OrbitElements& elements, time_t now, float& latitude, float& longitude) {
+    if (!elements.valid) {
+        return false;
+    }
+    double dt = (double)now - elements.epoch;
+
+    // Mean anomaly, then eccentric anomaly from Kepler's equation
+    float e = elements.eccentricity;
+    float m = wrapTurn(elements.meanAnomaly + elements.meanMotion * dt +
+                       elements.meanMotionDrift * dt * dt);
+    float eccentricAnomaly = m;
+    for (int i = 0; i < 4; i++) {
+        eccentricAnomaly -= (eccentricAnomaly - e * sinf(eccentricAnomaly) - m) /
+                            (1 - e * cosf(eccentricAnomaly));
+    }
+    float trueAnomaly = atan2f(sqrtf(1 - e * e) * sinf(eccentricAnomaly), cosf(eccentricAnomaly) - e);
+    float radius = elements.semiMajorAxis * (1 - e * cosf(eccentricAnomaly));
+
+    // Position in the inertial frame
+    float u = wrapTurn(elements.argPerigee + elements.argPerigeeRate * dt) + trueAnomaly;
+    float node = wrapTurn(elements.raan + elements.raanRate * dt);
+    float cosU = cosf(u), sinU = sinf(u);
+    float cosNode = cosf(node), sinNode = sinf(node);
+    float cosI = cosf(elements.inclination), sinI = sinf(elements.inclination);
+    float x = radius * (cosNode * cosU - sinNode * sinU * cosI);
+    float y = radius * (sinNode * cosU + cosNode * sinU * cosI);
+    float z = radius * sinU * sinI;
+
+    // Greenwich mean sidereal time (days counted from J2000.0)
+    double daysJ2000 = (double)now / secondsPerDay - 10957.5;
+    double gmst = wrapTurn((280.46061837 + 360.98564736629 * daysJ2000) * degToRad);
+
+    float lon = wrapTurn(atan2(y, x) - gmst);
+    if (lon > M_PI) {
+        lon -= twoPi;
+    }
+
+    // Geodetic latitude of the point below the satellite
+    const float e2 = earthFlattening * (2 - earthFlattening);
+    float rho = sqrtf(x * x + y * y);
+    float lat = atan2f(z, rho);
+    for (int i = 0; i < 3; i++) {
+        float sinLat = sinf(lat);
+        float n = earthRadius / sqrtf(1 - e2 * sinLat * sinLat);
+        lat = atan2f(z + e2 * n * sinLat, rho);
+    }
+
+    latitude = lat / degToRad;
+    longitude = lon / degToRad;
+    return true;
+}
+
+float orbitAgeHours(const OrbitElements& elements, time_t now) {
+    return ((double)now - elements.epoch) / 3600.0;
+}
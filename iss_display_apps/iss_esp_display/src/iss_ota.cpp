@@ -0,0 +1,678 @@
+/*
+ * ISS OTA Update
+ * ==============
+ *
+ * Step-driven firmware download, patching and trial boot. See iss_ota.h.
+ */
+
+#include "iss_ota.h"
+#include <Preferences.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <esp32/rom/miniz.h>
+#include "iss_tls.h"
+#include "iss_http.h"
+#include "iss_http_body.h"
+#include "iss_ota_patch.h"
+#include "iss_profile.h"
+
+// Check timing (in milliseconds)
+static const unsigned long checkInterval = 6UL * 60 * 60 * 1000;  // 6 hours
+static const unsigned long checkJitter = 30UL * 60 * 1000;        // Spreads a fleet's checks
+static const unsigned long failureRetryDelay = 60UL * 60 * 1000;  // After a failed update
+static const unsigned long connectTimeout = 15000;   // Resolve to response headers
+static const unsigned long stallTimeout = 20000;     // Longest gap in the download
+static const unsigned long readWait = 500;           // Longest wait for a split chunk header
+static const unsigned long flashWriteGap = 100;      // Between sector writes
+static const size_t maxReadPerStep = 256;            // Response head bytes consumed per step
+
+// Memory: the update's buffers plus the TLS buffers of its connection
+static const size_t heapReserve = 48 * 1024;
+
+// Trial boots of a new image before the boot counter rolls it back
+static const uint8_t maxTrialBoots = 2;
+
+// NVS namespace and keys
+static const char* prefsNamespace = "iss_ota";
+static const char* prefsTargetKey = "target";      // Id of the image on trial
+static const char* prefsSlotKey = "slot";          // Flash address of its partition
+static const char* prefsTrialsKey = "trials";      // Its boots so far
+static const char* prefsRejectedKey = "rejected";  // Id of the last image rolled back
+
+// Source partition access: a mapped window of two MMU pages, so any read
+// the patch makes (at most 256 bytes) fits whatever its alignment
+static const size_t mmapPageSize = 0x10000;
+static const size_t sourceWindowSize = 2 * mmapPageSize;
+
+// Check and update stages
+enum OtaState {
+    OTA_IDLE,
+    OTA_RESOLVE,
+    OTA_CONNECT,
+    OTA_TLS,
+    OTA_HEADERS,        // Request sent, reading the response head
+    OTA_PATCH_HEADER,   // Reading the uncompressed patch header
+    OTA_APPLY           // Inflating, patching and writing the new image
+};
+
+// Working memory of an update, allocated only while one is downloaded
+struct OtaBuffers {
+    tinfl_decompressor inflator;
+    uint8_t dictionary[TINFL_LZ_DICT_SIZE];   // Inflate output, also its window
+    uint8_t sector[4096];                     // Target bytes for the next flash write
+    uint8_t input[512];                       // Compressed bytes from the body
+};
+
+static IssTlsClient client;
+static HttpBodyStream body;
+static OtaState state = OTA_IDLE;
+static unsigned long attemptStart = 0;
+static unsigned long lastByteAt = 0;
+static unsigned long lastWriteAt = 0;
+static unsigned long checkScheduledAt = 0;
+static unsigned long checkDelay = 0;
+
+// Response head parsing state
+static HttpResponseHead head;
+static char offeredVersion[32] = "";    // X-Firmware-Version of the offered image
+
+// Update state
+static OtaBuffers* buffers = NULL;
+static OtaPatch patch;
+static OtaPatchHeader header;
+static size_t inputPos = 0;
+static size_t inputLength = 0;
+static size_t dictionaryPos = 0;        // Where the next inflate writes
+static size_t pendingStart = 0;         // Inflated bytes not yet given to the patch
+static size_t pendingLength = 0;
+static size_t sectorLength = 0;
+static bool inflateDone = false;
+static const esp_partition_t* running = NULL;
+static const esp_partition_t* target = NULL;
+static esp_ota_handle_t otaHandle = 0;
+static bool otaOpen = false;            // esp_ota_begin() succeeded, not yet ended
+
+// Mapped window of the running partition
+static const uint8_t* windowData = NULL;
+static spi_flash_mmap_handle_t windowHandle = 0;
+static uint32_t windowStart = 0;
+static uint32_t windowLength = 0;
+static bool windowMapped = false;
+
+// Image ids (see iss_ota_patch.h)
+static uint8_t runningId[OTA_IMAGE_ID_SIZE];
+static bool runningIdValid = false;
+static uint8_t rejectedId[OTA_IMAGE_ID_SIZE];
+static bool hasRejected = false;
+static bool onTrial = false;
+
+// Counters since boot, for otaLogStats()
+static uint32_t checks = 0;
+static uint32_t failures = 0;
+static uint32_t rollbacks = 0;
+
+/**
+ * Keeps the Arduino core from confirming a new image as soon as it boots;
+ * otaHealthy() does once the image has proven itself
+ */
+extern "C" bool verifyRollbackLater() {
+    return true;
+}
+
+/**
+ * Formats the first bytes of an image id as hex, for logging and the request
+ * @param output Buffer of at least 2 * length + 1 bytes
+ */
+static void formatId(const uint8_t* id, size_t length, char* output) {
+    for (size_t i = 0; i < length; i++) {
+        sprintf(output + 2 * i, "%02x", id[i]);
+    }
+}
+
+/**
+ * Arms the next check
+ */
+static void scheduleCheck(unsigned long delayMs) {
+    checkScheduledAt = millis();
+    checkDelay = delayMs;
+}
+
+/**
+ * Drops the connection and everything an update holds
+ * An unfinished image is abandoned; the inactive partition keeps whatever
+ * was written, which the next update overwrites
+ */
+static void releaseUpdate() {
+    if (windowMapped) {
+        spi_flash_munmap(windowHandle);
+        windowMapped = false;
+    }
+    if (otaOpen) {
+        esp_ota_abort(otaHandle);
+        otaOpen = false;
+    }
+    free(buffers);
+    buffers = NULL;
+    client.stop();
+    state = OTA_IDLE;
+}
+
+/**
+ * Ends a check that found nothing to install
+ */
+static void finishCheck(const char* message) {
+    Serial.printf("OTA: %s\n", message);
+    releaseUpdate();
+    scheduleCheck(checkInterval + random(checkJitter + 1));
+}
+
+/**
+ * Abandons a check or update and tries again later
+ * @param reason Short description for the log
+ */
+static void failUpdate(const char* reason) {
+    failures++;
+    Serial.printf("OTA update %s, next check in %lu min\n", reason, failureRetryDelay / 60000);
+    releaseUpdate();
+    scheduleCheck(failureRetryDelay);
+}
+
+/**
+ * Forgets the image on trial, and remembers an image not to install again
+ * @param rejected Id of a rolled back image, or NULL
+ */
+static void clearTrial(const uint8_t* rejected) {
+    Preferences prefs;
+    if (!prefs.begin(prefsNamespace, false)) {
+        return;
+    }
+    if (rejected != NULL) {
+        prefs.putBytes(prefsRejectedKey, rejected, OTA_IMAGE_ID_SIZE);
+        memcpy(rejectedId, rejected, OTA_IMAGE_ID_SIZE);
+        hasRejected = true;
+    }
+    prefs.remove(prefsTargetKey);
+    prefs.remove(prefsSlotKey);
+    prefs.remove(prefsTrialsKey);
+    prefs.end();
+}
+
+/**
+ * Patch source: the running image, read through the mapped window
+ */
+static bool readSource(uint32_t offset, uint8_t* buffer, size_t length, void* context) {
+    if (!windowMapped || offset < windowStart || offset + length > windowStart + windowLength) {
+        if (windowMapped) {
+            spi_flash_munmap(windowHandle);
+            windowMapped = false;
+        }
+        windowStart = offset & ~(uint32_t)(mmapPageSize - 1);
+        windowLength = min((uint32_t)sourceWindowSize, running->size - windowStart);
+        const void* data;
+        if (offset + length > windowStart + windowLength ||
+            esp_partition_mmap(running, windowStart, windowLength, SPI_FLASH_MMAP_DATA,
+                               &data, &windowHandle) != ESP_OK) {
+            return false;
+        }
+        windowData = (const uint8_t*)data;
+        windowMapped = true;
+    }
+    memcpy(buffer, windowData + (offset - windowStart), length);
+    return true;
+}
+
+/**
+ * Patch output: collected into the sector buffer, which the apply step
+ * writes once it is full (the patch is never fed more than fits)
+ */
+static bool writeTarget(const uint8_t* data, size_t length, void* context) {
+    if (sectorLength + length > sizeof(buffers->sector)) {
+        return false;
+    }
+    memcpy(buffers->sector + sectorLength, data, length);
+    sectorLength += length;
+    return true;
+}
+
+/**
+ * Reads what has arrived of the body, without waiting for more
+ * @return Bytes read
+ */
+static size_t readBody(uint8_t* data, size_t size) {
+    size_t count = 0;
+    body.setDeadline(millis() + readWait);
+    while (count < size && (body.available() > 0 || client.available() > 0)) {
+        int c = body.read();
+        if (c < 0) {
+            break;
+        }
+        data[count++] = (uint8_t)c;
+    }
+    if (count > 0) {
+        lastByteAt = millis();
+    }
+    return count;
+}
+
+/**
+ * Fails the update if the body can no longer deliver what is still needed
+ */
+static void checkDownload() {
+    if (body.complete()) {
+        failUpdate("download ended early");
+    } else if (body.failed() || (!client.available() && !client.connected())) {
+        failUpdate("lost the connection");
+    } else if (millis() - lastByteAt >= stallTimeout) {
+        failUpdate("download stalled");
+    }
+}
+
+/**
+ * Resolves the host and starts the TCP connection
+ */
+static void stepResolve() {
+    HttpConnectResult ret = httpBeginConnect(client, bffHost);
+    if (ret != HTTP_CONNECTING) {
+        failUpdate(ret == HTTP_RESOLVE_FAILED ? "could not resolve" : "could not connect");
+        return;
+    }
+    state = OTA_CONNECT;
+}
+
+/**
+ * Handles one header line that iss_http does not
+ */
+static void processHeaderLine(const char* line) {
+    const char* value = httpHeaderValue(line, "X-Firmware-Version");
+    if (value) {
+        strlcpy(offeredVersion, value, sizeof(offeredVersion));
+    }
+}
+
+/**
+ * Asks for an update from the running image
+ * Closes the connection after the response: a check is hours from the next
+ */
+static void sendRequest() {
+    char query[2 * OTA_IMAGE_ID_SIZE + 16];
+    strcpy(query, "firmware=");
+    formatId(runningId, OTA_IMAGE_ID_SIZE, query + strlen(query));
+
+    if (!httpSendGet(client, bffHost, query,
+                     "Content-Length: 0\r\n"
+                     "Connection: close\r\n"
+                     "Accept: application/octet-stream\r\n")) {
+        failUpdate("request failed");
+        return;
+    }
+    head.begin(processHeaderLine);
+    offeredVersion[0] = '\0';
+    state = OTA_HEADERS;
+}
+
+/**
+ * Reads whatever part of the response head has arrived
+ * 204 means the running image is current; 200 carries a patch
+ */
+static void stepHeaders() {
+    if (head.read(client, maxReadPerStep)) {
+        int status = head.status();
+        if (status == 204 || status == 304) {
+            finishCheck("firmware is up to date");
+            return;
+        }
+        if (status != 200) {
+            char reason[24];
+            snprintf(reason, sizeof(reason), "check got HTTP %d", status);
+            failUpdate(reason);
+            return;
+        }
+        buffers = (OtaBuffers*)malloc(sizeof(OtaBuffers));
+        if (buffers == NULL) {
+            failUpdate("is short of memory");
+            return;
+        }
+        body.begin(client, head.contentLength(), head.chunked(), millis() + readWait);
+        inputLength = 0;
+        lastByteAt = millis();
+        state = OTA_PATCH_HEADER;
+        return;
+    }
+
+    if (!client.available() && !client.connected()) {
+        failUpdate("check closed before the response");
+    }
+}
+
+/**
+ * Reads the patch header and opens the inactive partition for the image
+ */
+static void stepPatchHeader() {
+    inputLength += readBody(buffers->input + inputLength, OTA_PATCH_HEADER_SIZE - inputLength);
+    if (inputLength < OTA_PATCH_HEADER_SIZE) {
+        checkDownload();
+        return;
+    }
+
+    if (!otaParseHeader(buffers->input, header)) {
+        failUpdate("got no patch");
+        return;
+    }
+    if (memcmp(header.targetId, runningId, OTA_IMAGE_ID_SIZE) == 0) {
+        finishCheck("firmware is up to date");
+        return;
+    }
+    if (hasRejected && memcmp(header.targetId, rejectedId, OTA_IMAGE_ID_SIZE) == 0) {
+        finishCheck("skipping the image that was rolled back");
+        return;
+    }
+    if (header.sourceSize > 0 &&
+        (memcmp(header.sourceId, runningId, OTA_IMAGE_ID_SIZE) != 0 ||
+         header.sourceSize > running->size)) {
+        failUpdate("got a patch for another image");
+        return;
+    }
+    target = esp_ota_get_next_update_partition(NULL);
+    if (target == NULL || header.targetSize > target->size) {
+        failUpdate("has no partition for the image");
+        return;
+    }
+    // Sectors are erased as the writes reach them, not all up front
+    if (esp_ota_begin(target, OTA_WITH_SEQUENTIAL_WRITES, &otaHandle) != ESP_OK) {
+        failUpdate("could not open the partition");
+        return;
+    }
+    otaOpen = true;
+
+    tinfl_init(&buffers->inflator);
+    patch.begin(header.sourceSize, header.targetSize, readSource, writeTarget, NULL);
+    inputPos = 0;
+    inputLength = 0;
+    dictionaryPos = 0;
+    pendingStart = 0;
+    pendingLength = 0;
+    sectorLength = 0;
+    inflateDone = false;
+    lastWriteAt = millis() - flashWriteGap;
+
+    Serial.printf("OTA installing %s as %s, %s, %u bytes\n",
+                  offeredVersion[0] != '\0' ? offeredVersion : "an update", target->label,
+                  header.sourceSize > 0 ? "patched" : "full image", (unsigned)header.targetSize);
+    state = OTA_APPLY;
+}
+
+/**
+ * Verifies the written image, selects it and restarts into it on trial
+ */
+static void finishUpdate() {
+    esp_err_t err = esp_ota_end(otaHandle);
+    otaOpen = false;
+    if (err != ESP_OK) {
+        failUpdate("wrote an image that does not verify");
+        return;
+    }
+    uint8_t writtenId[OTA_IMAGE_ID_SIZE];
+    if (esp_partition_get_sha256(target, writtenId) != ESP_OK ||
+        memcmp(writtenId, header.targetId, OTA_IMAGE_ID_SIZE) != 0) {
+        failUpdate("wrote an image that does not match its id");
+        return;
+    }
+    if (esp_ota_set_boot_partition(target) != ESP_OK) {
+        failUpdate("could not select the new image");
+        return;
+    }
+
+    Preferences prefs;
+    if (prefs.begin(prefsNamespace, false)) {
+        prefs.putBytes(prefsTargetKey, header.targetId, OTA_IMAGE_ID_SIZE);
+        prefs.putUInt(prefsSlotKey, target->address);
+        prefs.putUChar(prefsTrialsKey, 0);
+        prefs.end();
+    }
+    Serial.printf("OTA wrote %u bytes from %u downloaded in %lu s, restarting\n",
+                  (unsigned)patch.produced(), (unsigned)(body.consumed() + OTA_PATCH_HEADER_SIZE),
+                  (millis() - attemptStart) / 1000);
+    releaseUpdate();
+    ESP.restart();
+}
+
+/**
+ * Does the next piece of the update: one sector write, one patch feed or
+ * one inflate call
+ */
+static void stepApply() {
+    // A full sector, or the last part of the image, goes to flash once the
+    // previous write is far enough back for the display to catch up
+    if (sectorLength == sizeof(buffers->sector) || (patch.complete() && sectorLength > 0)) {
+        if (millis() - lastWriteAt < flashWriteGap) {
+            return;
+        }
+        esp_err_t err = esp_ota_write(otaHandle, buffers->sector, sectorLength);
+        sectorLength = 0;
+        lastWriteAt = millis();
+        if (err != ESP_OK) {
+            failUpdate("could not write to flash");
+        }
+        return;
+    }
+    if (patch.complete()) {
+        finishUpdate();
+        return;
+    }
+
+    // Inflated bytes go to the patch first, no more than the sector takes
+    if (pendingLength > 0) {
+        size_t count = min(pendingLength, sizeof(buffers->sector) - sectorLength);
+        size_t used = patch.feed(buffers->dictionary + pendingStart, count);
+        pendingStart += used;
+        pendingLength -= used;
+        if (patch.failed()) {
+            failUpdate("got a patch that does not apply");
+        } else if (used < count) {
+            failUpdate("got a patch with trailing data");
+        }
+        return;
+    }
+    if (inflateDone) {
+        failUpdate("got a patch that ends early");
+        return;
+    }
+
+    if (inputPos == inputLength) {
+        inputPos = 0;
+        inputLength = readBody(buffers->input, sizeof(buffers->input));
+        if (inputLength == 0) {
+            checkDownload();
+            return;
+        }
+    }
+
+    // The dictionary is a circular window: output wraps to its start
+    if (dictionaryPos == sizeof(buffers->dictionary)) {
+        dictionaryPos = 0;
+    }
+    size_t inSize = inputLength - inputPos;
+    size_t outSize = sizeof(buffers->dictionary) - dictionaryPos;
+    tinfl_status result = tinfl_decompress(&buffers->inflator, buffers->input + inputPos, &inSize,
+                                           buffers->dictionary, buffers->dictionary + dictionaryPos,
+                                           &outSize,
+                                           TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_HAS_MORE_INPUT);
+    inputPos += inSize;
+    pendingStart = dictionaryPos;
+    pendingLength = outSize;
+    dictionaryPos += outSize;
+    if (result < 0) {
+        failUpdate("got a corrupt download");
+    } else if (result == TINFL_STATUS_DONE) {
+        inflateDone = true;
+    }
+}
+
+void otaBootCheck() {
+    running = esp_ota_get_running_partition();
+    scheduleCheck(random(checkJitter + 1));
+
+    esp_ota_img_states_t imageState;
+    onTrial = running != NULL && esp_ota_get_state_partition(running, &imageState) == ESP_OK &&
+              imageState == ESP_OTA_IMG_PENDING_VERIFY;
+
+    // The image on trial is told apart by its partition: hashing the running
+    // image takes too long to do before the first screen
+    Preferences prefs;
+    if (prefs.begin(prefsNamespace, false)) {
+        hasRejected = prefs.getBytes(prefsRejectedKey, rejectedId, OTA_IMAGE_ID_SIZE) ==
+                      OTA_IMAGE_ID_SIZE;
+        uint8_t trialId[OTA_IMAGE_ID_SIZE];
+        bool updated = prefs.getBytes(prefsTargetKey, trialId, OTA_IMAGE_ID_SIZE) ==
+                       OTA_IMAGE_ID_SIZE;
+        uint32_t trialSlot = prefs.getUInt(prefsSlotKey, 0);
+        uint8_t trials = prefs.getUChar(prefsTrialsKey, 0) + 1;
+        prefs.end();
+
+        if (updated && (running == NULL || running->address != trialSlot)) {
+            // The bootloader went back to this image after the new one reset
+            Serial.println("OTA update was rolled back by the bootloader");
+            rollbacks++;
+            clearTrial(trialId);
+            onTrial = false;
+        } else if (updated) {
+            // Its partition holds the image verified against this id before
+            // the restart
+            memcpy(runningId, trialId, OTA_IMAGE_ID_SIZE);
+            runningIdValid = true;
+            if (trials > maxTrialBoots) {
+                Serial.printf("OTA image reset during %u trial boots\n", (unsigned)maxTrialBoots);
+                otaRollback();
+            } else {
+                if (prefs.begin(prefsNamespace, false)) {
+                    prefs.putUChar(prefsTrialsKey, trials);
+                    prefs.end();
+                }
+                Serial.printf("OTA image on trial, boot %u of %u\n", (unsigned)trials,
+                              (unsigned)maxTrialBoots);
+                onTrial = true;
+            }
+        }
+    }
+}
+
+void otaIdentify() {
+    if (!runningIdValid) {
+        runningIdValid = running != NULL && esp_partition_get_sha256(running, runningId) == ESP_OK;
+    }
+    char id[17];
+    formatId(runningId, 8, id);
+    Serial.printf("Firmware %s, image %s%s\n", esp_ota_get_app_description()->version,
+                  runningIdValid ? id : "unknown", onTrial ? " (on trial)" : "");
+}
+
+bool otaOnTrial() {
+    return onTrial;
+}
+
+void otaHealthy() {
+    if (!onTrial) {
+        return;
+    }
+    onTrial = false;
+    esp_ota_mark_app_valid_cancel_rollback();
+    clearTrial(NULL);
+    Serial.println("OTA image confirmed");
+}
+
+void otaRollback() {
+    Serial.println("OTA rolling back to the previous image");
+    clearTrial(runningIdValid ? runningId : NULL);
+
+    esp_ota_img_states_t imageState;
+    if (esp_ota_get_state_partition(running, &imageState) == ESP_OK &&
+        imageState == ESP_OTA_IMG_PENDING_VERIFY) {
+        esp_ota_mark_app_invalid_rollback_and_reboot();  // Only returns on failure
+    }
+
+    // Without bootloader support: select the other slot if it holds an app
+    const esp_partition_t* previous = esp_ota_get_next_update_partition(NULL);
+    esp_app_desc_t description;
+    if (previous != NULL && esp_ota_get_partition_description(previous, &description) == ESP_OK &&
+        esp_ota_set_boot_partition(previous) == ESP_OK) {
+        ESP.restart();
+    }
+    Serial.println("OTA has no previous image, keeping this one");
+    onTrial = false;
+}
+
+bool otaCheckDue() {
+    return runningIdValid && !onTrial && state == OTA_IDLE &&
+           millis() - checkScheduledAt >= checkDelay;
+}
+
+void otaBegin() {
+    if (otaInProgress()) {
+        return;
+    }
+    checks++;
+    if (ESP.getMaxAllocHeap() < sizeof(OtaBuffers) ||
+        ESP.getFreeHeap() < sizeof(OtaBuffers) + heapReserve) {
+        Serial.printf("OTA check postponed, largest free block %u bytes\n",
+                      (unsigned)ESP.getMaxAllocHeap());
+        scheduleCheck(failureRetryDelay);
+        return;
+    }
+    attemptStart = millis();
+    state = OTA_RESOLVE;
+}
+
+bool otaInProgress() {
+    return state != OTA_IDLE;
+}
+
+void otaStep() {
+    PROFILE_SCOPE(PROFILE_OTA_STEP);
+    if (state >= OTA_RESOLVE && state <= OTA_HEADERS &&
+        millis() - attemptStart >= connectTimeout) {
+        failUpdate("check timed out");
+        return;
+    }
+
+    int ret;
+    switch (state) {
+        case OTA_RESOLVE:
+            stepResolve();
+            break;
+        case OTA_CONNECT:
+            ret = client.pollConnect();
+            if (ret < 0) {
+                failUpdate("could not connect");
+            } else if (ret > 0) {
+                state = OTA_TLS;
+            }
+            break;
+        case OTA_TLS:
+            ret = client.pollHandshake();
+            if (ret < 0) {
+                failUpdate("handshake failed");
+            } else if (ret > 0) {
+                sendRequest();
+            }
+            break;
+        case OTA_HEADERS:
+            stepHeaders();
+            break;
+        case OTA_PATCH_HEADER:
+            stepPatchHeader();
+            break;
+        case OTA_APPLY:
+            stepApply();
+            break;
+        default:
+            break;
+    }
+}
+
+void otaLogStats() {
+    char id[17];
+    formatId(runningId, 8, id);
+    Serial.printf("OTA: image %s%s, %u checks, %u failures, %u rollbacks\n",
+                  runningIdValid ? id : "unknown", onTrial ? " on trial" : "",
+                  (unsigned)checks, (unsigned)failures, (unsigned)rollbacks);
+}
@@ -0,0 +1,144 @@
+/*
+ * ISS OTA Delta Patch
+ * ===================
+ *
+ * bsdiff-style record decoder. See iss_ota_patch.h.
+ */
+
+#include "iss_ota_patch.h"
+
+static const uint8_t patchMagic[4] = {'I', 'S', 'D', '1'};
+static const int maxVarintShift = 63;
+
+/**
+ * @return The little-endian u32 at data
+ */
+static uint32_t readU32(const uint8_t* data) {
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+           ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+bool otaParseHeader(const uint8_t* data, OtaPatchHeader& header) {
+    if (memcmp(data, patchMagic, sizeof(patchMagic)) != 0) {
+        return false;
+    }
+    header.sourceSize = readU32(data + 4);
+    header.targetSize = readU32(data + 8);
+    memcpy(header.sourceId, data + 12, OTA_IMAGE_ID_SIZE);
+    memcpy(header.targetId, data + 12 + OTA_IMAGE_ID_SIZE, OTA_IMAGE_ID_SIZE);
+    return true;
+}
+
+OtaPatch::OtaPatch()
+    : reader(NULL), writer(NULL), context(NULL), sourceSize(0), targetSize(0),
+      written(0), sourcePos(0), stage(STAGE_ERROR), field(0), shift(0),
+      addRemaining(0), copyRemaining(0) {}
+
+void OtaPatch::begin(uint32_t sourceSize, uint32_t targetSize,
+                     OtaSourceReader reader, OtaTargetWriter writer, void* context) {
+    this->reader = reader;
+    this->writer = writer;
+    this->context = context;
+    this->sourceSize = sourceSize;
+    this->targetSize = targetSize;
+    written = 0;
+    sourcePos = 0;
+    field = 0;
+    shift = 0;
+    fields[0] = fields[1] = fields[2] = 0;
+    stage = targetSize == 0 ? STAGE_DONE : STAGE_CONTROL;
+}
+
+/**
+ * Checks a record's lengths once its three control fields are read
+ * @return False if the record would overrun the source or the target
+ */
+bool OtaPatch::finishControl() {
+    uint64_t addLength = fields[0];
+    uint64_t copyLength = fields[1];
+    if (addLength + copyLength > targetSize - written) {
+        return false;
+    }
+    if (addLength > 0 && (sourcePos < 0 || sourcePos + (int64_t)addLength > (int64_t)sourceSize)) {
+        return false;
+    }
+    addRemaining = addLength;
+    copyRemaining = copyLength;
+    stage = addRemaining > 0 ? STAGE_ADD : STAGE_COPY;
+    if (addRemaining == 0 && copyRemaining == 0) {
+        finishRecord();
+    }
+    return true;
+}
+
+/**
+ * Applies the seek that ends a record and starts the next one
+ */
+void OtaPatch::finishRecord() {
+    uint64_t zigzag = fields[2];
+    int64_t seek = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+    sourcePos += seek;
+    field = 0;
+    shift = 0;
+    fields[0] = fields[1] = fields[2] = 0;
+    stage = written == targetSize ? STAGE_DONE : STAGE_CONTROL;
+}
+
+size_t OtaPatch::feed(const uint8_t* data, size_t length) {
+    size_t used = 0;
+    while (used < length) {
+        if (stage == STAGE_CONTROL) {
+            uint8_t byte = data[used++];
+            fields[field] |= (uint64_t)(byte & 0x7F) << shift;
+            if (byte & 0x80) {
+                shift += 7;
+                if (shift > maxVarintShift) {
+                    stage = STAGE_ERROR;
+                }
+                continue;
+            }
+            shift = 0;
+            if (++field == 3 && !finishControl()) {
+                stage = STAGE_ERROR;
+            }
+        } else if (stage == STAGE_ADD) {
+            size_t count = min((size_t)addRemaining, min(length - used, sizeof(work)));
+            if (!reader((uint32_t)sourcePos, work, count, context)) {
+                stage = STAGE_ERROR;
+                break;
+            }
+            for (size_t i = 0; i < count; i++) {
+                work[i] += data[used + i];
+            }
+            if (!writer(work, count, context)) {
+                stage = STAGE_ERROR;
+                break;
+            }
+            used += count;
+            sourcePos += count;
+            written += count;
+            addRemaining -= count;
+            if (addRemaining == 0) {
+                stage = STAGE_COPY;
+                if (copyRemaining == 0) {
+                    finishRecord();
+                }
+            }
+        } else if (stage == STAGE_COPY) {
+            size_t count = min((size_t)copyRemaining, length - used);
+            if (!writer(data + used, count, context)) {
+                stage = STAGE_ERROR;
+                break;
+            }
+            used += count;
+            written += count;
+            copyRemaining -= count;
+            if (copyRemaining == 0) {
+                finishRecord();
+            }
+        } else {
+            break;  // Done or failed
+        }
+    }
+    return used;
+}
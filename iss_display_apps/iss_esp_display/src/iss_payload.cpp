@@ -0,0 +1,201 @@
+/*
+ * ISS Payload
+ * ===========
+ *
+ * Decoders for the BFF response body. See iss_payload.h.
+ */
+
+#include "iss_payload.h"
+#include <ArduinoJson.h>
+#include "iss_cbor.h"
+
+// JSON document: the current location (1.5 KB) plus each upcoming one and
+// the base64 ground track
+static const size_t documentSize = 1536 + (FETCH_BATCH_SIZE - 1) * 768 +
+                                   HISTORY_MAX_BYTES * 4 / 3 + 16;
+
+static StaticJsonDocument<documentSize> doc;  // Too big for the task stack with a full batch
+
+/**
+ * Reads a coordinate that may be sent as a number or as a string
+ * @param value JSON value
+ * @param out Receives the coordinate
+ * @return False if the value is missing or not a coordinate
+ */
+static bool readCoordinate(JsonVariantConst value, float& out) {
+    if (value.is<float>()) {
+        out = value.as<float>();
+        return true;
+    }
+    const char* text = value.as<const char*>();
+    char* end = NULL;
+    if (text != NULL) {
+        out = strtof(text, &end);
+    }
+    return end != NULL && end != text;
+}
+
+bool payloadParseJson(Stream& body, ISSData& result) {
+    StaticJsonDocument<384> filter;
+    filter["fun_fact"] = true;
+    filter["location_details"] = true;
+    filter["timestamp"] = true;
+    filter["latitude"] = true;
+    filter["longitude"] = true;
+    filter["tle_line1"] = true;
+    filter["tle_line2"] = true;
+    filter["upcoming"][0]["timestamp_unix"] = true;  // Applies to every element
+    filter["upcoming"][0]["latitude"] = true;
+    filter["upcoming"][0]["longitude"] = true;
+    filter["upcoming"][0]["location"] = true;
+    filter["upcoming"][0]["fun_fact"] = true;
+    filter["track"] = true;
+
+    DeserializationError error = deserializeJson(doc, body, DeserializationOption::Filter(filter));
+    if (error) {
+        Serial.print("JSON parse failed: ");
+        Serial.println(error.c_str());
+        return false;
+    }
+
+    strlcpy(result.funFact, doc["fun_fact"] | "", sizeof(result.funFact));
+    strlcpy(result.locationDetails, doc["location_details"] | "", sizeof(result.locationDetails));
+    strlcpy(result.timestamp, doc["timestamp"] | "", sizeof(result.timestamp));
+    result.hasPosition = readCoordinate(doc["latitude"], result.latitude) &&
+                         readCoordinate(doc["longitude"], result.longitude);
+    strlcpy(result.tleLine1, doc["tle_line1"] | "", sizeof(result.tleLine1));
+    strlcpy(result.tleLine2, doc["tle_line2"] | "", sizeof(result.tleLine2));
+    result.upcomingCount = 0;
+    for (JsonObjectConst item : doc["upcoming"].as<JsonArrayConst>()) {
+        if (result.upcomingCount >= FETCH_BATCH_SIZE - 1) {
+            break;
+        }
+        ISSUpcoming& next = result.upcoming[result.upcomingCount];
+        next.at = item["timestamp_unix"] | 0L;
+        if (next.at == 0) {
+            break;  // Cannot be scheduled, nor anything after it
+        }
+        next.hasPosition = readCoordinate(item["latitude"], next.latitude) &&
+                           readCoordinate(item["longitude"], next.longitude);
+        strlcpy(next.locationDetails, item["location"] | "", sizeof(next.locationDetails));
+        strlcpy(next.funFact, item["fun_fact"] | "", sizeof(next.funFact));
+        result.upcomingCount++;
+    }
+
+    // Ground track, base64 in JSON
+    uint8_t track[HISTORY_MAX_BYTES];
+    size_t trackLength = historyDecodeBase64(doc["track"] | "", track, sizeof(track));
+    historyDecode(track, trackLength, result.track);
+
+    Serial.printf("JSON document %u/%u bytes\n",
+                  (unsigned)doc.memoryUsage(), (unsigned)doc.capacity());
+    return true;
+}
+
+/**
+ * Decodes one element of the CBOR "upcoming" array
+ * @return False if it is not a usable location
+ */
+static bool decodeCborUpcoming(CborReader& cbor, ISSUpcoming& item) {
+    size_t fields;
+    if (!cbor.readMap(fields)) {
+        return false;
+    }
+    int64_t at = 0;
+    bool hasLatitude = false;
+    bool hasLongitude = false;
+    item.locationDetails[0] = '\0';
+    item.funFact[0] = '\0';
+    for (size_t i = 0; i < fields && !cbor.failed(); i++) {
+        char key[24];
+        if (!cbor.readText(key, sizeof(key))) {
+            cbor.skip();
+        } else if (strcmp(key, "timestamp_unix") == 0) {
+            cbor.readInt(at);
+        } else if (strcmp(key, "latitude") == 0) {
+            hasLatitude = cbor.readFloat(item.latitude);
+        } else if (strcmp(key, "longitude") == 0) {
+            hasLongitude = cbor.readFloat(item.longitude);
+        } else if (strcmp(key, "location") == 0) {
+            cbor.readText(item.locationDetails, sizeof(item.locationDetails));
+        } else if (strcmp(key, "fun_fact") == 0) {
+            cbor.readText(item.funFact, sizeof(item.funFact));
+        } else {
+            cbor.skip();
+        }
+    }
+    item.at = (time_t)at;
+    item.hasPosition = hasLatitude && hasLongitude;
+    return !cbor.failed() && item.at != 0;
+}
+
+bool payloadParseCbor(Stream& body, ISSData& result) {
+    CborReader cbor(body);
+    size_t fields;
+    if (!cbor.readMap(fields)) {
+        Serial.println("CBOR body is not a map");
+        return false;
+    }
+
+    bool hasLatitude = false;
+    bool hasLongitude = false;
+    result.funFact[0] = '\0';
+    result.locationDetails[0] = '\0';
+    result.timestamp[0] = '\0';
+    result.tleLine1[0] = '\0';
+    result.tleLine2[0] = '\0';
+    result.upcomingCount = 0;
+    result.track.count = 0;
+    for (size_t i = 0; i < fields && !cbor.failed(); i++) {
+        char key[24];
+        if (!cbor.readText(key, sizeof(key))) {
+            cbor.skip();
+        } else if (strcmp(key, "fun_fact") == 0) {
+            cbor.readText(result.funFact, sizeof(result.funFact));
+        } else if (strcmp(key, "location_details") == 0) {
+            cbor.readText(result.locationDetails, sizeof(result.locationDetails));
+        } else if (strcmp(key, "timestamp") == 0) {
+            cbor.readText(result.timestamp, sizeof(result.timestamp));
+        } else if (strcmp(key, "latitude") == 0) {
+            hasLatitude = cbor.readFloat(result.latitude);
+        } else if (strcmp(key, "longitude") == 0) {
+            hasLongitude = cbor.readFloat(result.longitude);
+        } else if (strcmp(key, "tle_line1") == 0) {
+            cbor.readText(result.tleLine1, sizeof(result.tleLine1));
+        } else if (strcmp(key, "tle_line2") == 0) {
+            cbor.readText(result.tleLine2, sizeof(result.tleLine2));
+        } else if (strcmp(key, "track") == 0) {
+            uint8_t track[HISTORY_MAX_BYTES];
+            size_t trackLength;
+            if (cbor.readByteString(track, sizeof(track), trackLength)) {
+                historyDecode(track, trackLength, result.track);
+            }
+        } else if (strcmp(key, "upcoming") == 0) {
+            size_t count;
+            if (cbor.readArray(count)) {
+                // Keep what fits and plays back in order, skip the rest
+                bool usable = true;
+                for (size_t j = 0; j < count && !cbor.failed(); j++) {
+                    if (!usable || result.upcomingCount >= FETCH_BATCH_SIZE - 1) {
+                        cbor.skip();
+                    } else if (decodeCborUpcoming(cbor, result.upcoming[result.upcomingCount])) {
+                        result.upcomingCount++;
+                    } else {
+                        usable = false;
+                    }
+                }
+            }
+        } else {
+            cbor.skip();
+        }
+    }
+    result.hasPosition = hasLatitude && hasLongitude;
+
+    if (cbor.failed()) {
+        Serial.println("CBOR decode failed");
+        result.upcomingCount = 0;
+        result.track.count = 0;
+        return false;
+    }
+    return true;
+}
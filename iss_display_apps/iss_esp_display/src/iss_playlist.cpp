@@ -0,0 +1,257 @@
+/*
+ * ISS Display Playlist
+ * ====================
+ *
+ * Fixed ring of items with per-slot sequence counters. See iss_playlist.h
+ * for the protocol.
+ */
+
+#include "iss_playlist.h"
+#include <atomic>
+
+// How often the consumer looks for expired items while nothing changes (ms)
+static const unsigned long expiryCheckInterval = 1000;
+
+// Bookkeeping of an item, read by the consumer under the slot's sequence
+struct PlaylistInfo {
+    bool used;
+    int key;
+    uint8_t priority;
+    time_t expiresAt;       // 0 if the item does not expire
+    uint32_t stamp;         // Commit order, to show new items in turn
+    bool showNow;           // Committed as new content, not to wait its turn
+};
+
+struct PlaylistSlot {
+    std::atomic<uint32_t> sequence;  // Odd while the producer is writing
+    PlaylistInfo info;
+    DisplaySnapshot data;
+};
+
+static PlaylistSlot slots[PLAYLIST_CAPACITY];
+static std::atomic<uint32_t> commitCount(0);     // Incremented on every change
+
+// Producer side only
+static int writingSlot = -1;
+static int ringHead = 0;                         // Where the search for a free slot starts
+
+// Consumer side only
+static uint32_t seenCommits = 0;
+static uint32_t seenSequence[PLAYLIST_CAPACITY];
+static int shownSlot = -1;
+static unsigned long lastExpiryCheck = 0;
+
+/**
+ * @return True if the item is still to be shown at the given time
+ */
+static bool isLive(const PlaylistInfo& info, time_t now) {
+    return info.used && (info.expiresAt == 0 || now < info.expiresAt);
+}
+
+/**
+ * @return True if the item takes part in the rotation at priority top
+ */
+static bool inRotation(const PlaylistInfo& info, time_t now, uint8_t top) {
+    return isLive(info, now) && info.priority == top;
+}
+
+/**
+ * Producer: the slot for a key, or one it may take over
+ * @return Slot index, -1 if every slot holds an item that outranks it
+ */
+static int claimSlot(int key, uint8_t priority) {
+    for (int i = 0; i < PLAYLIST_CAPACITY; i++) {
+        if (slots[i].info.used && slots[i].info.key == key) {
+            return i;
+        }
+    }
+
+    // Free or expired first, then the oldest of a lower priority
+    time_t now = time(nullptr);
+    int victim = -1;
+    for (int step = 0; step < PLAYLIST_CAPACITY; step++) {
+        int i = (ringHead + step) % PLAYLIST_CAPACITY;
+        const PlaylistInfo& info = slots[i].info;
+        if (!isLive(info, now)) {
+            victim = i;
+            break;
+        }
+        if (info.priority < priority &&
+            (victim < 0 || info.stamp < slots[victim].info.stamp)) {
+            victim = i;
+        }
+    }
+    if (victim >= 0) {
+        ringHead = (victim + 1) % PLAYLIST_CAPACITY;
+    }
+    return victim;
+}
+
+DisplaySnapshot* playlistBeginWrite(int key, uint8_t priority, time_t expiresAt) {
+    int index = claimSlot(key, priority);
+    if (index < 0) {
+        return NULL;
+    }
+    PlaylistSlot& slot = slots[index];
+    slot.sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.info.used = true;
+    slot.info.key = key;
+    slot.info.priority = priority;
+    slot.info.expiresAt = expiresAt;
+    writingSlot = index;
+    return &slot.data;
+}
+
+void playlistCommit(bool showNow) {
+    if (writingSlot < 0) {
+        return;
+    }
+    PlaylistSlot& slot = slots[writingSlot];
+    slot.info.stamp = commitCount.load(std::memory_order_relaxed) + 1;
+    slot.info.showNow = showNow;
+    slot.sequence.fetch_add(1, std::memory_order_release);
+    commitCount.fetch_add(1, std::memory_order_release);
+    writingSlot = -1;
+}
+
+void playlistRemove(int key) {
+    for (int i = 0; i < PLAYLIST_CAPACITY; i++) {
+        PlaylistSlot& slot = slots[i];
+        if (!slot.info.used || slot.info.key != key) {
+            continue;
+        }
+        slot.sequence.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.info.used = false;
+        slot.sequence.fetch_add(1, std::memory_order_release);
+        commitCount.fetch_add(1, std::memory_order_release);
+        return;
+    }
+}
+
+void playlistPublishLines(int key, uint8_t priority,
+                          const char* line1, const char* line2,
+                          uint8_t red, uint8_t green, uint8_t blue,
+                          bool redrawNow) {
+    DisplaySnapshot* item = playlistBeginWrite(key, priority, 0);
+    if (item == NULL) {
+        return;
+    }
+    strlcpy(item->line1, line1, sizeof(item->line1));
+    strlcpy(item->line2, line2 ? line2 : "", sizeof(item->line2));
+    item->positionColumn = -1;
+    item->orbit.valid = false;
+    item->red = red;
+    item->green = green;
+    item->blue = blue;
+    item->hasLines = true;
+    item->redrawNow = redrawNow;
+    playlistCommit(true);
+}
+
+/**
+ * Consumer: copies a slot's bookkeeping and, if out is given, its content
+ * Never waits for the producer: a slot it is writing is simply busy
+ * @param sequence Receives the sequence the copy is consistent with
+ * @return False if the producer was writing the slot; try again on a later poll
+ */
+static bool readSlot(int index, PlaylistInfo& info, DisplaySnapshot* out, uint32_t& sequence) {
+    PlaylistSlot& slot = slots[index];
+    uint32_t before = slot.sequence.load(std::memory_order_acquire);
+    if (before & 1) {
+        return false;
+    }
+    memcpy(&info, &slot.info, sizeof(info));
+    if (out != NULL) {
+        memcpy(out, &slot.data, sizeof(*out));
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != before) {
+        return false;  // Rewritten during the copy
+    }
+    sequence = before;
+    return true;
+}
+
+/**
+ * Consumer: notes the changes of this poll as seen
+ */
+static void markSeen(uint32_t commits, const uint32_t* sequence) {
+    memcpy(seenSequence, sequence, sizeof(seenSequence));
+    seenCommits = commits;
+}
+
+bool playlistPoll(DisplaySnapshot& out, bool advance) {
+    // Fast path: nothing new, nothing due
+    uint32_t commits = commitCount.load(std::memory_order_acquire);
+    unsigned long nowMs = millis();
+    bool expiryDue = nowMs - lastExpiryCheck >= expiryCheckInterval;
+    if (commits == seenCommits && !advance && !expiryDue) {
+        return false;
+    }
+
+    // Bookkeeping of every slot, and the highest priority still live. A slot
+    // being written leaves everything as it was until a later poll, so the
+    // display keeps going instead of waiting for the producer
+    time_t now = time(nullptr);
+    PlaylistInfo info[PLAYLIST_CAPACITY];
+    uint32_t sequence[PLAYLIST_CAPACITY];
+    uint8_t top = 0;
+    for (int i = 0; i < PLAYLIST_CAPACITY; i++) {
+        if (!readSlot(i, info[i], NULL, sequence[i])) {
+            return false;
+        }
+        if (isLive(info[i], now) && info[i].priority > top) {
+            top = info[i].priority;
+        }
+    }
+    lastExpiryCheck = nowMs;
+    bool changed = commits != seenCommits;
+    if (top == 0) {
+        markSeen(commits, sequence);
+        return false;  // Keep what is shown
+    }
+
+    // New content, or the item shown rewritten, comes first in commit order
+    int next = -1;
+    if (changed) {
+        for (int i = 0; i < PLAYLIST_CAPACITY; i++) {
+            bool jump = sequence[i] != seenSequence[i] && (info[i].showNow || i == shownSlot);
+            if (jump && inRotation(info[i], now, top) &&
+                (next < 0 || info[i].stamp < info[next].stamp)) {
+                next = i;
+            }
+        }
+    }
+
+    // Otherwise the next in ring order once the item shown is done or gone
+    bool shownLive = shownSlot >= 0 && inRotation(info[shownSlot], now, top);
+    if (next < 0 && (advance || !shownLive)) {
+        for (int step = 1; step <= PLAYLIST_CAPACITY; step++) {
+            int i = (shownSlot + step + PLAYLIST_CAPACITY) % PLAYLIST_CAPACITY;
+            if (inRotation(info[i], now, top)) {
+                next = i;
+                break;
+            }
+        }
+        if (next == shownSlot && shownLive) {
+            markSeen(commits, sequence);
+            return false;  // The only item; it keeps scrolling
+        }
+    }
+    if (next < 0) {
+        markSeen(commits, sequence);
+        return false;
+    }
+
+    PlaylistInfo nextInfo;
+    uint32_t nextSequence;
+    if (!readSlot(next, nextInfo, &out, nextSequence)) {
+        return false;  // Rewritten since the bookkeeping was read; next poll
+    }
+    markSeen(commits, sequence);
+    seenSequence[next] = nextSequence;
+    shownSlot = next;
+    return true;
+}
@@ -0,0 +1,65 @@
+/*
+ * ISS Poll Policy
+ * ===============
+ *
+ * Hint-driven poll timing with jittered backoff. See iss_poll.h.
+ */
+
+#include "iss_poll.h"
+
+// Poll timing (in milliseconds)
+static const unsigned long defaultPollInterval = 300000;     // No hint: the 5 minute store cadence
+static const unsigned long unchangedPollInterval = 60000;    // No hint after a 304
+static const unsigned long minPollInterval = 15000;          // Never poll faster than this
+static const unsigned long maxPollInterval = 3600000;        // Never wait longer than an hour (a batch covers 30 minutes)
+static const unsigned long pollJitter = 5000;                // Spread polls that share a hint
+static const unsigned long failureBackoffBase = 30000;       // First retry after a failed update
+static const unsigned long failureBackoffMax = 900000;
+static const unsigned long pushFallbackInterval = 1800000;   // Poll anyway twice an hour
+
+static int consecutiveFailures = 0;
+
+/**
+ * @return A server hint in milliseconds, capped so it cannot overflow
+ */
+static unsigned long hintDelay(long hintSeconds) {
+    return min((unsigned long)hintSeconds, maxPollInterval / 1000) * 1000UL;
+}
+
+/**
+ * Adds jitter and clamps a delay to the poll bounds
+ */
+static unsigned long finishDelay(unsigned long delayMs) {
+    delayMs += random(pollJitter + 1);
+    return constrain(delayMs, minPollInterval, maxPollInterval);
+}
+
+unsigned long pollDelayAfterUpdate(bool changed, long hintSeconds) {
+    consecutiveFailures = 0;
+    if (hintSeconds >= 0) {
+        return finishDelay(hintDelay(hintSeconds));
+    }
+    return finishDelay(changed ? defaultPollInterval : unchangedPollInterval);
+}
+
+unsigned long pollDelayAfterFailure(long hintSeconds) {
+    consecutiveFailures++;
+
+    // Equal jitter: half the backoff is fixed, the other half random
+    unsigned long backoff = failureBackoffBase << min(consecutiveFailures - 1, 5);
+    backoff = min(backoff, failureBackoffMax);
+    unsigned long delayMs = backoff / 2 + random(backoff / 2 + 1);
+
+    if (hintSeconds >= 0) {
+        delayMs = max(delayMs, hintDelay(hintSeconds));
+    }
+    return constrain(delayMs, minPollInterval, maxPollInterval);
+}
+
+unsigned long pollDelayWithPush(unsigned long delayMs) {
+    return max(delayMs, pushFallbackInterval);
+}
+
+int pollConsecutiveFailures() {
+    return consecutiveFailures;
+}
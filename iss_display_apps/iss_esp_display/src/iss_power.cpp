@@ -0,0 +1,156 @@
+/*
+ * ISS Power Modes
+ * ===============
+ *
+ * CPU clock, WiFi power save, light sleep and residency accounting.
+ * See iss_power.h.
+ */
+
+#include "iss_power.h"
+#include <WiFi.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+
+// CPU clock outside POWER_MODE_ACTIVE; WiFi needs at least 80 MHz
+static const uint32_t lowPowerCpuMhz = 80;
+
+// Waking from light sleep costs around a millisecond, so shorter waits stay awake
+static const unsigned long minLightSleepMs = 20;
+
+// Typical ESP32 module currents (datasheet figures, mA) for the estimate.
+// Board level only: the LCD backlight and regulator losses come on top
+static const float cpuActiveCurrent240 = 50.0f;   // Both cores at 240 MHz
+static const float cpuActiveCurrent80 = 25.0f;    // Both cores at 80 MHz
+static const float radioMinModemCurrent = 40.0f;  // Associated, SDK default power save
+static const float radioMaxModemCurrent = 15.0f;  // Associated, sleeping across DTIM beacons
+static const float lightSleepCurrent = 0.8f;
+
+// CPU residency since boot, in microseconds (display loop only)
+static int64_t lastChange = 0;
+static int64_t awakeTime = 0;
+static int64_t sleepTime = 0;
+static uint32_t lightSleeps = 0;
+
+// Radio residency in milliseconds (written by the network task only; 32-bit
+// so the display loop can read it without tearing)
+static volatile bool radioAsleep = false;
+static volatile uint32_t radioOnMs = 0;
+static volatile uint32_t radioChangedAt = 0;
+
+/**
+ * Adds the time since the last change to the awake total
+ */
+static void accountAwake() {
+    int64_t now = esp_timer_get_time();
+    awakeTime += now - lastChange;
+    lastChange = now;
+}
+
+/**
+ * Drives the optional marker pin
+ */
+static void setMarker(bool awake) {
+#ifdef POWER_MARKER_PIN
+    digitalWrite(POWER_MARKER_PIN, awake ? HIGH : LOW);
+#else
+    (void)awake;
+#endif
+}
+
+void powerBegin() {
+    lastChange = esp_timer_get_time();
+    radioChangedAt = millis();
+#ifdef POWER_MARKER_PIN
+    pinMode(POWER_MARKER_PIN, OUTPUT);
+    setMarker(true);
+#endif
+#if ISS_POWER_MODE != POWER_MODE_ACTIVE
+    setCpuFrequencyMhz(lowPowerCpuMhz);
+    WiFi.setSleep(WIFI_PS_MAX_MODEM);  // Applied when the station starts
+#endif
+}
+
+bool powerLightSleep(unsigned long ms) {
+#if ISS_POWER_MODE == POWER_MODE_LIGHT_SLEEP
+    if (!radioAsleep || ms < minLightSleepMs) {
+        return false;
+    }
+    Serial.flush();  // The UART clock stops during light sleep
+    accountAwake();
+    setMarker(false);
+
+    // Stalls the other core too; the RTC timer brings both back
+    esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000);
+    esp_light_sleep_start();
+
+    int64_t now = esp_timer_get_time();
+    sleepTime += now - lastChange;
+    lastChange = now;
+    lightSleeps++;
+    setMarker(true);
+    return true;
+#else
+    (void)ms;
+    return false;
+#endif
+}
+
+bool powerRadioCanSleep() {
+    return ISS_POWER_MODE == POWER_MODE_LIGHT_SLEEP;
+}
+
+void powerRadioSleep() {
+    if (radioAsleep) {
+        return;
+    }
+    WiFi.disconnect(true);  // Also switches the radio off
+    radioOnMs = radioOnMs + (millis() - radioChangedAt);
+    radioChangedAt = millis();
+    radioAsleep = true;
+}
+
+void powerRadioWake() {
+    if (!radioAsleep) {
+        return;
+    }
+    radioChangedAt = millis();
+    radioAsleep = false;
+}
+
+bool powerRadioAsleep() {
+    return radioAsleep;
+}
+
+__attribute__((weak)) float powerMeasuredCurrent() {
+    return -1;
+}
+
+void powerLogStats() {
+    accountAwake();
+    int64_t total = awakeTime + sleepTime;
+    if (total <= 0) {
+        return;
+    }
+    float awakeShare = (float)awakeTime / total;
+    float sleepShare = (float)sleepTime / total;
+    uint32_t radioMs = radioOnMs;
+    if (!radioAsleep) {
+        radioMs += millis() - radioChangedAt;
+    }
+    float radioShare = min(radioMs * 1000.0f / total, 1.0f);
+
+    float cpuCurrent = ISS_POWER_MODE == POWER_MODE_ACTIVE ? cpuActiveCurrent240 : cpuActiveCurrent80;
+    float radioCurrent = ISS_POWER_MODE == POWER_MODE_ACTIVE ? radioMinModemCurrent : radioMaxModemCurrent;
+    float estimate = awakeShare * cpuCurrent + sleepShare * lightSleepCurrent +
+                     radioShare * radioCurrent;
+
+    static const char* modeNames[] = {"active", "modem-sleep", "light-sleep"};
+    Serial.printf("Power: mode %s, awake %.1f%%, radio %.1f%%, %u light sleeps, est %.1f mA",
+                  modeNames[ISS_POWER_MODE], awakeShare * 100, radioShare * 100,
+                  (unsigned)lightSleeps, estimate);
+    float measured = powerMeasuredCurrent();
+    if (measured >= 0) {
+        Serial.printf(", measured %.1f mA", measured);
+    }
+    Serial.println();
+}
@@ -0,0 +1,182 @@
+/*
+ * ISS Profiler
+ * ============
+ *
+ * Per-region cycle statistics and folded stacks. See iss_profile.h.
+ */
+
+#include "iss_profile.h"
+#include <algorithm>
+
+#if ISS_PROFILE
+
+// Distinct stacks kept per core for the folded output
+static const int maxPaths = 32;
+
+// Bits per region in a path key; region + 1, so 0 marks an empty level
+static const int pathBits = 4;
+static_assert(PROFILE_REGION_COUNT < (1 << pathBits), "Regions must fit a path level");
+static_assert(PROFILE_MAX_DEPTH * pathBits <= 16, "Paths must fit their key");
+
+struct RegionStats {
+    uint32_t calls;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+    uint32_t ring[PROFILE_RING_SIZE];  // Latest samples
+    uint32_t ringNext;
+};
+
+struct PathStats {
+    uint16_t key;                      // Regions from the outermost, 0 if unused
+    uint32_t calls;
+    uint64_t selfCycles;
+};
+
+// Open regions of one core; only that core touches it
+struct CoreStack {
+    int depth;                         // May exceed PROFILE_MAX_DEPTH
+    uint16_t key;                      // Path of the open regions
+    uint32_t childCycles[PROFILE_MAX_DEPTH];
+    PathStats paths[maxPaths];
+};
+
+static const char* regionNames[PROFILE_REGION_COUNT] = {
+    "frame", "scroll", "lcd_write", "snapshot", "position",
+    "fetch_step", "parse", "push_step", "publish", "transliterate", "ota_step"
+};
+
+static RegionStats regions[PROFILE_REGION_COUNT];
+static CoreStack cores[portNUM_PROCESSORS];
+
+void profileEnter(ProfileRegion region) {
+    CoreStack& core = cores[xPortGetCoreID()];
+    if (core.depth < PROFILE_MAX_DEPTH) {
+        core.key = (core.key << pathBits) | (region + 1);
+        core.childCycles[core.depth] = 0;
+    }
+    core.depth++;
+}
+
+/**
+ * Adds self time to a stack of one core
+ */
+static void recordPath(CoreStack& core, uint16_t key, uint32_t selfCycles) {
+    for (int i = 0; i < maxPaths; i++) {
+        PathStats& path = core.paths[i];
+        if (path.key == 0) {
+            path.key = key;
+        } else if (path.key != key) {
+            continue;
+        }
+        path.calls++;
+        path.selfCycles += selfCycles;
+        return;
+    }
+    // Table full: the stack is left out of the folded output only
+}
+
+void profileExit(ProfileRegion region, uint32_t cycles) {
+    RegionStats& stats = regions[region];
+    if (stats.calls == 0 || cycles < stats.minCycles) {
+        stats.minCycles = cycles;
+    }
+    if (cycles > stats.maxCycles) {
+        stats.maxCycles = cycles;
+    }
+    stats.totalCycles += cycles;
+    stats.ring[stats.ringNext] = cycles;
+    stats.ringNext = (stats.ringNext + 1) % PROFILE_RING_SIZE;
+    stats.calls++;
+
+    CoreStack& core = cores[xPortGetCoreID()];
+    if (core.depth == 0) {
+        return;  // Unbalanced exit
+    }
+    core.depth--;
+    if (core.depth >= PROFILE_MAX_DEPTH) {
+        return;  // Too deep for a path; its time counts as the parent's own
+    }
+    uint32_t childCycles = core.childCycles[core.depth];
+    recordPath(core, core.key, cycles > childCycles ? cycles - childCycles : 0);
+    core.key >>= pathBits;
+    if (core.depth > 0) {
+        core.childCycles[core.depth - 1] += cycles;
+    }
+}
+
+/**
+ * @return The 99th percentile of the samples in a region's ring
+ */
+static uint32_t ringP99(const RegionStats& stats) {
+    uint32_t count = min(stats.calls, (uint32_t)PROFILE_RING_SIZE);
+    if (count == 0) {
+        return 0;
+    }
+    uint32_t sorted[PROFILE_RING_SIZE];
+    memcpy(sorted, stats.ring, count * sizeof(sorted[0]));
+    uint32_t rank = (count * 99 + 99) / 100 - 1;  // Nearest rank
+    std::nth_element(sorted, sorted + rank, sorted + count);
+    return sorted[rank];
+}
+
+/**
+ * Prints one stack as "coreN;outer;inner <self cycles>"
+ */
+static void printPath(int coreId, const PathStats& path) {
+    int levels = 0;
+    uint8_t stack[PROFILE_MAX_DEPTH];
+    for (uint16_t key = path.key; key != 0 && levels < PROFILE_MAX_DEPTH; key >>= pathBits) {
+        stack[levels++] = (key & ((1 << pathBits) - 1)) - 1;
+    }
+    Serial.printf("core%d", coreId);
+    while (levels > 0) {
+        Serial.printf(";%s", regionNames[stack[--levels]]);
+    }
+    Serial.printf(" %llu\n", (unsigned long long)path.selfCycles);
+}
+
+void profileDump() {
+    float cyclesPerUs = ESP.getCpuFreqMHz();
+    Serial.printf("Profile at %u MHz (us)\n", (unsigned)cyclesPerUs);
+    Serial.println("region             calls      min     mean      max      p99");
+    for (int i = 0; i < PROFILE_REGION_COUNT; i++) {
+        const RegionStats& stats = regions[i];
+        if (stats.calls == 0) {
+            continue;
+        }
+        Serial.printf("%-14s %9u %8.1f %8.1f %8.1f %8.1f\n", regionNames[i], (unsigned)stats.calls,
+                      stats.minCycles / cyclesPerUs,
+                      stats.totalCycles / cyclesPerUs / stats.calls,
+                      stats.maxCycles / cyclesPerUs, ringP99(stats) / cyclesPerUs);
+    }
+
+    Serial.println("# Folded stacks, self cycles (flamegraph.pl)");
+    for (int coreId = 0; coreId < portNUM_PROCESSORS; coreId++) {
+        for (int i = 0; i < maxPaths && cores[coreId].paths[i].key != 0; i++) {
+            printPath(coreId, cores[coreId].paths[i]);
+        }
+    }
+}
+
+void profileReset() {
+    memset(regions, 0, sizeof(regions));
+    for (int coreId = 0; coreId < portNUM_PROCESSORS; coreId++) {
+        // The open stack stays, so closing its regions still balances
+        memset(cores[coreId].paths, 0, sizeof(cores[coreId].paths));
+    }
+    Serial.println("Profile reset");
+}
+
+void profilePoll() {
+    while (Serial.available() > 0) {
+        int command = Serial.read();
+        if (command == 'p') {
+            profileDump();
+        } else if (command == 'r') {
+            profileReset();
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,317 @@
+/*
+ * ISS Push Channel
+ * ================
+ *
+ * Step-driven server-sent event client for the BFF. See iss_push.h.
+ */
+
+#include "iss_push.h"
+#include <WiFi.h>
+#include "iss_tls.h"
+#include "iss_http.h"
+#include "iss_http_body.h"
+#include "iss_profile.h"
+
+// Connection timing (in milliseconds)
+static const unsigned long connectTimeout = 15000;     // Resolve to response headers
+static const unsigned long idleTimeout = 75000;        // Server heartbeats every 25 s
+static const unsigned long defaultRetryDelay = 10000;  // Until the server sends "retry:"
+static const unsigned long failureBackoffBase = 10000;
+static const unsigned long failureBackoffMax = 300000;
+static const unsigned long readWait = 500;             // Longest wait for a split chunk header
+static const size_t maxReadPerStep = 256;              // Bytes consumed per step
+
+// Connection states
+enum PushState {
+    PUSH_OFF,        // Disabled, or the server has no stream support
+    PUSH_WAIT,       // Waiting to (re)connect
+    PUSH_RESOLVE,
+    PUSH_CONNECT,
+    PUSH_TLS,
+    PUSH_HEADERS,    // Request sent, reading the response head
+    PUSH_STREAM      // Reading events
+};
+
+static IssTlsClient client;
+static HttpBodyStream body;
+static PushState state = PUSH_OFF;
+static bool streamUp = false;           // Announcements are arriving (or about to again)
+static unsigned long waitStart = 0;
+static unsigned long waitDelay = 0;
+static unsigned long retryDelay = defaultRetryDelay;
+static unsigned long attemptStart = 0;
+static unsigned long lastByteAt = 0;
+static int consecutiveFailures = 0;
+
+// Response head and event parsing state
+static HttpResponseHead head;
+static HttpLineBuffer eventLine;
+static bool eventStream = false;        // Content-Type: text/event-stream
+static char eventName[16] = "";
+static char eventId[40] = "";
+static char lastTimestamp[40] = "";
+
+// Counters since boot, for pushLogStats()
+static uint32_t connections = 0;
+static uint32_t announcements = 0;
+static uint32_t failures = 0;
+
+/**
+ * Waits before the next connection attempt
+ */
+static void waitFor(unsigned long delayMs) {
+    client.stop();
+    waitStart = millis();
+    waitDelay = delayMs;
+    state = PUSH_WAIT;
+}
+
+/**
+ * Drops the connection after a failure and backs off
+ * @param reason Short description for the log
+ * @return PUSH_LOST if the stream was up until now
+ */
+static PushEvent failConnection(const char* reason) {
+    failures++;
+    consecutiveFailures++;
+
+    // Equal jitter, as in iss_poll
+    unsigned long backoff = failureBackoffBase << min(consecutiveFailures - 1, 5);
+    backoff = min(backoff, failureBackoffMax);
+    unsigned long delayMs = backoff / 2 + random(backoff / 2 + 1);
+    Serial.printf("Push stream %s, reconnecting in %lu s\n", reason, delayMs / 1000);
+    waitFor(delayMs);
+
+    if (streamUp) {
+        streamUp = false;
+        return PUSH_LOST;
+    }
+    return PUSH_NONE;
+}
+
+/**
+ * Resolves the host and starts the TCP connection
+ */
+static PushEvent stepResolve() {
+    attemptStart = millis();
+    HttpConnectResult ret = httpBeginConnect(client, bffStreamHost);
+    if (ret != HTTP_CONNECTING) {
+        return failConnection(ret == HTTP_RESOLVE_FAILED ? "could not resolve" : "could not connect");
+    }
+    state = PUSH_CONNECT;
+    return PUSH_NONE;
+}
+
+/**
+ * Handles one header line that iss_http does not
+ */
+static void processHeaderLine(const char* line) {
+    const char* value = httpHeaderValue(line, "Content-Type");
+    if (value) {
+        eventStream = strncasecmp(value, "text/event-stream", 17) == 0;
+    }
+}
+
+/**
+ * Sends the stream request, resuming from the last announced location
+ */
+static PushEvent sendRequest() {
+    char headers[128];
+    int length = snprintf(headers, sizeof(headers),
+        "Accept: text/event-stream\r\n"
+        "Cache-Control: no-cache\r\n");
+    if (lastTimestamp[0] != '\0') {
+        snprintf(headers + length, sizeof(headers) - length,
+                 "Last-Event-ID: %s\r\n", lastTimestamp);
+    }
+
+    if (!httpSendGet(client, bffStreamHost, "stream=1", headers)) {
+        return failConnection("request failed");
+    }
+    head.begin(processHeaderLine);
+    eventStream = false;
+    state = PUSH_HEADERS;
+    return PUSH_NONE;
+}
+
+/**
+ * Reads whatever part of the response head has arrived
+ */
+static PushEvent stepHeaders() {
+    if (head.read(client, maxReadPerStep)) {
+        if (head.status() != 200) {
+            char reason[24];
+            snprintf(reason, sizeof(reason), "got HTTP %d", head.status());
+            return failConnection(reason);
+        }
+        if (!eventStream) {
+            Serial.println("BFF has no push stream, polling only");
+            client.stop();
+            state = PUSH_OFF;
+            if (streamUp) {
+                streamUp = false;
+                return PUSH_LOST;
+            }
+            return PUSH_NONE;
+        }
+
+        // The stream never ends on its own, so it is chunked or close-delimited
+        body.begin(client, -1, head.chunked(), millis() + readWait);
+        eventLine.reset();
+        eventName[0] = '\0';
+        eventId[0] = '\0';
+        connections++;
+        consecutiveFailures = 0;
+        lastByteAt = millis();
+        streamUp = true;
+        state = PUSH_STREAM;
+        Serial.println("Push stream connected");
+        return PUSH_NONE;
+    }
+
+    if (!client.available() && !client.connected()) {
+        return failConnection("closed before the response");
+    }
+    return PUSH_NONE;
+}
+
+/**
+ * Handles one complete event stream line
+ * @return PUSH_LOCATION when a blank line ends an announcement of a new location
+ */
+static PushEvent processEventLine(const char* line) {
+    if (line[0] == '\0') {
+        // Blank line dispatches the event
+        PushEvent event = PUSH_NONE;
+        if (strcmp(eventName, "location") == 0 && eventId[0] != '\0' &&
+            strcmp(eventId, lastTimestamp) != 0) {
+            strlcpy(lastTimestamp, eventId, sizeof(lastTimestamp));
+            announcements++;
+            event = PUSH_LOCATION;
+        }
+        eventName[0] = '\0';
+        return event;
+    }
+    if (line[0] == ':') {
+        return PUSH_NONE;  // Heartbeat comment
+    }
+
+    const char* value = httpHeaderValue(line, "event");
+    if (value) {
+        strlcpy(eventName, value, sizeof(eventName));
+        return PUSH_NONE;
+    }
+    value = httpHeaderValue(line, "id");
+    if (value) {
+        strlcpy(eventId, value, sizeof(eventId));
+        return PUSH_NONE;
+    }
+    value = httpHeaderValue(line, "retry");
+    if (value && isdigit((unsigned char)*value)) {
+        retryDelay = constrain((unsigned long)atol(value), 1000UL, failureBackoffMax);
+    }
+    // The data line repeats the position for other clients; the fetch brings it
+    return PUSH_NONE;
+}
+
+/**
+ * Reads the events that have arrived, without waiting for more
+ */
+static PushEvent stepStream() {
+    PushEvent event = PUSH_NONE;
+    size_t consumed = 0;
+    body.setDeadline(millis() + readWait);
+    while ((body.available() > 0 || client.available() > 0) && consumed < maxReadPerStep) {
+        int c = body.read();
+        if (c < 0) {
+            break;
+        }
+        consumed++;
+        if (eventLine.add((char)c) && processEventLine(eventLine.line()) == PUSH_LOCATION) {
+            event = PUSH_LOCATION;
+        }
+    }
+    if (consumed > 0) {
+        lastByteAt = millis();
+    }
+
+    if (body.complete()) {
+        // The server ended the stream; resume after its retry delay
+        Serial.println("Push stream ended, reconnecting");
+        waitFor(retryDelay);
+    } else if (body.failed() || (!client.available() && !client.connected())) {
+        PushEvent lost = failConnection("dropped");
+        return event == PUSH_NONE ? lost : event;
+    } else if (millis() - lastByteAt >= idleTimeout) {
+        PushEvent lost = failConnection("went quiet");
+        return event == PUSH_NONE ? lost : event;
+    }
+    return event;
+}
+
+void pushBegin() {
+#if ISS_PUSH
+    if (state == PUSH_OFF) {
+        waitFor(0);
+    }
+#endif
+}
+
+PushEvent pushStep() {
+    if (state == PUSH_OFF) {
+        return PUSH_NONE;
+    }
+    PROFILE_SCOPE(PROFILE_PUSH_STEP);
+    if (state >= PUSH_CONNECT && state <= PUSH_HEADERS &&
+        millis() - attemptStart >= connectTimeout) {
+        return failConnection("timed out");
+    }
+
+    int ret;
+    switch (state) {
+        case PUSH_WAIT:
+            if (WiFi.status() == WL_CONNECTED && millis() - waitStart >= waitDelay) {
+                state = PUSH_RESOLVE;
+            }
+            return PUSH_NONE;
+        case PUSH_RESOLVE:
+            return stepResolve();
+        case PUSH_CONNECT:
+            ret = client.pollConnect();
+            if (ret < 0) {
+                return failConnection("could not connect");
+            }
+            if (ret > 0) {
+                state = PUSH_TLS;
+            }
+            return PUSH_NONE;
+        case PUSH_TLS:
+            ret = client.pollHandshake();
+            if (ret < 0) {
+                return failConnection("handshake failed");
+            }
+            return ret > 0 ? sendRequest() : PUSH_NONE;
+        case PUSH_HEADERS:
+            return stepHeaders();
+        case PUSH_STREAM:
+            return stepStream();
+        default:
+            return PUSH_NONE;
+    }
+}
+
+bool pushConnected() {
+    return streamUp;
+}
+
+const char* pushLastTimestamp() {
+    return lastTimestamp;
+}
+
+void pushLogStats() {
+#if ISS_PUSH
+    Serial.printf("Push: %s, %u connections, %u announcements, %u failures\n",
+                  streamUp ? "up" : "down", (unsigned)connections,
+                  (unsigned)announcements, (unsigned)failures);
+#endif
+}
@@ -0,0 +1,66 @@
+/*
+ * ISS Render Clock
+ * ================
+ *
+ * esp_timer frame ticks delivered as task notifications. See iss_render.h.
+ */
+
+#include "iss_render.h"
+#include <esp_timer.h>
+
+static TaskHandle_t displayTask = NULL;
+static uint32_t framesPending = 0;  // Written by the timer task, taken by the display loop
+
+#if ISS_RENDER_HZ
+static esp_timer_handle_t timer = NULL;
+
+/**
+ * Timer task callback: counts the frame and wakes the display loop
+ */
+static void onFrame(void* arg) {
+    __atomic_fetch_add(&framesPending, 1, __ATOMIC_RELAXED);
+    xTaskNotifyGive(displayTask);
+}
+#endif
+
+bool renderBegin() {
+#if ISS_RENDER_HZ
+    if (timer != NULL) {
+        return true;
+    }
+    displayTask = xTaskGetCurrentTaskHandle();
+    esp_timer_create_args_t args = {};
+    args.callback = onFrame;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "render";
+    if (esp_timer_create(&args, &timer) != ESP_OK ||
+        esp_timer_start_periodic(timer, RENDER_FRAME_US) != ESP_OK) {
+        Serial.println("Render timer failed, scrolling from the scheduler");
+        timer = NULL;
+        displayTask = NULL;
+        return false;
+    }
+    Serial.printf("Render clock at %d Hz\n", ISS_RENDER_HZ);
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint32_t renderElapsedUs() {
+#if ISS_RENDER_HZ
+    return __atomic_exchange_n(&framesPending, 0, __ATOMIC_RELAXED) * RENDER_FRAME_US;
+#else
+    return 0;
+#endif
+}
+
+void renderWait(unsigned long maxMs) {
+    if (displayTask == NULL) {
+        vTaskDelay(pdMS_TO_TICKS(maxMs));
+        return;
+    }
+    if (__atomic_load_n(&framesPending, __ATOMIC_RELAXED) == 0) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(maxMs));
+    }
+}
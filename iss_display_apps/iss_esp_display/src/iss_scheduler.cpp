@@ -0,0 +1,121 @@
+/*
+ * ISS Cooperative Scheduler
+ * =========================
+ *
+ * See iss_scheduler.h.
+ */
+
+#include "iss_scheduler.h"
+#include <limits.h>
+
+Scheduler::Scheduler(const char* name) : name(name), jobCount(0) {
+}
+
+int Scheduler::add(const char* name, JobCallback callback, unsigned long interval, bool enabled) {
+    if (jobCount >= SCHEDULER_MAX_JOBS) {
+        Serial.printf("Scheduler %s is full, cannot add %s\n", this->name, name);
+        return -1;
+    }
+    Job& job = jobs[jobCount];
+    job.name = name;
+    job.callback = callback;
+    job.interval = interval;
+    job.nextRun = millis() + interval;
+    job.enabled = enabled;
+    memset(&job.stats, 0, sizeof(job.stats));
+    return jobCount++;
+}
+
+int Scheduler::every(const char* name, JobCallback callback, unsigned long interval, bool enabled) {
+    return add(name, callback, interval, enabled);
+}
+
+int Scheduler::once(const char* name, JobCallback callback) {
+    return add(name, callback, 0, false);
+}
+
+void Scheduler::runIn(int job, unsigned long delayMs) {
+    if (!valid(job)) {
+        return;
+    }
+    jobs[job].nextRun = millis() + delayMs;
+    jobs[job].enabled = true;
+}
+
+void Scheduler::postpone(int job, unsigned long extraMs) {
+    if (!valid(job)) {
+        return;
+    }
+    jobs[job].nextRun += extraMs;
+}
+
+void Scheduler::setEnabled(int job, bool enabled) {
+    if (!valid(job) || jobs[job].enabled == enabled) {
+        return;
+    }
+    jobs[job].enabled = enabled;
+    if (enabled) {
+        jobs[job].nextRun = millis() + jobs[job].interval;
+    }
+}
+
+void Scheduler::runPending() {
+    for (int i = 0; i < jobCount; i++) {
+        Job& job = jobs[i];
+        unsigned long now = millis();
+        if (!job.enabled || (long)(now - job.nextRun) < 0) {
+            continue;
+        }
+
+        unsigned long lateness = now - job.nextRun;
+        job.stats.runs++;
+        job.stats.lastLateness = lateness;
+        job.stats.totalLateness += lateness;
+        if (lateness > job.stats.maxLateness) {
+            job.stats.maxLateness = lateness;
+        }
+
+        // Schedule the next run before the callback so it can postpone it.
+        // Periodic jobs keep their cadence; missed periods are skipped, not replayed.
+        if (job.interval > 0) {
+            job.nextRun += job.interval;
+            if ((long)(now - job.nextRun) >= 0) {
+                job.nextRun = now + job.interval;
+            }
+        } else {
+            job.enabled = false;
+        }
+
+        job.callback();
+    }
+}
+
+unsigned long Scheduler::msUntilNext() const {
+    unsigned long now = millis();
+    unsigned long soonest = ULONG_MAX;
+    for (int i = 0; i < jobCount; i++) {
+        if (!jobs[i].enabled) {
+            continue;
+        }
+        long remaining = (long)(jobs[i].nextRun - now);
+        if (remaining <= 0) {
+            return 0;
+        }
+        soonest = min(soonest, (unsigned long)remaining);
+    }
+    return soonest;
+}
+
+const JobStats& Scheduler::stats(int job) const {
+    static const JobStats none = {0, 0, 0, 0};
+    return valid(job) ? jobs[job].stats : none;
+}
+
+void Scheduler::logStats() const {
+    for (int i = 0; i < jobCount; i++) {
+        const JobStats& s = jobs[i].stats;
+        Serial.printf("Scheduler %s/%s: %u runs, late by %lu ms last, %lu ms mean, %lu ms max\n",
+                      name, jobs[i].name, (unsigned)s.runs, s.lastLateness,
+                      s.runs ? s.totalLateness / s.runs : 0UL, s.maxLateness);
+    }
+}
@@ -0,0 +1,70 @@
+/*
+ * ISS Line Scroller
+ * =================
+ *
+ * Padded ring layout and per-row scroll state. See iss_scroller.h.
+ */
+
+#include "iss_scroller.h"
+
+ScrollEngine::ScrollEngine()
+    : length(0),
+      period(0),
+      offset(0),
+      pauseTicks(0),
+      holdLeft(0),
+      wrapped(false) {
+    memset(ring, ' ', LCD_COLUMNS);
+}
+
+void ScrollEngine::setText(const char* text, int length, int pauseTicks) {
+    length = constrain(length, 0, SNAPSHOT_LINE_SIZE - 1);
+    memcpy(ring, text, length);
+    this->length = length;
+
+    if (length <= LCD_COLUMNS) {
+        // Fits: one padded window, never moves
+        memset(ring + length, ' ', LCD_COLUMNS - length);
+        period = 0;
+    } else {
+        // Text, gap, then the first window again so every offset in
+        // [0, period) starts a contiguous LCD_COLUMNS-byte slice
+        memset(ring + length, ' ', SCROLL_GAP);
+        period = length + SCROLL_GAP;
+        memcpy(ring + period, ring, LCD_COLUMNS);
+    }
+
+    offset = 0;
+    this->pauseTicks = pauseTicks;
+    holdLeft = pauseTicks;
+    wrapped = false;
+}
+
+void ScrollEngine::patch(int start, const char* text, int count) {
+    if (start < 0 || start >= length) {
+        return;
+    }
+    count = min(count, length - start);
+    memcpy(ring + start, text, count);
+
+    // Keep the copy of the first window after the gap in step
+    if (period > 0 && start < LCD_COLUMNS) {
+        memcpy(ring + period + start, text, min(count, LCD_COLUMNS - start));
+    }
+}
+
+void ScrollEngine::tick() {
+    if (period == 0) {
+        return;
+    }
+    if (offset == 0 && holdLeft > 0) {
+        holdLeft--;
+        return;
+    }
+    offset++;
+    if (offset == period) {
+        offset = 0;
+        holdLeft = pauseTicks;
+        wrapped = true;
+    }
+}
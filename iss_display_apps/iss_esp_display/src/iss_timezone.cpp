@@ -0,0 +1,187 @@
+/*
+ * ISS Timezone and Clock
+ * ======================
+ *
+ * Table lookup, NVS cache, geolocation and NTP supervision.
+ * See iss_timezone.h.
+ */
+
+#include "iss_timezone.h"
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include <ArduinoJson.h>
+#include <Preferences.h>
+
+// Free IP geolocation service; only the fields used here are requested
+static const char* geoApiEndpoint = "http://ip-api.com/json/?fields=status,timezone,offset";
+static const uint16_t geoApiTimeout = 4000;     // ms, for connect and for the response
+
+// NTP servers, tried in order
+static const char* ntpServer1 = "pool.ntp.org";
+static const char* ntpServer2 = "time.google.com";
+static const unsigned long ntpSyncDeadline = 15000;  // ms before SNTP is restarted
+
+// NVS cache of the resolved zone
+static const char* prefsNamespace = "iss_tz";
+static const char* prefsZoneKey = "zone";
+static const char* prefsRuleKey = "rule";
+
+// Any time before this means the clock has not been set yet
+static const time_t minValidTime = 1000000000;
+
+static char zoneName[48] = "UTC";
+static char zoneRule[64] = "UTC0";
+static bool synced = false;
+static unsigned long syncStart = 0;
+
+const char* timezoneLookup(const char* name) {
+    size_t low = 0;
+    size_t high = timezoneTableSize;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        int order = strcmp(name, timezoneTable[mid].name);
+        if (order == 0) {
+            return timezoneTable[mid].posix;
+        }
+        if (order < 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * (Re)starts SNTP with the current rule
+ * configTzTime() also sets TZ, so local time is right as soon as it syncs
+ */
+static void startSync() {
+    configTzTime(zoneRule, ntpServer1, ntpServer2);
+    syncStart = millis();
+}
+
+/**
+ * Makes a zone the active one and restarts NTP with it
+ */
+static void applyZone(const char* name, const char* rule) {
+    strlcpy(zoneName, name, sizeof(zoneName));
+    strlcpy(zoneRule, rule, sizeof(zoneRule));
+    Serial.printf("Timezone: %s (%s)\n", zoneName, zoneRule);
+    startSync();
+}
+
+/**
+ * Builds a fixed-offset POSIX rule for a zone missing from the table
+ * @param offsetSeconds Current UTC offset, east positive
+ * @param output Buffer of at least 24 bytes
+ */
+static void fixedOffsetRule(long offsetSeconds, char* output, size_t outputSize) {
+    // POSIX offsets count west positive, the opposite of ISO 8601
+    char isoSign = offsetSeconds < 0 ? '-' : '+';
+    char posixSign = offsetSeconds < 0 ? '+' : '-';
+    long magnitude = labs(offsetSeconds);
+    int hours = magnitude / 3600;
+    int minutes = (magnitude % 3600) / 60;
+    snprintf(output, outputSize, "<%c%02d%02d>%c%d:%02d",
+             isoSign, hours, minutes, posixSign, hours, minutes);
+}
+
+bool timezoneBegin() {
+    char name[sizeof(zoneName)] = "";
+    char rule[sizeof(zoneRule)] = "";
+
+    Preferences prefs;
+    if (prefs.begin(prefsNamespace, true)) {
+        prefs.getString(prefsZoneKey, name, sizeof(name));
+        prefs.getString(prefsRuleKey, rule, sizeof(rule));
+        prefs.end();
+    }
+
+    if (name[0] != '\0' && rule[0] != '\0') {
+        Serial.println("Using cached timezone");
+        applyZone(name, rule);
+        return true;
+    }
+
+    // Keep the clock on UTC until the zone is known
+    startSync();
+    return false;
+}
+
+bool timezoneResolve() {
+    if (WiFi.status() != WL_CONNECTED) {
+        return false;
+    }
+
+    HTTPClient http;
+    http.setConnectTimeout(geoApiTimeout);
+    http.setTimeout(geoApiTimeout);
+    Serial.println("Getting timezone from IP location...");
+    if (!http.begin(geoApiEndpoint)) {
+        return false;
+    }
+
+    bool resolved = false;
+    int httpResponseCode = http.GET();
+    if (httpResponseCode == 200) {
+        StaticJsonDocument<64> filter;
+        filter["status"] = true;
+        filter["timezone"] = true;
+        filter["offset"] = true;
+
+        StaticJsonDocument<192> doc;
+        DeserializationError error = deserializeJson(doc, http.getStream(),
+                                                     DeserializationOption::Filter(filter));
+        const char* name = doc["timezone"] | "";
+        if (!error && strcmp(doc["status"] | "", "success") == 0 && name[0] != '\0') {
+            char fallback[24];
+            const char* rule = timezoneLookup(name);
+            if (rule == NULL) {
+                // Right offset now, but no DST changes
+                fixedOffsetRule(doc["offset"] | 0L, fallback, sizeof(fallback));
+                rule = fallback;
+                Serial.printf("Timezone %s not in table, using fixed offset\n", name);
+            }
+            applyZone(name, rule);
+
+            Preferences prefs;
+            if (prefs.begin(prefsNamespace, false)) {
+                prefs.putString(prefsZoneKey, zoneName);
+                prefs.putString(prefsRuleKey, zoneRule);
+                prefs.end();
+            }
+            resolved = true;
+        } else {
+            Serial.println("Geolocation response not usable");
+        }
+    } else {
+        Serial.printf("Geolocation request failed: %d\n", httpResponseCode);
+    }
+    http.end();
+    return resolved;
+}
+
+bool timezonePollSync() {
+    if (synced) {
+        return true;
+    }
+    if (time(nullptr) >= minValidTime) {
+        synced = true;
+        Serial.printf("Time synchronized after %lu ms\n", millis() - syncStart);
+        return true;
+    }
+    if (millis() - syncStart >= ntpSyncDeadline) {
+        Serial.println("NTP sync timed out, restarting");
+        startSync();
+    }
+    return false;
+}
+
+bool timezoneSynced() {
+    return synced;
+}
+
+const char* timezoneName() {
+    return zoneName;
+}
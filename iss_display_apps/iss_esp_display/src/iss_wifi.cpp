@@ -0,0 +1,262 @@
+/*
+ * ISS WiFi Fast Connect
+ * =====================
+ *
+ * Cached BSSID/channel/lease connection. See iss_wifi.h.
+ */
+
+#include "iss_wifi.h"
+#include <WiFi.h>
+#include <Preferences.h>
+#include <esp_netif.h>
+#include <esp_netif_net_stack.h>
+#include <lwip/dhcp.h>
+#include "secrets.h"
+
+// A direct attempt that takes longer than this falls back to a full scan
+static const unsigned long fastConnectTimeout = 1500;
+
+// NVS cache of the AP
+static const char* prefsNamespace = "iss_wifi";
+static const char* prefsApKey = "ap";
+
+// Identifies a valid cache entry; bump when WifiCache changes
+static const uint32_t cacheMagic = 0x57494632;  // "WIF2"
+
+// Longest a lease is reused without asking the DHCP server again
+static const uint32_t maxLeaseReuse = 12UL * 60 * 60;
+
+// AP details from the last successful connection
+struct WifiCache {
+    uint32_t magic;
+    uint32_t ssidHash;     // Cache is ignored if the configured network changed
+    uint8_t bssid[6];
+    uint8_t channel;
+    bool hasLease;         // Address fields are valid (RTC copy only)
+    int64_t leaseStart;    // time() when the DHCP server granted the lease
+    uint32_t leaseReuse;   // Seconds from then that it may be reused: T1, when
+                           // the DHCP client would have renewed it
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+};
+
+// Survives resets and deep sleep; zeroed on power-on
+RTC_DATA_ATTR static WifiCache rtcCache;
+
+static const char* wifiSsid = NULL;
+static const char* wifiPassword = NULL;
+static WifiCache cache;
+static bool connecting = false;
+static bool fastAttempt = false;
+static bool leaseAttempt = false;       // The attempt reuses the cached lease
+static bool renewing = false;           // Switched from the cached lease to DHCP
+static unsigned long attemptStart = 0;
+
+/**
+ * FNV-1a hash of the SSID and password
+ */
+static uint32_t credentialsHash() {
+    const char* parts[] = {wifiSsid, wifiPassword};
+    uint32_t hash = 2166136261u;
+    for (const char* part : parts) {
+        for (const char* c = part; *c != '\0'; c++) {
+            hash = (hash ^ (uint8_t)*c) * 16777619u;
+        }
+        hash = (hash ^ 0xFF) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Chooses the cache to use: RTC memory (with lease) first, then NVS
+ */
+static void loadCache() {
+    uint32_t hash = credentialsHash();
+    if (rtcCache.magic == cacheMagic && rtcCache.ssidHash == hash) {
+        cache = rtcCache;
+        return;
+    }
+
+    memset(&cache, 0, sizeof(cache));
+    Preferences prefs;
+    if (prefs.begin(prefsNamespace, true)) {
+        WifiCache stored;
+        if (prefs.getBytes(prefsApKey, &stored, sizeof(stored)) == sizeof(stored) &&
+            stored.magic == cacheMagic && stored.ssidHash == hash) {
+            cache = stored;
+            cache.hasLease = false;  // An old lease may have been handed out again
+        }
+        prefs.end();
+    }
+}
+
+/**
+ * @return True if the cached lease is still within its reuse window
+ * time() runs on across resets and deep sleep. If NTP set it in between,
+ * the lease looks decades old and DHCP runs again, which is the safe side
+ */
+static bool leaseUsable() {
+    if (!cache.hasLease) {
+        return false;
+    }
+    int64_t age = (int64_t)time(NULL) - cache.leaseStart;
+    return age >= 0 && age < (int64_t)cache.leaseReuse;
+}
+
+/**
+ * @return Seconds until the DHCP client renews the lease it just obtained
+ *         (T1), capped at maxLeaseReuse; 0 if there is no DHCP lease
+ */
+static uint32_t dhcpRenewSeconds() {
+    esp_netif_t* netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    struct netif* lwipNetif = netif ? (struct netif*)esp_netif_get_netif_impl(netif) : NULL;
+    struct dhcp* dhcp = lwipNetif ? netif_dhcp_data(lwipNetif) : NULL;
+    if (dhcp == NULL || !dhcp_supplied_address(lwipNetif) || dhcp->offered_t0_lease == 0) {
+        return 0;
+    }
+    uint32_t renew = dhcp->offered_t1_renew ? dhcp->offered_t1_renew : dhcp->offered_t0_lease / 2;
+    return min(renew, maxLeaseReuse);
+}
+
+/**
+ * Records the AP and lease of the current connection
+ * NVS is only written when the AP or channel changed
+ */
+static void saveCache() {
+    WifiCache current;
+    memset(&current, 0, sizeof(current));
+    current.magic = cacheMagic;
+    current.ssidHash = credentialsHash();
+    memcpy(current.bssid, WiFi.BSSID(), sizeof(current.bssid));
+    current.channel = WiFi.channel();
+    if (leaseAttempt) {
+        // Still the same lease: its window does not restart
+        current.leaseStart = cache.leaseStart;
+        current.leaseReuse = cache.leaseReuse;
+    } else {
+        current.leaseStart = time(NULL);
+        current.leaseReuse = dhcpRenewSeconds();
+    }
+    current.hasLease = current.leaseReuse > 0;
+    current.ip = WiFi.localIP();
+    current.gateway = WiFi.gatewayIP();
+    current.subnet = WiFi.subnetMask();
+    current.dns = WiFi.dnsIP();
+    rtcCache = current;
+
+    bool sameAp = cache.magic == cacheMagic && cache.channel == current.channel &&
+                  memcmp(cache.bssid, current.bssid, sizeof(current.bssid)) == 0;
+    cache = current;
+    if (sameAp) {
+        return;
+    }
+
+    Preferences prefs;
+    if (prefs.begin(prefsNamespace, false)) {
+        prefs.putBytes(prefsApKey, &current, sizeof(current));
+        prefs.end();
+    }
+}
+
+/**
+ * Applies the static address from secrets.h, the cached lease, or DHCP
+ * @param useLease True to reuse the cached lease
+ */
+static void configureAddress(bool useLease) {
+#ifdef WIFI_STATIC_IP
+    IPAddress ip, gateway, subnet, dns;
+    ip.fromString(WIFI_STATIC_IP);
+    gateway.fromString(WIFI_GATEWAY);
+    subnet.fromString(WIFI_SUBNET);
+    dns.fromString(WIFI_DNS);
+    WiFi.config(ip, gateway, subnet, dns);
+    (void)useLease;
+#else
+    if (useLease) {
+        WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway),
+                    IPAddress(cache.subnet), IPAddress(cache.dns));
+    } else {
+        WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);  // DHCP
+    }
+#endif
+}
+
+/**
+ * Starts a connection attempt, direct if the cache allows it
+ */
+static void startAttempt() {
+    fastAttempt = cache.magic == cacheMagic && cache.channel != 0;
+#ifdef WIFI_STATIC_IP
+    leaseAttempt = false;
+#else
+    leaseAttempt = fastAttempt && leaseUsable();
+#endif
+    renewing = false;
+    configureAddress(leaseAttempt);
+    if (fastAttempt) {
+        WiFi.begin(wifiSsid, wifiPassword, cache.channel, cache.bssid);
+    } else {
+        WiFi.begin(wifiSsid, wifiPassword);
+    }
+    connecting = true;
+    attemptStart = millis();
+}
+
+void wifiBegin(const char* ssid, const char* password) {
+    wifiSsid = ssid;
+    wifiPassword = password;
+
+    // Credentials come from secrets.h; don't let the SDK copy them to flash
+    WiFi.persistent(false);
+    WiFi.mode(WIFI_STA);
+    loadCache();
+    startAttempt();
+}
+
+void wifiReconnect() {
+    WiFi.disconnect();
+    startAttempt();
+}
+
+bool wifiPoll() {
+    if (WiFi.status() == WL_CONNECTED) {
+        if (connecting) {
+            Serial.printf("WiFi connected in %lu ms (%s)\n", millis() - attemptStart,
+                          fastAttempt ? (leaseAttempt ? "direct, cached lease" : "direct")
+                                      : "scan");
+            connecting = false;
+            saveCache();
+        }
+        return true;
+    }
+
+    if (connecting && fastAttempt && millis() - attemptStart >= fastConnectTimeout) {
+        Serial.println("Direct WiFi connect timed out, scanning");
+        memset(&cache, 0, sizeof(cache));
+        rtcCache = cache;
+        WiFi.disconnect();
+        startAttempt();
+    }
+    return false;
+}
+
+void wifiCheckLease() {
+    if (renewing) {
+        if (WiFi.status() == WL_CONNECTED && dhcpRenewSeconds() > 0) {
+            renewing = false;
+            saveCache();
+            Serial.printf("WiFi lease renewed by DHCP, %s\n", WiFi.localIP().toString().c_str());
+        }
+        return;
+    }
+    if (!leaseAttempt || connecting || WiFi.status() != WL_CONNECTED || leaseUsable()) {
+        return;
+    }
+    // The router has not heard from us since the lease was granted
+    Serial.println("Cached WiFi lease is due for renewal, switching to DHCP");
+    leaseAttempt = false;
+    renewing = true;
+    configureAddress(false);
+}
@@ -10,11 +10,16 @@
  * - RGB LCD Display (I2C)
  * 
  * Features:
- * - Connects to WiFi and fetches ISS location data every 5 minutes
+ * - Connects to WiFi and fetches ISS location data as it changes (about every 5 minutes),
+ *   announced by a push stream from the BFF (iss_push.h) with polling as a fallback
  * - Displays location and facts on a 16x2 LCD screen
  * - Handles scrolling text for long messages
- * - Automatically detects and configures timezone
+ * - Automatically detects and configures timezone (cached in NVS, iss_timezone.h)
  * - Visual feedback through RGB LED
+ * - Network task on core 0, display loop on core 1, joined by a lock-free
+ *   double-buffered snapshot (iss_snapshot.h)
+ * - Background firmware updates from delta patches, with rollback if the
+ *   new image does not reach the BFF (iss_ota.h)
  * 
  * Dependencies:
  * - Wire.h: I2C communication
@@ -29,25 +34,63 @@
  * Created: December 2024
  */
 
-#include <Wire.h>
-#include <rgb_lcd.h>
 #include <WiFi.h>
-#include <HTTPClient.h>
-#include <ArduinoJson.h>
 #include "secrets.h"
+#include "iss_fetch.h"
+#include "iss_playlist.h"
+#include "iss_heap.h"
+#include "iss_lcd.h"
+#include "iss_framebuffer.h"
+#include "iss_scheduler.h"
+#include "iss_scroller.h"
+#include "iss_orbit.h"
+#include "iss_poll.h"
+#include "iss_charset.h"
+#include "iss_timezone.h"
+#include "iss_last_known.h"
+#include "iss_wifi.h"
+#include "iss_power.h"
+#include "iss_push.h"
+#include "iss_metrics.h"
+#include "iss_profile.h"
+#include "iss_render.h"
+#include "iss_backlight.h"
+#include "iss_ota.h"
 #include <time.h>
 
 // Function declarations
 void updateISSData();
-void displayScrollingData(String line1, String line2);
-String convertToLocalTime(String utcString);
-String getPosixTZ(String timezone);
-void configureTimezone();
-String normalizeString(String input);
+void handleFetchState(FetchState state);
+void networkTask(void* parameter);
+void applySnapshot(const DisplaySnapshot& snapshot);
+void displayScrollingData();
+void setLines(const char* line1, const char* line2);
+void convertToLocalTime(const char* utcString, char* output, size_t outputSize);
+void resolveTimezone();
+void pollClock();
+void waitForWiFi();
+void startNetworkJobs();
 void blinkGreen();
-
-// Create an lcd object
-rgb_lcd lcd;
+void scrollTick();
+void renderFrame(uint32_t elapsedUs);
+void logStats();
+void reconnectWiFi();
+void sleepRadioIfIdle();
+void publishLocation(const char* locationDetails, const char* funFact,
+                     bool hasPosition, float latitude, float longitude);
+void startPlayback();
+void publishUpcoming();
+void publishTrack();
+bool itemShownInFull();
+void schedulePlayback();
+void playNextLocation();
+void updatePosition();
+void scheduleNextUpdate(unsigned long delayMs);
+void scheduleNextPoll(unsigned long delayMs);
+void handlePushEvent(PushEvent event);
+void otaHealthDeadline();
+void checkFirmware();
+int formatPosition(float latitude, float longitude, char* output, size_t outputSize);
 
 // Default I2C pins for ESP32
 #define I2C_SDA 21
@@ -57,351 +100,851 @@ rgb_lcd lcd;
 const char* ssid = WIFI_SSID;
 const char* password = WIFI_PASSWORD;
 
-// API configuration
-const char* apiEndpoint = "https://iss-api-bff-esp-768423610307.us-east1.run.app/";
-const char* apiKey = API_KEY;
-const char* geoApiEndpoint = "http://ip-api.com/json/";  // Free IP geolocation service
+// Display timing (in milliseconds)
+const unsigned long scrollInterval = 450;      // One character per tick
+const unsigned long scrollStartPause = 1000;   // Hold on the start of each line
+const unsigned long blinkInterval = 500;       // Green blink cadence
+const unsigned long itemMinShowTime = 8000;    // Before the playlist moves on
+const unsigned long blinkFade = 200;           // Each blink edge fades this long
+const unsigned long colourFade = 400;          // Backlight change on new content
+const unsigned long positionInterval = 1000;   // Live position refresh
+
+// WiFi bring-up (in milliseconds); after the timeout the update job's
+// reconnect handling takes over. The wait job keeps polling after a
+// reconnect so iss_wifi can fall back to a scan and cache the new AP
+const unsigned long wifiPollInterval = 100;
+const unsigned long wifiConnectTimeout = 20000;
+const unsigned long wifiLeaseCheckInterval = 60000;  // Reused lease due for DHCP?
+
+// Clock setup timing (in milliseconds)
+const unsigned long clockPollInterval = 500;       // NTP sync check
+const unsigned long timezoneRetryDelay = 60000;    // After a failed geolocation
+
+// Batched updates: upcoming locations are shown at their predicted time,
+// or one store interval apart while the clock is not set (in milliseconds)
+const unsigned long playbackFallbackInterval = 300000;
+int playbackIndex = 0;                 // Next entry of fetchResult().upcoming
+
+// Ground-track item: where the ISS was this many minutes before the newest point
+const long trailMinutesAgo[] = {5, 10, 15};
+
+// Regular poll timing, kept while a push stream stretches the timer so it
+// can be restored if the stream goes down (in milliseconds)
+unsigned long regularPollDelay = 0;
+unsigned long pollScheduledAt = 0;
+bool pollStretched = false;
+bool pushedDuringFetch = false;    // Announced while a request was already running
+
+// Display loop jobs (core 1) and network task jobs (core 0)
+Scheduler displayScheduler("display");
+Scheduler networkScheduler("network");
+int scrollJob = -1;
+int blinkJob = -1;
+int updateJob = -1;
+int timezoneJob = -1;
+int clockJob = -1;
+int wifiWaitJob = -1;
+int playbackJob = -1;
+int otaHealthJob = -1;
+unsigned long wifiStart = 0;
+bool networkJobsStarted = false;
+bool updateOnConnect = false;      // Radio was woken for an update
+bool timezonePending = false;      // Geolocation still needs the radio
+
+// Network task placement (the Arduino loop task runs on core 1)
+const uint32_t networkTaskStackSize = 12288;  // TLS handshake and JSON parsing
+const BaseType_t networkTaskCore = 0;
+TaskHandle_t networkTaskHandle = NULL;   // Woken by the display loop after a light sleep
 
-// Update interval (in milliseconds)
-const unsigned long updateInterval = 300000; // 5 minutes
-unsigned long lastUpdate = 0;
+// Display text, one scroll engine per row (owned by the display loop)
+// Laid out once per update so rendering a frame never touches the heap
+ScrollEngine lineScroll[LCD_ROWS];
 
-// Global variables for display text
-String currentLine1 = "Waiting for";
-String currentLine2 = "ISS data...";
+// Live position shown in line 1 (owned by the display loop)
+// The field always has the same width, so it can be patched in place
+const int POSITION_FIELD_WIDTH = 12;           // "51.6N 123.4W"
+const float maxOrbitAgeHours = 72;             // Older TLEs fall back to the server position
+int positionColumn = -1;
+float reportedLatitude = 0;
+float reportedLongitude = 0;
+OrbitElements orbit;                           // valid is false until the first TLE
 
-// Add these constants after other configurations
-const char* ntpServer = "pool.ntp.org";
+// Heap fragmentation sampling and stats logging (in milliseconds)
+const unsigned long heapSampleInterval = 60000;   // 1 minute
+const unsigned long statsLogInterval = 600000;    // 10 minutes
+
+// Display loop wake-up planned by the previous iteration, for loop jitter
+uint32_t loopPlannedWake = 0;
+bool loopWakeTimed = false;
+
+// Playlist item shown (copied from the network task's playlist)
+DisplaySnapshot displaySnapshot;
+unsigned long itemShownAt = 0;
 
 // Add at the top with other constants
 const int NORMAL_BRIGHTNESS = 105;  // Reduced brightness for normal operation (0-255)
-unsigned long lastBlinkTime = 0;
 bool blinkState = false;
 
-// Function to convert UTC string to local time string
-String convertToLocalTime(String utcString) {
-    char local_time[9];  // HH:MM:SS + null terminator
-    
-    // Get current local time
-    struct tm timeinfo;
-    if(!getLocalTime(&timeinfo)){
-        Serial.println("Failed to obtain time");
-        return "??:??:??";
-    }
-    
-    // Format as HH:MM:SS
-    strftime(local_time, sizeof(local_time), "%H:%M:%S", &timeinfo);
-    return String(local_time);
-}
-
-// Function to convert timezone name to POSIX format
-String getPosixTZ(String timezone) {
-    // Common US timezone conversions
-    if (timezone == "America/New_York") return "EST5EDT,M3.2.0,M11.1.0";
-    if (timezone == "America/Chicago") return "CST6CDT,M3.2.0,M11.1.0";
-    if (timezone == "America/Denver") return "MST7MDT,M3.2.0,M11.1.0";
-    if (timezone == "America/Los_Angeles") return "PST8PDT,M3.2.0,M11.1.0";
-    if (timezone == "America/Phoenix") return "MST7";  // No DST
-    if (timezone == "America/Anchorage") return "AKST9AKDT,M3.2.0,M11.1.0";
-    if (timezone == "Pacific/Honolulu") return "HST10";  // No DST
-    return "EST5EDT,M3.2.0,M11.1.0";  // Default to EST if unknown
-}
+// Frame clock: when it runs, frames advance the scroll instead of a job
+bool renderClock = false;
+uint32_t scrollElapsedUs = 0;
 
 /**
- * Configures the device's timezone based on IP geolocation
- * Uses ip-api.com to determine location and sets system time accordingly
+ * Formats the current local time for display
+ * @param utcString The UTC timestamp from the API (unused; the clock is NTP synced)
+ * @param output Buffer for the HH:MM:SS string (at least 9 bytes)
+ * @param outputSize Size of the output buffer
  */
-void configureTimezone() {
-    if (WiFi.status() == WL_CONNECTED) {
-        HTTPClient http;
-        
-        Serial.println("Getting timezone from IP location...");
-        http.begin(geoApiEndpoint);
-        
-        int httpResponseCode = http.GET();
-        
-        if (httpResponseCode == 200) {
-            String payload = http.getString();
-            Serial.println("Geolocation response: " + payload);
-            
-            StaticJsonDocument<512> doc;
-            DeserializationError error = deserializeJson(doc, payload);
-            
-            if (!error) {
-                String timezone = doc["timezone"].as<String>();
-                String posixTZ = getPosixTZ(timezone);
-                Serial.println("Detected timezone: " + timezone);
-                Serial.println("POSIX timezone: " + posixTZ);
-                
-                // Configure timezone and NTP
-                configTzTime(posixTZ.c_str(), ntpServer);
-                
-                // Wait for time sync
-                Serial.println("Waiting for NTP time sync...");
-                while (time(nullptr) < 1000000000) {
-                    delay(100);
-                    Serial.print(".");
-                }
-                Serial.println("\nTime synchronized!");
-                
-                // Print current time to verify
-                struct tm timeinfo;
-                if(getLocalTime(&timeinfo)){
-                    Serial.print("Current local time: ");
-                    Serial.printf("%02d:%02d:%02d\n", timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
-                }
-            }
-        }
-        http.end();
-    }
-}
-
-/**
- * Converts accented characters to their unaccented equivalents
- * @param input The string containing possible accented characters
- * @return The normalized string with accents removed
- */
-String normalizeString(String input) {
-    // Common UTF-8 accent replacements
-    struct {
-        const char* accented;
-        char unaccented;
-    } replacements[] = {
-        {"á", 'a'}, {"à", 'a'}, {"ã", 'a'}, {"â", 'a'}, {"ä", 'a'},
-        {"é", 'e'}, {"è", 'e'}, {"ê", 'e'}, {"ë", 'e'},
-        {"í", 'i'}, {"ì", 'i'}, {"î", 'i'}, {"ï", 'i'},
-        {"ó", 'o'}, {"ò", 'o'}, {"õ", 'o'}, {"ô", 'o'}, {"ö", 'o'},
-        {"ú", 'u'}, {"ù", 'u'}, {"û", 'u'}, {"ü", 'u'},
-        {"ý", 'y'}, {"ÿ", 'y'},
-        {"ñ", 'n'},
-        {NULL, 0}
-    };
-    
-    String normalized = input;  // Remove toLowerCase() call
-    
-    // Replace each accented sequence with its unaccented equivalent
-    for (int i = 0; replacements[i].accented != NULL; i++) {
-        // Handle lowercase
-        normalized.replace(replacements[i].accented, String(replacements[i].unaccented));
-        
-        // Handle uppercase
-        String upperAccented = String(replacements[i].accented);
-        upperAccented.toUpperCase();
-        normalized.replace(upperAccented, String(toupper(replacements[i].unaccented)));
+void convertToLocalTime(const char* utcString, char* output, size_t outputSize) {
+    // Get current local time (without waiting if NTP has not synced yet)
+    struct tm timeinfo;
+    if(!getLocalTime(&timeinfo, 0)){
+        Serial.println("Failed to obtain time");
+        strlcpy(output, "??:??:??", outputSize);
+        return;
     }
     
-    return normalized;
+    // Format as HH:MM:SS
+    strftime(output, outputSize, "%H:%M:%S", &timeinfo);
 }
 
 /**
  * Provides visual feedback by blinking the LCD backlight green
  * Used to indicate successful data updates
+ * Runs as the display scheduler's blink job (every blinkInterval ms while
+ * enabled with displayScheduler.setEnabled(blinkJob, true))
  */
 void blinkGreen() {
-    unsigned long currentTime = millis();
-    if (currentTime - lastBlinkTime >= 500) {  // Blink every 500ms
-        blinkState = !blinkState;
-        if (blinkState) {
-            lcd.setRGB(0, 255, 0);
-        } else {
-            lcd.setRGB(0, 0, 0);
-        }
-        lastBlinkTime = currentTime;
+    blinkState = !blinkState;
+    if (blinkState) {
+        backlightSet(0, 255, 0, blinkFade);
+    } else {
+        backlightSet(0, 0, 0, blinkFade);
     }
 }
 
 /**
  * Initial setup of the ESP32 device
- * Configures I2C, LCD, WiFi, timezone, and performs initial data fetch
+ * Configures I2C and the LCD and shows the last-known content straight away,
+ * then starts WiFi and the network task without waiting for either
  */
 void setup() {
     // Initialize Serial first for debugging
     Serial.begin(115200);
     Serial.println("Starting setup...");
 
-    // Initialize I2C communication
-    Wire.begin(I2C_SDA, I2C_SCL);
-    Serial.println("I2C initialized");
+    // After an update: count the trial boot, or roll back after too many.
+    // Before anything else, so an image that fails further on still counts
+    otaBootCheck();
+
+    // Initialize I2C and the LCD
+    lcdBegin(I2C_SDA, I2C_SCL);
+    charsetLoadGlyphs(lcdPanel());
+    framebufferBegin();
 
-    // Initialize the LCD
-    lcd.begin(16, 2);
+    // Frame clock for scrolling and fades; without it colour changes are immediate
+    renderClock = renderBegin();
+    backlightBegin(renderClock);
     Serial.println("LCD initialized");
-    lcd.print("Starting up..."); 
 
-    // Set green for setup phase
-    lcd.setRGB(0, 255, 0);
+    // Last good content from flash, shown until the first update arrives
+    if (lastKnownLoad(displaySnapshot)) {
+        applySnapshot(displaySnapshot);
+        Serial.printf("Showing last-known content after %lu ms\n", millis());
+    } else {
+        framebufferSetRow(0, "Starting up...", 14);
+        framebufferFlush();
+        setLines("Waiting for", "ISS data...");
 
-    // Connect to WiFi
-    Serial.print("Connecting to WiFi");
-    WiFi.begin(ssid, password);
-    while (WiFi.status() != WL_CONNECTED) {
-        delay(100);
-        Serial.print(".");
+        // Set green for setup phase
+        backlightSet(0, 255, 0, 0);
     }
-    Serial.println("\nConnected to WiFi");
 
-    // Configure timezone
-    Serial.println("Configuring timezone...");
-    configureTimezone();
+    // Connect to WiFi in the background; the network task waits for it
+    Serial.println("Connecting to WiFi...");
+    powerBegin();
+    wifiBegin(ssid, password);
 
-    // Initial data fetch
-    Serial.println("Fetching initial ISS data...");
-    updateISSData();
+    // Hash the running image for update checks while WiFi connects
+    otaIdentify();
 
-    // Set to dim white for normal operation
-    lcd.setRGB(NORMAL_BRIGHTNESS, NORMAL_BRIGHTNESS, NORMAL_BRIGHTNESS);
+    // Display loop jobs
+    if (!renderClock) {
+        scrollJob = displayScheduler.every("scroll", scrollTick, scrollInterval);
+    }
+    blinkJob = displayScheduler.every("blink", blinkGreen, blinkInterval, false);
+    displayScheduler.every("position", updatePosition, positionInterval);
+    displayScheduler.every("heap", heapStatsSample, heapSampleInterval);
+    displayScheduler.every("stats", logStats, statsLogInterval);
+
+    // Timezone, NTP and ISS data are handled by the network task on core 0
+    xTaskCreatePinnedToCore(networkTask, "iss_net", networkTaskStackSize,
+                            NULL, 1, &networkTaskHandle, networkTaskCore);
 }
 
 /**
- * Main program loop
- * Handles periodic ISS data updates and display refreshes
+ * Main program loop (Arduino loop task, core 1)
+ * Picks up new content from the network task and runs the display jobs.
+ * Never blocks; it only sleeps until the next job or render frame is due
+ * (at most 10 ms, so new content is picked up promptly). With the radio off in
+ * POWER_MODE_LIGHT_SLEEP it light sleeps until the next job on either core.
  */
 void loop() {
-    // Check if it's time to update
-    unsigned long currentTime = millis();
-    if (currentTime - lastUpdate >= updateInterval) {
-        updateISSData();
-        lastUpdate = currentTime;
+    // How much later than planned this iteration started
+    uint32_t now = micros();
+    if (loopWakeTimed) {
+        int32_t late = (int32_t)(now - loopPlannedWake);
+        metricsRecord(METRIC_LOOP_JITTER, late > 0 ? late : 0);
+    }
+
+    // Switch to new content from the network task, or the next playlist item
+    if (playlistPoll(displaySnapshot, itemShownInFull())) {
+        applySnapshot(displaySnapshot);
     }
     
-    // Update display every 450ms for scrolling
-    static unsigned long lastScrollUpdate = 0;
-    if (currentTime - lastScrollUpdate >= 450) {
-        displayScrollingData(currentLine1, currentLine2);
-        lastScrollUpdate = currentTime;
+    displayScheduler.runPending();
+    uint32_t elapsedUs = renderElapsedUs();
+    if (elapsedUs > 0) {
+        renderFrame(elapsedUs);
+    }
+    profilePoll();
+    unsigned long idleMs = min(displayScheduler.msUntilNext(), networkScheduler.msUntilNext());
+    loopPlannedWake = micros() + idleMs * 1000;
+    loopWakeTimed = true;
+    if (powerLightSleep(idleMs)) {
+        // The network task's tick delay stood still during the sleep
+        if (networkScheduler.msUntilNext() == 0) {
+            xTaskNotifyGive(networkTaskHandle);
+        }
+    } else {
+        unsigned long delayMs = min(displayScheduler.msUntilNext(), 10UL);
+        loopPlannedWake = micros() + delayMs * 1000;
+        renderWait(delayMs);
     }
 }
 
 /**
- * Fetches and processes ISS location data from the API
- * Updates global display variables with new data
- * Provides visual feedback for successful/failed updates
+ * Display job: advances the scroll by one character
+ */
+void scrollTick() {
+    displayScrollingData();
+}
+
+/**
+ * Frame clock tick: steps the backlight fade, and the scroll once a
+ * scrollInterval of frame time has built up
+ * @param elapsedUs Frame time since the previous frame
+ */
+void renderFrame(uint32_t elapsedUs) {
+    backlightStep(elapsedUs);
+    scrollElapsedUs += elapsedUs;
+    if (scrollElapsedUs >= scrollInterval * 1000) {
+        // One character per frame at most; a stall is not caught up
+        scrollElapsedUs = scrollElapsedUs % (scrollInterval * 1000);
+        displayScrollingData();
+    }
+}
+
+/**
+ * Display job: prints heap, display and scheduler statistics
+ */
+void logStats() {
+    heapStatsLog();
+    framebufferLogStats();
+    displayScheduler.logStats();
+    networkScheduler.logStats();
+    powerLogStats();
+    pushLogStats();
+    otaLogStats();
+    metricsLogSummary();
+}
+
+/**
+ * Network task, pinned to core 0
+ * Waits for WiFi, configures the timezone, then runs the ISS data updates.
+ * All HTTP and JSON work happens here so it never delays the display loop.
+ * @param parameter Unused
+ */
+void networkTask(void* parameter) {
+    timezoneJob = networkScheduler.once("timezone", resolveTimezone);
+    clockJob = networkScheduler.every("clock", pollClock, clockPollInterval, false);
+    updateJob = networkScheduler.once("update", updateISSData);
+    playbackJob = networkScheduler.once("playback", playNextLocation);
+    wifiWaitJob = networkScheduler.every("wifi-wait", waitForWiFi, wifiPollInterval);
+    networkScheduler.every("wifi-lease", wifiCheckLease, wifiLeaseCheckInterval);
+    wifiStart = millis();
+    if (otaOnTrial()) {
+        otaHealthJob = networkScheduler.once("ota-health", otaHealthDeadline);
+        networkScheduler.runIn(otaHealthJob, OTA_HEALTH_TIMEOUT);
+    }
+
+    for (;;) {
+        networkScheduler.runPending();
+        handlePushEvent(pushStep());
+        metricsServe();
+
+        // Advance any in-flight request or update, yielding between steps
+        bool busy = fetchInProgress() || otaInProgress();
+        if (fetchInProgress()) {
+            handleFetchState(fetchStep());
+        }
+        if (otaInProgress()) {
+            otaStep();
+        }
+        if (busy) {
+            if (!fetchInProgress() && !otaInProgress()) {
+                sleepRadioIfIdle();
+            }
+            vTaskDelay(1);
+        } else {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(min(networkScheduler.msUntilNext(), 100UL)));
+        }
+    }
+}
+
+/**
+ * Starts fetching ISS location data from the API
+ * Runs as the network scheduler's update job. The request itself is advanced
+ * step by step by the network task; handleFetchState() publishes the result
+ * and schedules the next update once it completes
  */
 void updateISSData() {
+    if (fetchInProgress()) {
+        return;  // Previous request still running
+    }
     Serial.println("Updating ISS data...");
+    metricsSampleHeap();
+    if (powerRadioAsleep()) {
+        // Radio was off since the last update; fetch once it is back, or
+        // fall into the error handling below if it does not come back
+        powerRadioWake();
+        reconnectWiFi();
+        updateOnConnect = true;
+        networkScheduler.runIn(updateJob, wifiConnectTimeout);
+        return;
+    }
     if (WiFi.status() == WL_CONNECTED) {
-        HTTPClient http;
-        
-        // Create the URL with API key
-        String url = String(apiEndpoint) + "?api_key=" + apiKey;
-        Serial.print("Connecting to: ");
-        Serial.println(url);
-        
-        http.begin(url);
-        // Add timeout settings
-        http.setTimeout(10000);  // 10 second timeout
-        
-        // Add headers to handle 411 error
-        http.addHeader("Content-Length", "0");
-        http.addHeader("Connection", "close");
-        
-        int retry = 0;
-        int httpResponseCode;
+        fetchBegin();
+    } else {
+        Serial.println("WiFi not connected");
+        // Red backlight for WiFi error, shown right away
+        playlistPublishLines(PLAYLIST_STATUS, PLAYLIST_URGENT,
+                             "WiFi Error", "Reconnecting...", 255, 0, 0, true);
         
-        // Try up to 3 times
-        while (retry < 3) {
-            httpResponseCode = http.GET();
-            
-            if (httpResponseCode == 200) {
-                break;  // Success! Exit the retry loop
-            }
-            
-            Serial.printf("Attempt %d failed with code: %d\n", retry + 1, httpResponseCode);
-            if (httpResponseCode == 411) {
-                Serial.println("411 Length Required error - check headers");
-            }
-            delay(1000);  // Wait a second before retrying
-            retry++;
+        // Try to reconnect to WiFi, directly to the last AP if possible
+        reconnectWiFi();
+        scheduleNextUpdate(pollDelayAfterFailure(-1));
+    }
+}
+
+/**
+ * Arms the update job
+ * @param delayMs Milliseconds until the next update
+ */
+void scheduleNextUpdate(unsigned long delayMs) {
+    pollScheduledAt = millis();
+    pollStretched = false;
+    Serial.printf("Next update in %lu s\n", delayMs / 1000);
+    networkScheduler.runIn(updateJob, delayMs);
+}
+
+/**
+ * Arms the update job after a successful update
+ * While the push stream is up the timer is only a fallback, so it is
+ * stretched; the regular delay is kept for handlePushEvent()
+ * @param delayMs Milliseconds until the next update by the poll policy
+ */
+void scheduleNextPoll(unsigned long delayMs) {
+    bool stretch = pushConnected();
+    scheduleNextUpdate(stretch ? pollDelayWithPush(delayMs) : delayMs);
+    regularPollDelay = delayMs;
+    pollStretched = stretch;
+}
+
+/**
+ * Reacts to the push stream
+ * An announced location is fetched at once unless it is already shown or
+ * the current batch still has locations to play back; a lost stream brings
+ * back the regular poll timing
+ * @param event The event returned by the latest pushStep()
+ */
+void handlePushEvent(PushEvent event) {
+    const ISSData& data = fetchResult();
+    if (event == PUSH_LOCATION) {
+        if (strcmp(pushLastTimestamp(), data.timestamp) == 0 || playbackIndex < data.upcomingCount) {
+            return;
         }
-        
-        if (httpResponseCode == 200) {
-            // Success - set backlight to dim white
-            lcd.setRGB(NORMAL_BRIGHTNESS, NORMAL_BRIGHTNESS, NORMAL_BRIGHTNESS);
-            
-            String payload = http.getString();
-            Serial.println("Received payload: " + payload);
-            
-            StaticJsonDocument<512> doc;
-            DeserializationError error = deserializeJson(doc, payload);
-            
-            if (!error) {
-                String funFact = doc["fun_fact"].as<String>();
-                // Normalize the city name to remove accents while preserving base characters
-                String nearestCity = normalizeString(doc["location_details"].as<String>());
-                String utcTime = doc["timestamp"].as<String>();
-                String localTime = convertToLocalTime(utcTime);
-                
-                Serial.println("Location: " + nearestCity);
-                Serial.println("Fun fact: " + funFact);
-                
-                currentLine1 = "ISS: " + nearestCity + " @ " + localTime;
-                currentLine2 = "Fact: " + funFact;
+        if (fetchInProgress()) {
+            pushedDuringFetch = true;  // That request may have been just too early
+            return;
+        }
+        Serial.printf("New location %s announced, updating now\n", pushLastTimestamp());
+        networkScheduler.runIn(updateJob, 0);
+    } else if (event == PUSH_LOST && pollStretched) {
+        pollStretched = false;
+        unsigned long elapsed = millis() - pollScheduledAt;
+        scheduleNextUpdate(elapsed < regularPollDelay ? regularPollDelay - elapsed : 0);
+    }
+}
+
+/**
+ * Network job: waits for a WiFi connection started by setup() or
+ * reconnectWiFi()
+ * On the first connection it starts the timezone and update jobs, also after
+ * the timeout so the update job's error handling can take over
+ */
+void waitForWiFi() {
+    bool connected = wifiPoll();
+    if (networkJobsStarted) {
+        if (connected) {
+            networkScheduler.setEnabled(wifiWaitJob, false);
+            if (updateOnConnect) {
+                updateOnConnect = false;
+                networkScheduler.runIn(updateJob, 0);
             }
+        }
+        return;
+    }
+    if (!connected && millis() - wifiStart < wifiConnectTimeout) {
+        return;
+    }
+    if (!connected) {
+        Serial.println("WiFi not connected yet, continuing");
+    }
+    networkJobsStarted = true;
+    startNetworkJobs();
+}
+
+/**
+ * Configures the timezone and starts the ISS data updates
+ * The cached zone applies at once, otherwise it is looked up before the
+ * first update; NTP syncs in the background
+ */
+void startNetworkJobs() {
+    Serial.println("Configuring timezone...");
+    if (!timezoneBegin()) {
+        timezonePending = true;
+        networkScheduler.runIn(timezoneJob, 0);
+    }
+    networkScheduler.setEnabled(clockJob, true);
+
+    // Each update schedules the next one (see iss_poll.h); the first is due right away
+    Serial.println("Fetching initial ISS data...");
+    networkScheduler.runIn(updateJob, 0);
+    pushBegin();
+    metricsBegin();
+}
+
+/**
+ * Network job: looks up the timezone, retrying until it succeeds
+ */
+void resolveTimezone() {
+    if (timezoneResolve()) {
+        timezonePending = false;
+    } else {
+        networkScheduler.runIn(timezoneJob, timezoneRetryDelay);
+    }
+}
+
+/**
+ * Network job: watches NTP until the clock is set
+ */
+void pollClock() {
+    if (timezonePollSync()) {
+        networkScheduler.setEnabled(clockJob, false);
+    }
+}
+
+/**
+ * Reconnects to WiFi after a disconnect and waits for the link again
+ */
+void reconnectWiFi() {
+    wifiReconnect();
+    networkScheduler.setEnabled(wifiWaitJob, true);
+}
+
+/**
+ * Switches the radio off after a request when the power mode asks for it
+ * Waits until the timezone is known and the clock is set, which need the
+ * radio too, and for a firmware update to finish; updateISSData() brings
+ * it back for the next request
+ */
+void sleepRadioIfIdle() {
+    if (powerRadioCanSleep() && !timezonePending && timezoneSynced() && !otaInProgress()) {
+        Serial.println("Radio off until the next update");
+        powerRadioSleep();
+    }
+}
+
+/**
+ * Publishes the outcome of a finished request to the display loop
+ * Provides visual feedback for successful/failed updates
+ * @param state The state returned by the latest fetchStep()
+ */
+void handleFetchState(FetchState state) {
+    if (state == FETCH_DONE) {
+        metricsCount(METRIC_UPDATE_DONE);
+        const ISSData& data = fetchResult();
+        // The server answered - back to the regular items
+        playlistRemove(PLAYLIST_STATUS);
+        if (fetchResultChanged()) {
+            publishLocation(data.locationDetails, data.funFact,
+                            data.hasPosition, data.latitude, data.longitude);
+            publishUpcoming();
+            publishTrack();
+            startPlayback();
+            scheduleNextPoll(pollDelayAfterUpdate(true, fetchPollHint()));
+            checkFirmware();
         } else {
-            Serial.printf("Error in HTTP request after %d attempts\n", retry);
-            // Set backlight to blue for API error
-            lcd.setRGB(0, 0, 255);
-            
-            // Update display with error message
-            currentLine1 = "API Error";
-            currentLine2 = "Retrying soon...";
-            
-            // Force an immediate display update
-            lcd.clear();
-            lcd.setCursor(0, 0);
-            lcd.print(currentLine1);
-            lcd.setCursor(0, 1);
-            lcd.print(currentLine2);
+            // Unparseable payload - keep the current items
+            scheduleNextUpdate(pollDelayAfterFailure(-1));
         }
-        
-        http.end();
+    } else if (state == FETCH_UNCHANGED) {
+        metricsCount(METRIC_UPDATE_UNCHANGED);
+        // Nothing new yet - keep the current items and ask again when the server suggests
+        playlistRemove(PLAYLIST_STATUS);
+        scheduleNextPoll(pollDelayAfterUpdate(false, fetchPollHint()));
+        checkFirmware();
+    } else if (state == FETCH_FAILED) {
+        metricsCount(METRIC_UPDATE_FAILED);
+        // Blue backlight for API error, shown right away instead of the other items
+        playlistPublishLines(PLAYLIST_STATUS, PLAYLIST_URGENT,
+                             "API Error", "Retrying soon...", 0, 0, 255, true);
+        scheduleNextUpdate(pollDelayAfterFailure(fetchPollHint()));
+    }
+
+    // Check an announcement that arrived during the request once more
+    if (pushedDuringFetch && (state == FETCH_DONE || state == FETCH_UNCHANGED)) {
+        pushedDuringFetch = false;
+        handlePushEvent(PUSH_LOCATION);
+    }
+}
+
+/**
+ * Confirms a new image after a good request, then starts a firmware check
+ * if one is due; the update runs alongside the next requests
+ */
+void checkFirmware() {
+    otaHealthy();
+    if (otaCheckDue()) {
+        otaBegin();
+    }
+}
+
+/**
+ * Network job: rolls a new image back if it has not completed a good
+ * request within OTA_HEALTH_TIMEOUT of booting
+ */
+void otaHealthDeadline() {
+    if (otaOnTrial()) {
+        Serial.println("New firmware has not reached the BFF");
+        otaRollback();
+    }
+}
+
+/**
+ * Formats a location and its fact as the playlist's location item
+ * The orbit comes from the TLE of the latest response
+ * @param locationDetails UTF-8 place name
+ * @param funFact UTF-8 fact about the place
+ * @param hasPosition False if the coordinates are unknown
+ * @param latitude Position reported with the location
+ * @param longitude Position reported with the location
+ */
+void publishLocation(const char* locationDetails, const char* funFact,
+                     bool hasPosition, float latitude, float longitude) {
+    PROFILE_SCOPE(PROFILE_PUBLISH);
+    const ISSData& data = fetchResult();
+
+    // Convert the UTF-8 city name to characters the LCD can show
+    char nearestCity[sizeof(data.locationDetails)];
+    char localTime[9];  // HH:MM:SS + null terminator
+    charsetTransliterate(locationDetails, nearestCity, sizeof(nearestCity));
+    convertToLocalTime(data.timestamp, localTime, sizeof(localTime));
+
+    Serial.printf("Location: %s\n", locationDetails);
+    Serial.printf("Fun fact: %u bytes\n", (unsigned)strlen(funFact));
+
+    // Format straight into the playlist slot
+    DisplaySnapshot* next = playlistBeginWrite(PLAYLIST_LOCATION, PLAYLIST_NORMAL, 0);
+    if (next == NULL) {
+        return;
+    }
+    if (hasPosition) {
+        // Position field first so it is in view at the start of every scroll
+        char position[POSITION_FIELD_WIDTH + 1];
+        formatPosition(latitude, longitude, position, sizeof(position));
+        int prefix = snprintf(next->line1, sizeof(next->line1), "ISS: ");
+        snprintf(next->line1 + prefix, sizeof(next->line1) - prefix, "%s %s @ %s",
+                 position, nearestCity, localTime);
+        next->positionColumn = prefix;
+        next->latitude = latitude;
+        next->longitude = longitude;
     } else {
-        Serial.println("WiFi not connected");
-        // Set backlight to red for WiFi error
-        lcd.setRGB(255, 0, 0);
-        
-        // Try to reconnect to WiFi
-        WiFi.disconnect();
-        delay(1000);
-        WiFi.begin(ssid, password);
-        
-        // Update display with WiFi status
-        currentLine1 = "WiFi Error";
-        currentLine2 = "Reconnecting...";
-        
-        lcd.clear();
-        lcd.setCursor(0, 0);
-        lcd.print(currentLine1);
-        lcd.setCursor(0, 1);
-        lcd.print(currentLine2);
+        snprintf(next->line1, sizeof(next->line1), "ISS: %s @ %s", nearestCity, localTime);
+        next->positionColumn = -1;
+    }
+    int factPrefix = snprintf(next->line2, sizeof(next->line2), "Fact: ");
+    charsetTransliterate(funFact, next->line2 + factPrefix, sizeof(next->line2) - factPrefix);
+
+    // Orbit for propagating the position until the next update
+    if (!orbitParseTle(data.tleLine1, data.tleLine2, next->orbit) && data.tleLine1[0] != '\0') {
+        Serial.println("Ignoring malformed TLE");
     }
+
+    // Success - dim white backlight
+    next->red = NORMAL_BRIGHTNESS;
+    next->green = NORMAL_BRIGHTNESS;
+    next->blue = NORMAL_BRIGHTNESS;
+    next->hasLines = true;
+    next->redrawNow = false;
+    playlistCommit(true);
+
+    // Only the producer writes the slot, so it can still be read here
+    lastKnownSave(*next);
 }
 
-// Function to update the display with scrolling data
-void displayScrollingData(String line1, String line2) {
-    // Clear any previous content
-    lcd.clear();
-    
-    static int position = 0;  // Make position static to maintain state between calls
-    int line1_length = line1.length();
-    int line2_length = line2.length();
-    
-    // Display current window of text for line 1
-    lcd.setCursor(0, 0);
-    String currentText1 = line1.substring(position, min(position + 16, line1_length));
-    lcd.print(currentText1);
-    
-    // Display current window of text for line 2
-    lcd.setCursor(0, 1);
-    String currentText2 = line2.substring(position, min(position + 16, line2_length));
-    lcd.print(currentText2);
-    
-    // Increment position
-    position++;
-    
-    // Reset position when the last character of the longer string enters the display
-    if (position > max(line1_length, line2_length) - 16) {
-        position = 0;
-        delay(1000);  // Pause at the end before restarting
+/**
+ * Adds the upcoming locations of the latest response to the playlist as
+ * previews, each dropped when playback reaches it. Needs the clock: without
+ * it there is no time to show or expire them by, so only stale previews
+ * are removed.
+ */
+void publishUpcoming() {
+    PROFILE_SCOPE(PROFILE_PUBLISH);
+    const ISSData& data = fetchResult();
+    int count = timezoneSynced() ? data.upcomingCount : 0;
+
+    for (int i = 0; i < count; i++) {
+        const ISSUpcoming& upcoming = data.upcoming[i];
+        if (upcoming.at <= time(nullptr)) {
+            playlistRemove(PLAYLIST_UPCOMING + i);  // Already due; playback shows it
+            continue;
+        }
+        DisplaySnapshot* next = playlistBeginWrite(PLAYLIST_UPCOMING + i, PLAYLIST_NORMAL,
+                                                   upcoming.at);
+        if (next == NULL) {
+            break;
+        }
+        char nearestCity[sizeof(upcoming.locationDetails)];
+        char localTime[6];  // HH:MM + null terminator
+        struct tm timeinfo;
+        charsetTransliterate(upcoming.locationDetails, nearestCity, sizeof(nearestCity));
+        localtime_r(&upcoming.at, &timeinfo);
+        strftime(localTime, sizeof(localTime), "%H:%M", &timeinfo);
+
+        snprintf(next->line1, sizeof(next->line1), "Next @ %s: %s", localTime, nearestCity);
+        int factPrefix = snprintf(next->line2, sizeof(next->line2), "Fact: ");
+        charsetTransliterate(upcoming.funFact, next->line2 + factPrefix,
+                             sizeof(next->line2) - factPrefix);
+        next->positionColumn = -1;
+        next->orbit.valid = false;
+        next->red = NORMAL_BRIGHTNESS;
+        next->green = NORMAL_BRIGHTNESS;
+        next->blue = NORMAL_BRIGHTNESS;
+        next->hasLines = true;
+        next->redrawNow = false;
+        playlistCommit(false);
+    }
+    for (int i = count; i < FETCH_BATCH_SIZE - 1; i++) {
+        playlistRemove(PLAYLIST_UPCOMING + i);
     }
 }
+
+/**
+ * Starts playing back the upcoming locations of the latest response
+ */
+void startPlayback() {
+    playbackIndex = 0;
+    schedulePlayback();
+}
+
+/**
+ * Arms the playback job for the next upcoming location, if any
+ * Locations whose time has passed are skipped, except the latest of them,
+ * which is due at once. Without a synced clock they follow one store
+ * interval apart.
+ */
+void schedulePlayback() {
+    const ISSData& data = fetchResult();
+    if (playbackIndex >= data.upcomingCount) {
+        networkScheduler.setEnabled(playbackJob, false);
+        return;
+    }
+
+    unsigned long delayMs = playbackFallbackInterval;
+    if (timezoneSynced()) {
+        time_t now = time(nullptr);
+        while (playbackIndex + 1 < data.upcomingCount && data.upcoming[playbackIndex + 1].at <= now) {
+            playbackIndex++;
+        }
+        time_t at = data.upcoming[playbackIndex].at;
+        delayMs = at > now ? (unsigned long)(at - now) * 1000UL : 0;
+    }
+    networkScheduler.runIn(playbackJob, delayMs);
+}
+
+/**
+ * Network job: shows the next upcoming location
+ */
+void playNextLocation() {
+    const ISSData& data = fetchResult();
+    if (playbackIndex < data.upcomingCount) {
+        const ISSUpcoming& item = data.upcoming[playbackIndex];
+        Serial.printf("Playing back location %d of %d\n", playbackIndex + 1, data.upcomingCount);
+        publishLocation(item.locationDetails, item.funFact,
+                        item.hasPosition, item.latitude, item.longitude);
+        playbackIndex++;
+    }
+    schedulePlayback();
+}
+
+/**
+ * Adds the ground track of the latest response to the playlist: speed and
+ * heading over the last sample, then the newest point and the first one at
+ * least each of trailMinutesAgo before it
+ */
+void publishTrack() {
+    PROFILE_SCOPE(PROFILE_PUBLISH);
+    const GroundTrack& track = fetchResult().track;
+    float speedKmh, headingDeg;
+    if (!historyMotion(track, speedKmh, headingDeg)) {
+        playlistRemove(PLAYLIST_TRACK);
+        return;
+    }
+    DisplaySnapshot* next = playlistBeginWrite(PLAYLIST_TRACK, PLAYLIST_NORMAL, 0);
+    if (next == NULL) {
+        return;
+    }
+
+    snprintf(next->line1, sizeof(next->line1), "ISS track: %.0f km/h %s",
+             speedKmh, historyCompass(headingDeg));
+    char position[POSITION_FIELD_WIDTH + 1];
+    int i = track.count - 1;
+    time_t newest = historyTime(track, i);
+    formatPosition((float)track.latitude[i] / HISTORY_SCALE,
+                   (float)track.longitude[i] / HISTORY_SCALE, position, sizeof(position));
+    int length = snprintf(next->line2, sizeof(next->line2), "Trail: %s", position);
+    for (long minutes : trailMinutesAgo) {
+        while (i >= 0 && newest - historyTime(track, i) < minutes * 60) {
+            i--;
+        }
+        if (i < 0 || length >= (int)sizeof(next->line2) - 1) {
+            break;  // The track does not reach back that far
+        }
+        formatPosition((float)track.latitude[i] / HISTORY_SCALE,
+                       (float)track.longitude[i] / HISTORY_SCALE, position, sizeof(position));
+        length += snprintf(next->line2 + length, sizeof(next->line2) - length, ", -%ldm %s",
+                           (long)(newest - historyTime(track, i)) / 60, position);
+        i--;  // Each point once, should the track have gaps
+    }
+    next->positionColumn = -1;
+    next->orbit.valid = false;
+    next->red = NORMAL_BRIGHTNESS;
+    next->green = NORMAL_BRIGHTNESS;
+    next->blue = NORMAL_BRIGHTNESS;
+    next->hasLines = true;
+    next->redrawNow = false;
+    playlistCommit(false);
+}
+
+/**
+ * Copies a playlist item into the display state (display loop only)
+ * @param snapshot Item from the playlist, or the last-known content
+ */
+void applySnapshot(const DisplaySnapshot& snapshot) {
+    PROFILE_SCOPE(PROFILE_SNAPSHOT);
+    itemShownAt = millis();
+    if (snapshot.hasLines) {
+        setLines(snapshot.line1, snapshot.line2);
+        positionColumn = snapshot.positionColumn;
+        reportedLatitude = snapshot.latitude;
+        reportedLongitude = snapshot.longitude;
+        orbit = snapshot.orbit;
+        updatePosition();
+    }
+    backlightSet(snapshot.red, snapshot.green, snapshot.blue, colourFade);
+
+    if (snapshot.redrawNow) {
+        // Force an immediate display update
+        for (int row = 0; row < LCD_ROWS; row++) {
+            framebufferSetRow(row, lineScroll[row].window(), LCD_COLUMNS);
+        }
+        framebufferFlush();
+    }
+}
+
+/**
+ * @return True once the item shown has been in view long enough for the
+ *         playlist to move on: both rows scrolled through at least once
+ */
+bool itemShownInFull() {
+    return millis() - itemShownAt >= itemMinShowTime &&
+           lineScroll[0].shownInFull() && lineScroll[1].shownInFull();
+}
+
+/**
+ * Lays out new text for both rows, each starting from its beginning
+ * @param line1 Text for the top row
+ * @param line2 Text for the bottom row
+ */
+void setLines(const char* line1, const char* line2) {
+    const int pauseTicks = scrollStartPause / scrollInterval;
+    lineScroll[0].setText(line1, strlen(line1), pauseTicks);
+    lineScroll[1].setText(line2, strlen(line2), pauseTicks);
+}
+
+/**
+ * Shows the current window of each row and advances every row by one
+ * character; only the cells that changed since the last frame are sent
+ */
+void displayScrollingData() {
+    PROFILE_SCOPE(PROFILE_FRAME);
+    uint32_t start = micros();
+    {
+        PROFILE_SCOPE(PROFILE_SCROLL);
+        for (int row = 0; row < LCD_ROWS; row++) {
+            framebufferSetRow(row, lineScroll[row].window(), LCD_COLUMNS);
+            lineScroll[row].tick();
+        }
+    }
+    framebufferFlush();
+    metricsRecord(METRIC_RENDER, micros() - start);
+}
+
+/**
+ * Display job: refreshes the position field in line 1
+ * Propagates the last TLE to the current time; without a usable TLE or a
+ * synced clock it shows the position the server reported
+ */
+void updatePosition() {
+    if (positionColumn < 0) {
+        return;
+    }
+    PROFILE_SCOPE(PROFILE_POSITION);
+
+    float latitude = reportedLatitude;
+    float longitude = reportedLongitude;
+    time_t now = time(nullptr);
+    if (orbit.valid && now > 1000000000 && fabsf(orbitAgeHours(orbit, now)) < maxOrbitAgeHours) {
+        orbitPosition(orbit, now, latitude, longitude);
+    }
+
+    char position[POSITION_FIELD_WIDTH + 1];
+    formatPosition(latitude, longitude, position, sizeof(position));
+    lineScroll[0].patch(positionColumn, position, POSITION_FIELD_WIDTH);
+}
+
+/**
+ * Formats a position as a fixed-width field, e.g. " 5.3S 123.4W"
+ * @param latitude Degrees, north positive
+ * @param longitude Degrees, east positive
+ * @param output Buffer of at least POSITION_FIELD_WIDTH + 1 bytes
+ * @param outputSize Size of the output buffer
+ * @return Number of characters written
+ */
+int formatPosition(float latitude, float longitude, char* output, size_t outputSize) {
+    return snprintf(output, outputSize, "%4.1f%c %5.1f%c",
+                    fabsf(latitude), latitude < 0 ? 'S' : 'N',
+                    fabsf(longitude), longitude < 0 ? 'W' : 'E');
+}
@@ -0,0 +1,292 @@
+/*
+ * Benchmark Payloads
+ * ==================
+ *
+ * A recorded batch-of-6 BFF response in both wire formats, 2719 bytes as JSON
+ * and 2504 as CBOR. The CBOR form was encoded from the same document by
+ * encode_cbor() in cloud_functions/iss_api_bff_esp/utils.py.
+ *
+ * benchTrack is a 90-minute ground track of 5-minute samples (103 bytes),
+ * encoded by encode_track() in the same file.
+ *
+ * benchPatch is the inflated record stream of an OTA delta (1055 bytes) from
+ * the 1024-byte image test_ota_patch_apply() generates to a relinked 1046-byte
+ * one, made with diff_records() in scripts/make_ota_patch.py.
+ */
+
+#ifndef ISS_BENCH_PAYLOADS_H
+#define ISS_BENCH_PAYLOADS_H
+
+#include <stdint.h>
+
+static const char benchJsonBody[] =
+    "{\"status\": \"success\", \"latitude\": \"46.2044\", \"longitude\": \"6.1432\", \"location_details\": \"Genève,"
+    " Switzerland\", \"fun_fact\": \"Lake Geneva holds about 89 cubic kilometres of water and is shared b"
+    "y France and Switzerland; the Jet d'Eau on its shore throws water 140 m into the air, and on a c"
+    "lear night the ISS crosses it in under ten seconds, passing over Genève, Lausanne and Évian.\", \""
+    "timestamp\": \"2024-01-01T12:00:00+00:00\", \"tle_line1\": \"1 25544U 98067A   24001.50000000  .000167"
+    "17  00000-0  30153-3 0  9999\", \"tle_line2\": \"2 25544  51.6416 247.4627 0006703 130.5360 325.0288"
+    " 15.50000000432100\", \"upcoming\": [{\"timestamp\": \"2024-01-01T12:05:00+00:00\", \"timestamp_unix\": 1"
+    "704110700, \"latitude\": 47.7, \"longitude\": 15.1, \"location\": \"Bavaria, Germany\", \"fun_fact\": \"Lak"
+    "e Geneva holds about 89 cubic kilometres of water and is shared by France and Switzerland; the J"
+    "et d'Eau on its shore throws water 140 m into the air, and on a clear night the ISS crosses it i"
+    "n under ten seconds, passing over Genève, Lausanne and Évian.\"}, {\"timestamp\": \"2024-01-01T12:10"
+    ":00+00:00\", \"timestamp_unix\": 1704111000, \"latitude\": 49.2, \"longitude\": 24.1, \"location\": \"Mazo"
+    "wieckie, Poland\", \"fun_fact\": \"Lake Geneva holds about 89 cubic kilometres of water and is share"
+    "d by France and Switzerland; the Jet d'Eau on its shore throws water 140 m into the air, and on "
+    "a clear night the ISS crosses it in under ten seconds, passing over Genève, Lausanne and Évian.\""
+    "}, {\"timestamp\": \"2024-01-01T12:15:00+00:00\", \"timestamp_unix\": 1704111300, \"latitude\": 50.7, \"l"
+    "ongitude\": 33.1, \"location\": \"Kyiv Oblast, Ukraine\", \"fun_fact\": \"Lake Geneva holds about 89 cub"
+    "ic kilometres of water and is shared by France and Switzerland; the Jet d'Eau on its shore throw"
+    "s water 140 m into the air, and on a clear night the ISS crosses it in under ten seconds, passin"
+    "g over Genève, Lausanne and Évian.\"}, {\"timestamp\": \"2024-01-01T12:20:00+00:00\", \"timestamp_unix"
+    "\": 1704111600, \"latitude\": 52.2, \"longitude\": 42.1, \"location\": \"Rostov Oblast, Russia\", \"fun_fa"
+    "ct\": \"Lake Geneva holds about 89 cubic kilometres of water and is shared by France and Switzerla"
+    "nd; the Jet d'Eau on its shore throws water 140 m into the air, and on a clear night the ISS cro"
+    "sses it in under ten seconds, passing over Genève, Lausanne and Évian.\"}, {\"timestamp\": \"2024-01"
+    "-01T12:25:00+00:00\", \"timestamp_unix\": 1704111900, \"latitude\": 53.7, \"longitude\": 51.1, \"locatio"
+    "n\": \"Atyrau Region, Kazakhstan\", \"fun_fact\": \"Lake Geneva holds about 89 cubic kilometres of wat"
+    "er and is shared by France and Switzerland; the Jet d'Eau on its shore throws water 140 m into t"
+    "he air, and on a clear night the ISS crosses it in under ten seconds, passing over Genève, Lausa"
+    "nne and Évian.\"}]}";
+
+static const uint8_t benchCborBody[] = {
+    0xa9, 0x66, 0x73, 0x74, 0x61, 0x74, 0x75, 0x73, 0x67, 0x73, 0x75, 0x63, 0x63, 0x65, 0x73, 0x73,
+    0x68, 0x6c, 0x61, 0x74, 0x69, 0x74, 0x75, 0x64, 0x65, 0x67, 0x34, 0x36, 0x2e, 0x32, 0x30, 0x34,
+    0x34, 0x69, 0x6c, 0x6f, 0x6e, 0x67, 0x69, 0x74, 0x75, 0x64, 0x65, 0x66, 0x36, 0x2e, 0x31, 0x34,
+    0x33, 0x32, 0x70, 0x6c, 0x6f, 0x63, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x64, 0x65, 0x74, 0x61,
+    0x69, 0x6c, 0x73, 0x74, 0x47, 0x65, 0x6e, 0xc3, 0xa8, 0x76, 0x65, 0x2c, 0x20, 0x53, 0x77, 0x69,
+    0x74, 0x7a, 0x65, 0x72, 0x6c, 0x61, 0x6e, 0x64, 0x68, 0x66, 0x75, 0x6e, 0x5f, 0x66, 0x61, 0x63,
+    0x74, 0x79, 0x01, 0x02, 0x4c, 0x61, 0x6b, 0x65, 0x20, 0x47, 0x65, 0x6e, 0x65, 0x76, 0x61, 0x20,
+    0x68, 0x6f, 0x6c, 0x64, 0x73, 0x20, 0x61, 0x62, 0x6f, 0x75, 0x74, 0x20, 0x38, 0x39, 0x20, 0x63,
+    0x75, 0x62, 0x69, 0x63, 0x20, 0x6b, 0x69, 0x6c, 0x6f, 0x6d, 0x65, 0x74, 0x72, 0x65, 0x73, 0x20,
+    0x6f, 0x66, 0x20, 0x77, 0x61, 0x74, 0x65, 0x72, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x69, 0x73, 0x20,
+    0x73, 0x68, 0x61, 0x72, 0x65, 0x64, 0x20, 0x62, 0x79, 0x20, 0x46, 0x72, 0x61, 0x6e, 0x63, 0x65,
+    0x20, 0x61, 0x6e, 0x64, 0x20, 0x53, 0x77, 0x69, 0x74, 0x7a, 0x65, 0x72, 0x6c, 0x61, 0x6e, 0x64,
+    0x3b, 0x20, 0x74, 0x68, 0x65, 0x20, 0x4a, 0x65, 0x74, 0x20, 0x64, 0x27, 0x45, 0x61, 0x75, 0x20,
+    0x6f, 0x6e, 0x20, 0x69, 0x74, 0x73, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x65, 0x20, 0x74, 0x68, 0x72,
+    0x6f, 0x77, 0x73, 0x20, 0x77, 0x61, 0x74, 0x65, 0x72, 0x20, 0x31, 0x34, 0x30, 0x20, 0x6d, 0x20,
+    0x69, 0x6e, 0x74, 0x6f, 0x20, 0x74, 0x68, 0x65, 0x20, 0x61, 0x69, 0x72, 0x2c, 0x20, 0x61, 0x6e,
+    0x64, 0x20, 0x6f, 0x6e, 0x20, 0x61, 0x20, 0x63, 0x6c, 0x65, 0x61, 0x72, 0x20, 0x6e, 0x69, 0x67,
+    0x68, 0x74, 0x20, 0x74, 0x68, 0x65, 0x20, 0x49, 0x53, 0x53, 0x20, 0x63, 0x72, 0x6f, 0x73, 0x73,
+    0x65, 0x73, 0x20, 0x69, 0x74, 0x20, 0x69, 0x6e, 0x20, 0x75, 0x6e, 0x64, 0x65, 0x72, 0x20, 0x74,
+    0x65, 0x6e, 0x20, 0x73, 0x65, 0x63, 0x6f, 0x6e, 0x64, 0x73, 0x2c, 0x20, 0x70, 0x61, 0x73, 0x73,
+    0x69, 0x6e, 0x67, 0x20, 0x6f, 0x76, 0x65, 0x72, 0x20, 0x47, 0x65, 0x6e, 0xc3, 0xa8, 0x76, 0x65,
+    0x2c, 0x20, 0x4c, 0x61, 0x75, 0x73, 0x61, 0x6e, 0x6e, 0x65, 0x20, 0x61, 0x6e, 0x64, 0x20, 0xc3,
+    0x89, 0x76, 0x69, 0x61, 0x6e, 0x2e, 0x69, 0x74, 0x69, 0x6d, 0x65, 0x73, 0x74, 0x61, 0x6d, 0x70,
+    0x78, 0x19, 0x32, 0x30, 0x32, 0x34, 0x2d, 0x30, 0x31, 0x2d, 0x30, 0x31, 0x54, 0x31, 0x32, 0x3a,
+    0x30, 0x30, 0x3a, 0x30, 0x30, 0x2b, 0x30, 0x30, 0x3a, 0x30, 0x30, 0x69, 0x74, 0x6c, 0x65, 0x5f,
+    0x6c, 0x69, 0x6e, 0x65, 0x31, 0x78, 0x45, 0x31, 0x20, 0x32, 0x35, 0x35, 0x34, 0x34, 0x55, 0x20,
+    0x39, 0x38, 0x30, 0x36, 0x37, 0x41, 0x20, 0x20, 0x20, 0x32, 0x34, 0x30, 0x30, 0x31, 0x2e, 0x35,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x20, 0x20, 0x2e, 0x30, 0x30, 0x30, 0x31, 0x36, 0x37,
+    0x31, 0x37, 0x20, 0x20, 0x30, 0x30, 0x30, 0x30, 0x30, 0x2d, 0x30, 0x20, 0x20, 0x33, 0x30, 0x31,
+    0x35, 0x33, 0x2d, 0x33, 0x20, 0x30, 0x20, 0x20, 0x39, 0x39, 0x39, 0x39, 0x69, 0x74, 0x6c, 0x65,
+    0x5f, 0x6c, 0x69, 0x6e, 0x65, 0x32, 0x78, 0x45, 0x32, 0x20, 0x32, 0x35, 0x35, 0x34, 0x34, 0x20,
+    0x20, 0x35, 0x31, 0x2e, 0x36, 0x34, 0x31, 0x36, 0x20, 0x32, 0x34, 0x37, 0x2e, 0x34, 0x36, 0x32,
+    0x37, 0x20, 0x30, 0x30, 0x30, 0x36, 0x37, 0x30, 0x33, 0x20, 0x31, 0x33, 0x30, 0x2e, 0x35, 0x33,
+    0x36, 0x30, 0x20, 0x33, 0x32, 0x35, 0x2e, 0x30, 0x32, 0x38, 0x38, 0x20, 0x31, 0x35, 0x2e, 0x35,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x34, 0x33, 0x32, 0x31, 0x30, 0x30, 0x68, 0x75, 0x70,
+    0x63, 0x6f, 0x6d, 0x69, 0x6e, 0x67, 0x85, 0xa6, 0x69, 0x74, 0x69, 0x6d, 0x65, 0x73, 0x74, 0x61,
+    0x6d, 0x70, 0x78, 0x19, 0x32, 0x30, 0x32, 0x34, 0x2d, 0x30, 0x31, 0x2d, 0x30, 0x31, 0x54, 0x31,
+    0x32, 0x3a, 0x30, 0x35, 0x3a, 0x30, 0x30, 0x2b, 0x30, 0x30, 0x3a, 0x30, 0x30, 0x6e, 0x74, 0x69,
+    0x6d, 0x65, 0x73, 0x74, 0x61, 0x6d, 0x70, 0x5f, 0x75, 0x6e, 0x69, 0x78, 0x1a, 0x65, 0x92, 0xaa,
+    0x6c, 0x68, 0x6c, 0x61, 0x74, 0x69, 0x74, 0x75, 0x64, 0x65, 0xfa, 0x42, 0x3e, 0xcc, 0xcd, 0x69,
+    0x6c, 0x6f, 0x6e, 0x67, 0x69, 0x74, 0x75, 0x64, 0x65, 0xfa, 0x41, 0x71, 0x99, 0x9a, 0x68, 0x6c,
+    0x6f, 0x63, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x70, 0x42, 0x61, 0x76, 0x61, 0x72, 0x69, 0x61, 0x2c,
+    0x20, 0x47, 0x65, 0x72, 0x6d, 0x61, 0x6e, 0x79, 0x68, 0x66, 0x75, 0x6e, 0x5f, 0x66, 0x61, 0x63,
+    0x74, 0x79, 0x01, 0x02, 0x4c, 0x61, 0x6b, 0x65, 0x20, 0x47, 0x65, 0x6e, 0x65, 0x76, 0x61, 0x20,
+    0x68, 0x6f, 0x6c, 0x64, 0x73, 0x20, 0x61, 0x62, 0x6f, 0x75, 0x74, 0x20, 0x38, 0x39, 0x20, 0x63,
+    0x75, 0x62, 0x69, 0x63, 0x20, 0x6b, 0x69, 0x6c, 0x6f, 0x6d, 0x65, 0x74, 0x72, 0x65, 0x73, 0x20,
+    0x6f, 0x66, 0x20, 0x77, 0x61, 0x74, 0x65, 0x72, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x69, 0x73, 0x20,
+    0x73, 0x68, 0x61, 0x72, 0x65, 0x64, 0x20, 0x62, 0x79, 0x20, 0x46, 0x72, 0x61, 0x6e, 0x63, 0x65,
+    0x20, 0x61, 0x6e, 0x64, 0x20, 0x53, 0x77, 0x69, 0x74, 0x7a, 0x65, 0x72, 0x6c, 0x61, 0x6e, 0x64,
+    0x3b, 0x20, 0x74, 0x68, 0x65, 0x20, 0x4a, 0x65, 0x74, 0x20, 0x64, 0x27, 0x45, 0x61, 0x75, 0x20,
+    0x6f, 0x6e, 0x20, 0x69, 0x74, 0x73, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x65, 0x20, 0x74, 0x68, 0x72,
+    0x6f, 0x77, 0x73, 0x20, 0x77, 0x61, 0x74, 0x65, 0x72, 0x20, 0x31, 0x34, 0x30, 0x20, 0x6d, 0x20,
+    0x69, 0x6e, 0x74, 0x6f, 0x20, 0x74, 0x68, 0x65, 0x20, 0x61, 0x69, 0x72, 0x2c, 0x20, 0x61, 0x6e,
+    0x64, 0x20, 0x6f, 0x6e, 0x20, 0x61, 0x20, 0x63, 0x6c, 0x65, 0x61, 0x72, 0x20, 0x6e, 0x69, 0x67,
+    0x68, 0x74, 0x20, 0x74, 0x68, 0x65, 0x20, 0x49, 0x53, 0x53, 0x20, 0x63, 0x72, 0x6f, 0x73, 0x73,
+    0x65, 0x73, 0x20, 0x69, 0x74, 0x20, 0x69, 0x6e, 0x20, 0x75, 0x6e, 0x64, 0x65, 0x72, 0x20, 0x74,
+    0x65, 0x6e, 0x20, 0x73, 0x65, 0x63, 0x6f, 0x6e, 0x64, 0x73, 0x2c, 0x20, 0x70, 0x61, 0x73, 0x73,
+    0x69, 0x6e, 0x67, 0x20, 0x6f, 0x76, 0x65, 0x72, 0x20, 0x47, 0x65, 0x6e, 0xc3, 0xa8, 0x76, 0x65,
+    0x2c, 0x20, 0x4c, 0x61, 0x75, 0x73, 0x61, 0x6e, 0x6e, 0x65, 0x20, 0x61, 0x6e, 0x64, 0x20, 0xc3,
+    0x89, 0x76, 0x69, 0x61, 0x6e, 0x2e, 0xa6, 0x69, 0x74, 0x69, 0x6d, 0x65, 0x73, 0x74, 0x61, 0x6d,
+    0x70, 0x78, 0x19, 0x32, 0x30, 0x32, 0x34, 0x2d, 0x30, 0x31, 0x2d, 0x30, 0x31, 0x54, 0x31, 0x32,
+    0x3a, 0x31, 0x30, 0x3a, 0x30, 0x30, 0x2b, 0x30, 0x30, 0x3a, 0x30, 0x30, 0x6e, 0x74, 0x69, 0x6d,
+    0x65, 0x73, 0x74, 0x61, 0x6d, 0x70, 0x5f, 0x75, 0x6e, 0x69, 0x78, 0x1a, 0x65, 0x92, 0xab, 0x98,
+    0x68, 0x6c, 0x61, 0x74, 0x69, 0x74, 0x75, 0x64, 0x65, 0xfa, 0x42, 0x44, 0xcc, 0xcd, 0x69, 0x6c,
+    0x6f, 0x6e, 0x67, 0x69, 0x74, 0x75, 0x64, 0x65, 0xfa, 0x41, 0xc0, 0xcc, 0xcd, 0x68, 0x6c, 0x6f,
+    0x63, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x73, 0x4d, 0x61, 0x7a, 0x6f, 0x77, 0x69, 0x65, 0x63, 0x6b,
+    0x69, 0x65, 0x2c, 0x20, 0x50, 0x6f, 0x6c, 0x61, 0x6e, 0x64, 0x68, 0x66, 0x75, 0x6e, 0x5f, 0x66,
+    0x61, 0x63, 0x74, 0x79, 0x01, 0x02, 0x4c, 0x61, 0x6b, 0x65, 0x20, 0x47, 0x65, 0x6e, 0x65, 0x76,
+    0x61, 0x20, 0x68, 0x6f, 0x6c, 0x64, 0x73, 0x20, 0x61, 0x62, 0x6f, 0x75, 0x74, 0x20, 0x38, 0x39,
+    0x20, 0x63, 0x75, 0x62, 0x69, 0x63, 0x20, 0x6b, 0x69, 0x6c, 0x6f, 0x6d, 0x65, 0x74, 0x72, 0x65,
+    0x73, 0x20, 0x6f, 0x66, 0x20, 0x77, 0x61, 0x74, 0x65, 0x72, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x69,
+    0x73, 0x20, 0x73, 0x68, 0x61, 0x72, 0x65, 0x64, 0x20, 0x62, 0x79, 0x20, 0x46, 0x72, 0x61, 0x6e,
+    0x63, 0x65, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x53, 0x77, 0x69, 0x74, 0x7a, 0x65, 0x72, 0x6c, 0x61,
+    0x6e, 0x64, 0x3b, 0x20, 0x74, 0x68, 0x65, 0x20, 0x4a, 0x65, 0x74, 0x20, 0x64, 0x27, 0x45, 0x61,
+    0x75, 0x20, 0x6f, 0x6e, 0x20, 0x69, 0x74, 0x73, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x65, 0x20, 0x74,
+    0x68, 0x72, 0x6f, 0x77, 0x73, 0x20, 0x77, 0x61, 0x74, 0x65, 0x72, 0x20, 0x31, 0x34, 0x30, 0x20,
+    0x6d, 0x20, 0x69, 0x6e, 0x74, 0x6f, 0x20, 0x74, 0x68, 0x65, 0x20, 0x61, 0x69, 0x72, 0x2c, 0x20,
+    0x61, 0x6e, 0x64, 0x20, 0x6f, 0x6e, 0x20, 0x61, 0x20, 0x63, 0x6c, 0x65, 0x61, 0x72, 0x20, 0x6e,
+    0x69, 0x67, 0x68, 0x74, 0x20, 0x74, 0x68, 0x65, 0x20, 0x49, 0x53, 0x53, 0x20, 0x63, 0x72, 0x6f,
+    0x73, 0x73, 0x65, 0x73, 0x20, 0x69, 0x74, 0x20, 0x69, 0x6e, 0x20, 0x75, 0x6e, 0x64, 0x65, 0x72,
+    0x20, 0x74, 0x65, 0x6e, 0x20, 0x73, 0x65, 0x63, 0x6f, 0x6e, 0x64, 0x73, 0x2c, 0x20, 0x70, 0x61,
+    0x73, 0x73, 0x69, 0x6e, 0x67, 0x20, 0x6f, 0x76, 0x65, 0x72, 0x20, 0x47, 0x65, 0x6e, 0xc3, 0xa8,
+    0x76, 0x65, 0x2c, 0x20, 0x4c, 0x61, 0x75, 0x73, 0x61, 0x6e, 0x6e, 0x65, 0x20, 0x61, 0x6e, 0x64,
+    0x20, 0xc3, 0x89, 0x76, 0x69, 0x61, 0x6e, 0x2e, 0xa6, 0x69, 0x74, 0x69, 0x6d, 0x65, 0x73, 0x74,
+    0x61, 0x6d, 0x70, 0x78, 0x19, 0x32, 0x30, 0x32, 0x34, 0x2d, 0x30, 0x31, 0x2d, 0x30, 0x31, 0x54,
+    0x31, 0x32, 0x3a, 0x31, 0x35, 0x3a, 0x30, 0x30, 0x2b, 0x30, 0x30, 0x3a, 0x30, 0x30, 0x6e, 0x74,
+    0x69, 0x6d, 0x65, 0x73, 0x74, 0x61, 0x6d, 0x70, 0x5f, 0x75, 0x6e, 0x69, 0x78, 0x1a, 0x65, 0x92,
+    0xac, 0xc4, 0x68, 0x6c, 0x61, 0x74, 0x69, 0x74, 0x75, 0x64, 0x65, 0xfa, 0x42, 0x4a, 0xcc, 0xcd,
+    0x69, 0x6c, 0x6f, 0x6e, 0x67, 0x69, 0x74, 0x75, 0x64, 0x65, 0xfa, 0x42, 0x04, 0x66, 0x66, 0x68,
+    0x6c, 0x6f, 0x63, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x74, 0x4b, 0x79, 0x69, 0x76, 0x20, 0x4f, 0x62,
+    0x6c, 0x61, 0x73, 0x74, 0x2c, 0x20, 0x55, 0x6b, 0x72, 0x61, 0x69, 0x6e, 0x65, 0x68, 0x66, 0x75,
+    0x6e, 0x5f, 0x66, 0x61, 0x63, 0x74, 0x79, 0x01, 0x02, 0x4c, 0x61, 0x6b, 0x65, 0x20, 0x47, 0x65,
+    0x6e, 0x65, 0x76, 0x61, 0x20, 0x68, 0x6f, 0x6c, 0x64, 0x73, 0x20, 0x61, 0x62, 0x6f, 0x75, 0x74,
+    0x20, 0x38, 0x39, 0x20, 0x63, 0x75, 0x62, 0x69, 0x63, 0x20, 0x6b, 0x69, 0x6c, 0x6f, 0x6d, 0x65,
+    0x74, 0x72, 0x65, 0x73, 0x20, 0x6f, 0x66, 0x20, 0x77, 0x61, 0x74, 0x65, 0x72, 0x20, 0x61, 0x6e,
+    0x64, 0x20, 0x69, 0x73, 0x20, 0x73, 0x68, 0x61, 0x72, 0x65, 0x64, 0x20, 0x62, 0x79, 0x20, 0x46,
+    0x72, 0x61, 0x6e, 0x63, 0x65, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x53, 0x77, 0x69, 0x74, 0x7a, 0x65,
+    0x72, 0x6c, 0x61, 0x6e, 0x64, 0x3b, 0x20, 0x74, 0x68, 0x65, 0x20, 0x4a, 0x65, 0x74, 0x20, 0x64,
+    0x27, 0x45, 0x61, 0x75, 0x20, 0x6f, 0x6e, 0x20, 0x69, 0x74, 0x73, 0x20, 0x73, 0x68, 0x6f, 0x72,
+    0x65, 0x20, 0x74, 0x68, 0x72, 0x6f, 0x77, 0x73, 0x20, 0x77, 0x61, 0x74, 0x65, 0x72, 0x20, 0x31,
+    0x34, 0x30, 0x20, 0x6d, 0x20, 0x69, 0x6e, 0x74, 0x6f, 0x20, 0x74, 0x68, 0x65, 0x20, 0x61, 0x69,
+    0x72, 0x2c, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x6f, 0x6e, 0x20, 0x61, 0x20, 0x63, 0x6c, 0x65, 0x61,
+    0x72, 0x20, 0x6e, 0x69, 0x67, 0x68, 0x74, 0x20, 0x74, 0x68, 0x65, 0x20, 0x49, 0x53, 0x53, 0x20,
+    0x63, 0x72, 0x6f, 0x73, 0x73, 0x65, 0x73, 0x20, 0x69, 0x74, 0x20, 0x69, 0x6e, 0x20, 0x75, 0x6e,
+    0x64, 0x65, 0x72, 0x20, 0x74, 0x65, 0x6e, 0x20, 0x73, 0x65, 0x63, 0x6f, 0x6e, 0x64, 0x73, 0x2c,
+    0x20, 0x70, 0x61, 0x73, 0x73, 0x69, 0x6e, 0x67, 0x20, 0x6f, 0x76, 0x65, 0x72, 0x20, 0x47, 0x65,
+    0x6e, 0xc3, 0xa8, 0x76, 0x65, 0x2c, 0x20, 0x4c, 0x61, 0x75, 0x73, 0x61, 0x6e, 0x6e, 0x65, 0x20,
+    0x61, 0x6e, 0x64, 0x20, 0xc3, 0x89, 0x76, 0x69, 0x61, 0x6e, 0x2e, 0xa6, 0x69, 0x74, 0x69, 0x6d,
+    0x65, 0x73, 0x74, 0x61, 0x6d, 0x70, 0x78, 0x19, 0x32, 0x30, 0x32, 0x34, 0x2d, 0x30, 0x31, 0x2d,
+    0x30, 0x31, 0x54, 0x31, 0x32, 0x3a, 0x32, 0x30, 0x3a, 0x30, 0x30, 0x2b, 0x30, 0x30, 0x3a, 0x30,
+    0x30, 0x6e, 0x74, 0x69, 0x6d, 0x65, 0x73, 0x74, 0x61, 0x6d, 0x70, 0x5f, 0x75, 0x6e, 0x69, 0x78,
+    0x1a, 0x65, 0x92, 0xad, 0xf0, 0x68, 0x6c, 0x61, 0x74, 0x69, 0x74, 0x75, 0x64, 0x65, 0xfa, 0x42,
+    0x50, 0xcc, 0xcd, 0x69, 0x6c, 0x6f, 0x6e, 0x67, 0x69, 0x74, 0x75, 0x64, 0x65, 0xfa, 0x42, 0x28,
+    0x66, 0x66, 0x68, 0x6c, 0x6f, 0x63, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x75, 0x52, 0x6f, 0x73, 0x74,
+    0x6f, 0x76, 0x20, 0x4f, 0x62, 0x6c, 0x61, 0x73, 0x74, 0x2c, 0x20, 0x52, 0x75, 0x73, 0x73, 0x69,
+    0x61, 0x68, 0x66, 0x75, 0x6e, 0x5f, 0x66, 0x61, 0x63, 0x74, 0x79, 0x01, 0x02, 0x4c, 0x61, 0x6b,
+    0x65, 0x20, 0x47, 0x65, 0x6e, 0x65, 0x76, 0x61, 0x20, 0x68, 0x6f, 0x6c, 0x64, 0x73, 0x20, 0x61,
+    0x62, 0x6f, 0x75, 0x74, 0x20, 0x38, 0x39, 0x20, 0x63, 0x75, 0x62, 0x69, 0x63, 0x20, 0x6b, 0x69,
+    0x6c, 0x6f, 0x6d, 0x65, 0x74, 0x72, 0x65, 0x73, 0x20, 0x6f, 0x66, 0x20, 0x77, 0x61, 0x74, 0x65,
+    0x72, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x69, 0x73, 0x20, 0x73, 0x68, 0x61, 0x72, 0x65, 0x64, 0x20,
+    0x62, 0x79, 0x20, 0x46, 0x72, 0x61, 0x6e, 0x63, 0x65, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x53, 0x77,
+    0x69, 0x74, 0x7a, 0x65, 0x72, 0x6c, 0x61, 0x6e, 0x64, 0x3b, 0x20, 0x74, 0x68, 0x65, 0x20, 0x4a,
+    0x65, 0x74, 0x20, 0x64, 0x27, 0x45, 0x61, 0x75, 0x20, 0x6f, 0x6e, 0x20, 0x69, 0x74, 0x73, 0x20,
+    0x73, 0x68, 0x6f, 0x72, 0x65, 0x20, 0x74, 0x68, 0x72, 0x6f, 0x77, 0x73, 0x20, 0x77, 0x61, 0x74,
+    0x65, 0x72, 0x20, 0x31, 0x34, 0x30, 0x20, 0x6d, 0x20, 0x69, 0x6e, 0x74, 0x6f, 0x20, 0x74, 0x68,
+    0x65, 0x20, 0x61, 0x69, 0x72, 0x2c, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x6f, 0x6e, 0x20, 0x61, 0x20,
+    0x63, 0x6c, 0x65, 0x61, 0x72, 0x20, 0x6e, 0x69, 0x67, 0x68, 0x74, 0x20, 0x74, 0x68, 0x65, 0x20,
+    0x49, 0x53, 0x53, 0x20, 0x63, 0x72, 0x6f, 0x73, 0x73, 0x65, 0x73, 0x20, 0x69, 0x74, 0x20, 0x69,
+    0x6e, 0x20, 0x75, 0x6e, 0x64, 0x65, 0x72, 0x20, 0x74, 0x65, 0x6e, 0x20, 0x73, 0x65, 0x63, 0x6f,
+    0x6e, 0x64, 0x73, 0x2c, 0x20, 0x70, 0x61, 0x73, 0x73, 0x69, 0x6e, 0x67, 0x20, 0x6f, 0x76, 0x65,
+    0x72, 0x20, 0x47, 0x65, 0x6e, 0xc3, 0xa8, 0x76, 0x65, 0x2c, 0x20, 0x4c, 0x61, 0x75, 0x73, 0x61,
+    0x6e, 0x6e, 0x65, 0x20, 0x61, 0x6e, 0x64, 0x20, 0xc3, 0x89, 0x76, 0x69, 0x61, 0x6e, 0x2e, 0xa6,
+    0x69, 0x74, 0x69, 0x6d, 0x65, 0x73, 0x74, 0x61, 0x6d, 0x70, 0x78, 0x19, 0x32, 0x30, 0x32, 0x34,
+    0x2d, 0x30, 0x31, 0x2d, 0x30, 0x31, 0x54, 0x31, 0x32, 0x3a, 0x32, 0x35, 0x3a, 0x30, 0x30, 0x2b,
+    0x30, 0x30, 0x3a, 0x30, 0x30, 0x6e, 0x74, 0x69, 0x6d, 0x65, 0x73, 0x74, 0x61, 0x6d, 0x70, 0x5f,
+    0x75, 0x6e, 0x69, 0x78, 0x1a, 0x65, 0x92, 0xaf, 0x1c, 0x68, 0x6c, 0x61, 0x74, 0x69, 0x74, 0x75,
+    0x64, 0x65, 0xfa, 0x42, 0x56, 0xcc, 0xcd, 0x69, 0x6c, 0x6f, 0x6e, 0x67, 0x69, 0x74, 0x75, 0x64,
+    0x65, 0xfa, 0x42, 0x4c, 0x66, 0x66, 0x68, 0x6c, 0x6f, 0x63, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x78,
+    0x19, 0x41, 0x74, 0x79, 0x72, 0x61, 0x75, 0x20, 0x52, 0x65, 0x67, 0x69, 0x6f, 0x6e, 0x2c, 0x20,
+    0x4b, 0x61, 0x7a, 0x61, 0x6b, 0x68, 0x73, 0x74, 0x61, 0x6e, 0x68, 0x66, 0x75, 0x6e, 0x5f, 0x66,
+    0x61, 0x63, 0x74, 0x79, 0x01, 0x02, 0x4c, 0x61, 0x6b, 0x65, 0x20, 0x47, 0x65, 0x6e, 0x65, 0x76,
+    0x61, 0x20, 0x68, 0x6f, 0x6c, 0x64, 0x73, 0x20, 0x61, 0x62, 0x6f, 0x75, 0x74, 0x20, 0x38, 0x39,
+    0x20, 0x63, 0x75, 0x62, 0x69, 0x63, 0x20, 0x6b, 0x69, 0x6c, 0x6f, 0x6d, 0x65, 0x74, 0x72, 0x65,
+    0x73, 0x20, 0x6f, 0x66, 0x20, 0x77, 0x61, 0x74, 0x65, 0x72, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x69,
+    0x73, 0x20, 0x73, 0x68, 0x61, 0x72, 0x65, 0x64, 0x20, 0x62, 0x79, 0x20, 0x46, 0x72, 0x61, 0x6e,
+    0x63, 0x65, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x53, 0x77, 0x69, 0x74, 0x7a, 0x65, 0x72, 0x6c, 0x61,
+    0x6e, 0x64, 0x3b, 0x20, 0x74, 0x68, 0x65, 0x20, 0x4a, 0x65, 0x74, 0x20, 0x64, 0x27, 0x45, 0x61,
+    0x75, 0x20, 0x6f, 0x6e, 0x20, 0x69, 0x74, 0x73, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x65, 0x20, 0x74,
+    0x68, 0x72, 0x6f, 0x77, 0x73, 0x20, 0x77, 0x61, 0x74, 0x65, 0x72, 0x20, 0x31, 0x34, 0x30, 0x20,
+    0x6d, 0x20, 0x69, 0x6e, 0x74, 0x6f, 0x20, 0x74, 0x68, 0x65, 0x20, 0x61, 0x69, 0x72, 0x2c, 0x20,
+    0x61, 0x6e, 0x64, 0x20, 0x6f, 0x6e, 0x20, 0x61, 0x20, 0x63, 0x6c, 0x65, 0x61, 0x72, 0x20, 0x6e,
+    0x69, 0x67, 0x68, 0x74, 0x20, 0x74, 0x68, 0x65, 0x20, 0x49, 0x53, 0x53, 0x20, 0x63, 0x72, 0x6f,
+    0x73, 0x73, 0x65, 0x73, 0x20, 0x69, 0x74, 0x20, 0x69, 0x6e, 0x20, 0x75, 0x6e, 0x64, 0x65, 0x72,
+    0x20, 0x74, 0x65, 0x6e, 0x20, 0x73, 0x65, 0x63, 0x6f, 0x6e, 0x64, 0x73, 0x2c, 0x20, 0x70, 0x61,
+    0x73, 0x73, 0x69, 0x6e, 0x67, 0x20, 0x6f, 0x76, 0x65, 0x72, 0x20, 0x47, 0x65, 0x6e, 0xc3, 0xa8,
+    0x76, 0x65, 0x2c, 0x20, 0x4c, 0x61, 0x75, 0x73, 0x61, 0x6e, 0x6e, 0x65, 0x20, 0x61, 0x6e, 0x64,
+    0x20, 0xc3, 0x89, 0x76, 0x69, 0x61, 0x6e, 0x2e,
+};
+
+static const uint8_t benchTrack[] = {
+    0x01, 0x13, 0xac, 0x02, 0xb8, 0xc4, 0xca, 0xac, 0x06, 0x00, 0x00, 0xcc, 0x09, 0x01, 0xd0, 0x17,
+    0xaa, 0x11, 0x01, 0xb4, 0x16, 0xa0, 0x14, 0x01, 0xaa, 0x13, 0x84, 0x1b, 0x01, 0xe4, 0x0c, 0xf8,
+    0x25, 0x01, 0xd6, 0x01, 0x8a, 0x2e, 0x01, 0x9b, 0x0a, 0xf6, 0x28, 0x01, 0xff, 0x11, 0xd0, 0x1d,
+    0x01, 0xe9, 0x15, 0xd0, 0x15, 0x01, 0xb5, 0x17, 0xe6, 0x11, 0x01, 0xdb, 0x17, 0x88, 0x11, 0x01,
+    0xf1, 0x16, 0x92, 0x13, 0x01, 0xb3, 0x14, 0xe4, 0x18, 0x01, 0xfb, 0x0e, 0xe6, 0x22, 0x01, 0xfd,
+    0x04, 0xfc, 0x2c, 0x01, 0xaa, 0x07, 0xc2, 0x2b, 0x01, 0xb2, 0x10, 0xbe, 0x20, 0x01, 0x8c, 0x15,
+    0xa8, 0x17, 0x01, 0x92, 0x17, 0xbe, 0x12,
+};
+
+static const uint8_t benchPatch[] = {
+    0x80, 0x02, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b,
+    0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0xd8, 0x05, 0x26, 0xaf,
+    0x0f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x72, 0x65, 0x6c, 0x69, 0x6e, 0x6b, 0x65,
+    0x64, 0x20, 0x74, 0x61, 0x69, 0x6c, 0x2c, 0x20, 0x6e, 0x65, 0x77, 0x20, 0x73, 0x74, 0x72, 0x69,
+    0x6e, 0x67, 0x20, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x20, 0x65, 0x6e, 0x74, 0x72, 0x79, 0x2e,
+};
+
+#endif
@@ -0,0 +1,479 @@
+/*
+ * Firmware Benchmarks
+ * ===================
+ *
+ * Micro-benchmarks of the portable firmware logic, run on the host:
+ *
+ *   pio test -e native
+ *
+ * Each benchmark reports ns/op (best of several rounds of at least 20 ms)
+ * and heap allocations per call. Host speed varies, so times are gated as
+ * a multiple of a fixed calibration loop measured in the same run. The gate
+ * fails a benchmark that is more than 25% slower than its entry in
+ * baseline.txt, that allocates more, or that has no entry at all. Record
+ * the whole file in one update run, so every entry comes from the same
+ * host and the same fixtures.
+ *
+ * Environment:
+ *   ISS_BENCH_TOLERANCE=0.4   allowed slowdown as a fraction (default 0.25)
+ *   ISS_BENCH_UPDATE=1        rewrite baseline.txt from this run instead of gating
+ *   ISS_BENCH_BASELINE=path   baseline file (default test/test_bench/baseline.txt)
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <chrono>
+#include <new>
+#include "iss_charset.h"
+#include "iss_framebuffer.h"
+#include "iss_history.h"
+#include "iss_orbit.h"
+#include "iss_ota_patch.h"
+#include "iss_payload.h"
+#include "iss_scroller.h"
+#include "iss_timezone.h"
+#include "payloads.h"
+
+static const char* defaultBaselinePath = "test/test_bench/baseline.txt";
+static const double defaultTolerance = 0.25;
+static const uint64_t minRoundNs = 20000000;  // 20 ms
+static const int rounds = 7;
+static const int maxBenchmarks = 16;
+
+// Heap allocations since start, counted by the operators below
+static volatile size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* memory = malloc(size ? size : 1);
+    if (memory == NULL) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t size) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory, size_t size) noexcept {
+    free(memory);
+}
+
+// Keeps results alive so the optimizer cannot drop the work
+static volatile uint32_t sink = 0;
+
+struct BaselineEntry {
+    char name[32];
+    double relative;    // ns/op divided by the calibration ns/op
+    double allocs;      // Allocations per call
+};
+
+static BaselineEntry baseline[maxBenchmarks];
+static int baselineCount = 0;
+static BaselineEntry measured[maxBenchmarks];
+static int measuredCount = 0;
+static double tolerance = defaultTolerance;
+static bool updating = false;
+
+static uint64_t nowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Times a piece of work
+ * @param work Called once per operation
+ * @param allocsPerOp Receives the heap allocations per call
+ * @return The best ns/op over all rounds
+ */
+template <typename Work>
+static double measure(Work work, double& allocsPerOp) {
+    // Grow the batch until one round takes long enough to time reliably
+    uint64_t iterations = 1;
+    while (true) {
+        uint64_t start = nowNs();
+        for (uint64_t i = 0; i < iterations; i++) {
+            work();
+        }
+        if (nowNs() - start >= minRoundNs || iterations >= (1ULL << 30)) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    double best = 0;
+    size_t allocationsBefore = allocations;
+    for (int round = 0; round < rounds; round++) {
+        uint64_t start = nowNs();
+        for (uint64_t i = 0; i < iterations; i++) {
+            work();
+        }
+        double ns = (double)(nowNs() - start) / iterations;
+        if (round == 0 || ns < best) {
+            best = ns;
+        }
+    }
+    allocsPerOp = (double)(allocations - allocationsBefore) / (iterations * rounds);
+    return best;
+}
+
+/**
+ * Reads baseline.txt: one "name relative allocs" line per benchmark,
+ * '#' starts a comment
+ */
+static void loadBaseline(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        printf("No baseline at %s, reporting only\n", path);
+        return;
+    }
+    char line[128];
+    while (fgets(line, sizeof(line), file) != NULL && baselineCount < maxBenchmarks) {
+        BaselineEntry& entry = baseline[baselineCount];
+        if (line[0] != '#' &&
+            sscanf(line, "%31s %lf %lf", entry.name, &entry.relative, &entry.allocs) == 3) {
+            baselineCount++;
+        }
+    }
+    fclose(file);
+}
+
+static const BaselineEntry* findBaseline(const char* name) {
+    for (int i = 0; i < baselineCount; i++) {
+        if (strcmp(baseline[i].name, name) == 0) {
+            return &baseline[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Times the calibration loop: FNV-1a over 4 KB, fixed integer work that
+ * every host runs at its own speed
+ * @return ns per loop
+ */
+static double calibrate() {
+    static uint8_t block[4096];
+    for (size_t i = 0; i < sizeof(block); i++) {
+        block[i] = (uint8_t)(i * 31);
+    }
+    double allocsPerOp;
+    return measure([]() {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < sizeof(block); i++) {
+            hash = (hash ^ block[i]) * 16777619u;
+        }
+        sink = hash;
+    }, allocsPerOp);
+}
+
+/**
+ * Measures one benchmark, reports it and gates it against the baseline
+ * The calibration loop is timed again right before, so a host that changes
+ * clock speed during the run is compared at the speed it had at the time
+ */
+template <typename Work>
+static void bench(const char* name, Work work) {
+    double calibrationNs = calibrate();
+    Serial.mute(true);
+    double allocsPerOp;
+    double ns = measure(work, allocsPerOp);
+    Serial.mute(false);
+
+    double relative = ns / calibrationNs;
+    if (measuredCount < maxBenchmarks) {
+        BaselineEntry& entry = measured[measuredCount++];
+        strlcpy(entry.name, name, sizeof(entry.name));
+        entry.relative = relative;
+        entry.allocs = allocsPerOp;
+    }
+
+    const BaselineEntry* reference = findBaseline(name);
+    printf("%-24s %10.1f ns/op %6.2f allocs/op %8.4f x calibration", name, ns, allocsPerOp, relative);
+    if (reference == NULL) {
+        printf("  (no baseline)\n");
+        if (!updating) {
+            char message[96];
+            snprintf(message, sizeof(message), "%s has no baseline, record one with ISS_BENCH_UPDATE=1",
+                     name);
+            TEST_FAIL_MESSAGE(message);
+        }
+        return;
+    }
+    printf("  (baseline %.4f, %+.0f%%)\n", reference->relative,
+           (relative / reference->relative - 1) * 100);
+    if (updating) {
+        return;
+    }
+
+    char message[96];
+    snprintf(message, sizeof(message), "%s is %.0f%% slower than its baseline", name,
+             (relative / reference->relative - 1) * 100);
+    TEST_ASSERT_TRUE_MESSAGE(relative <= reference->relative * (1 + tolerance), message);
+    snprintf(message, sizeof(message), "%s allocates %.2f times per call, baseline %.2f",
+             name, allocsPerOp, reference->allocs);
+    TEST_ASSERT_TRUE_MESSAGE(allocsPerOp <= reference->allocs + 0.005, message);
+}
+
+/**
+ * Writes the measured figures as the new baseline
+ */
+static void saveBaseline(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        printf("Could not write %s\n", path);
+        return;
+    }
+    fprintf(file, "# Written by ISS_BENCH_UPDATE=1 pio test -e native\n");
+    fprintf(file, "# name  ns/op as a multiple of the calibration loop  allocs/op\n");
+    for (int i = 0; i < measuredCount; i++) {
+        fprintf(file, "%s %.4g %.2f\n", measured[i].name, measured[i].relative, measured[i].allocs);
+    }
+    fclose(file);
+    printf("Baseline written to %s\n", path);
+}
+
+/**
+ * Read-only view of a recorded body
+ */
+class BufferStream : public Stream {
+public:
+    void reset(const uint8_t* data, size_t size) {
+        this->data = data;
+        this->size = size;
+        position = 0;
+    }
+    int available() override { return (int)(size - position); }
+    int read() override { return position < size ? data[position++] : -1; }
+    int peek() override { return position < size ? data[position] : -1; }
+    size_t write(uint8_t c) override { return 0; }
+
+private:
+    const uint8_t* data = NULL;
+    size_t size = 0;
+    size_t position = 0;
+};
+
+static const char* factText =
+    "Lake Geneva is shared by France and Switzerland; on a clear night the ISS "
+    "crosses it in under ten seconds, passing over Genève, Lausanne and Évian. "
+    "Zürich, Kraków and Łódź follow within a minute on this pass.";
+
+static const char* tleLine1 = "1 25544U 98067A   24001.50000000  .00016717  00000-0  30153-3 0  9999";
+static const char* tleLine2 = "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.50000000432100";
+
+static BufferStream bodyStream;
+static ISSData data;
+
+void setUp() {}
+void tearDown() {}
+
+static void test_calibration() {
+    double calibrationNs = calibrate();
+    printf("Calibration: %.1f ns per 4 KB hash\n", calibrationNs);
+    TEST_ASSERT_TRUE(calibrationNs > 0);
+}
+
+static void test_charset_transliterate() {
+    char output[480];
+    // CGRAM glyphs, multi-character replacements, invalid and truncated UTF-8
+    charsetTransliterate("Fran\xC3\xA7" "ais K\xC3\xB8" "benhavn", output, sizeof(output));
+    TEST_ASSERT_EQUAL_STRING("Fran\x0D" "ais K\x0E" "benhavn", output);
+    charsetTransliterate("Stra\xC3\x9F" "e \xC2\xA9", output, sizeof(output));
+    TEST_ASSERT_EQUAL_STRING("Strasse (c)", output);
+    charsetTransliterate("a\xFF" "b\xA9" "c\xC3", output, sizeof(output));
+    TEST_ASSERT_EQUAL_STRING("a?b?c?", output);
+    charsetTransliterate("\xE2\x82" "d", output, sizeof(output));
+    TEST_ASSERT_EQUAL_STRING("?d", output);
+    // A replacement that does not fit is left out whole
+    TEST_ASSERT_EQUAL(2, charsetTransliterate("ab\xC2\xA9", output, 5));
+    TEST_ASSERT_EQUAL_STRING("ab", output);
+    TEST_ASSERT_EQUAL(5, charsetTransliterate("ab\xC2\xA9", output, 6));
+    TEST_ASSERT_EQUAL_STRING("ab(c)", output);
+    TEST_ASSERT_TRUE(charsetTransliterate(factText, output, sizeof(output)) > 0);
+    bench("charset_transliterate", [&]() {
+        sink = charsetTransliterate(factText, output, sizeof(output));
+    });
+}
+
+static void test_scroll_layout() {
+    static ScrollEngine row;
+    int length = (int)strlen(factText);
+    bench("scroll_layout", [&]() {
+        row.setText(factText, length, 3);
+        sink = (uint8_t)row.window()[0];
+    });
+}
+
+static void test_scroll_frame() {
+    static ScrollEngine row0;
+    static ScrollEngine row1;
+    row0.setText(factText, (int)strlen(factText), 3);
+    row1.setText("Lat 46.20 Lon 6.14 Geneva", 25, 3);
+    framebufferBegin();
+    bench("scroll_frame", []() {
+        row0.tick();
+        row1.tick();
+        framebufferSetRow(0, row0.window(), LCD_COLUMNS);
+        framebufferSetRow(1, row1.window(), LCD_COLUMNS);
+        framebufferFlush();
+    });
+    sink = lcdStats().transactions;
+}
+
+static void test_orbit_parse_tle() {
+    OrbitElements elements;
+    TEST_ASSERT_TRUE(orbitParseTle(tleLine1, tleLine2, elements));
+    bench("orbit_parse_tle", [&]() {
+        sink = orbitParseTle(tleLine1, tleLine2, elements);
+    });
+}
+
+static void test_orbit_position() {
+    OrbitElements elements;
+    TEST_ASSERT_TRUE(orbitParseTle(tleLine1, tleLine2, elements));
+    time_t now = (time_t)elements.epoch;
+    float latitude;
+    float longitude;
+    bench("orbit_position", [&]() {
+        sink = orbitPosition(elements, now++, latitude, longitude);
+    });
+}
+
+static void test_payload_cbor() {
+    bodyStream.reset(benchCborBody, sizeof(benchCborBody));
+    TEST_ASSERT_TRUE(payloadParseCbor(bodyStream, data));
+    TEST_ASSERT_EQUAL(FETCH_BATCH_SIZE - 1, data.upcomingCount);
+    bench("payload_cbor", []() {
+        bodyStream.reset(benchCborBody, sizeof(benchCborBody));
+        sink = payloadParseCbor(bodyStream, data);
+    });
+}
+
+static void test_payload_json() {
+    size_t size = sizeof(benchJsonBody) - 1;
+    bodyStream.reset((const uint8_t*)benchJsonBody, size);
+    Serial.mute(true);
+    bool parsed = payloadParseJson(bodyStream, data);
+    Serial.mute(false);
+    TEST_ASSERT_TRUE(parsed);
+    TEST_ASSERT_EQUAL(FETCH_BATCH_SIZE - 1, data.upcomingCount);
+    bench("payload_json", [&]() {
+        bodyStream.reset((const uint8_t*)benchJsonBody, size);
+        sink = payloadParseJson(bodyStream, data);
+    });
+}
+
+static void test_history_decode() {
+    static GroundTrack track;
+    TEST_ASSERT_TRUE(historyDecode(benchTrack, sizeof(benchTrack), track));
+    TEST_ASSERT_EQUAL(19, track.count);
+    float speedKmh;
+    float headingDeg;
+    TEST_ASSERT_TRUE(historyMotion(track, speedKmh, headingDeg));
+    TEST_ASSERT_FLOAT_WITHIN(1500, 25800, speedKmh);
+    bench("history_decode", []() {
+        sink = historyDecode(benchTrack, sizeof(benchTrack), track);
+    });
+}
+
+// Source image of benchPatch and the image it patches to
+static uint8_t patchSource[1024];
+static uint8_t patchTarget[1046];
+static size_t patchWritten = 0;
+
+static bool readPatchSource(uint32_t offset, uint8_t* buffer, size_t length, void* context) {
+    memcpy(buffer, patchSource + offset, length);
+    return true;
+}
+
+static bool writePatchTarget(const uint8_t* data, size_t length, void* context) {
+    memcpy(patchTarget + patchWritten, data, length);
+    patchWritten += length;
+    return true;
+}
+
+static void test_ota_patch_apply() {
+    // Same generator as the fixture script
+    uint32_t x = 1;
+    for (size_t i = 0; i < sizeof(patchSource); i++) {
+        x = x * 1103515245u + 12345u;
+        patchSource[i] = (x >> 16) & 0xFF;
+    }
+    static OtaPatch patch;
+    auto apply = [&]() {
+        patchWritten = 0;
+        patch.begin(sizeof(patchSource), sizeof(patchTarget), readPatchSource, writePatchTarget, NULL);
+        patch.feed(benchPatch, sizeof(benchPatch));
+    };
+    apply();
+    TEST_ASSERT_TRUE(patch.complete());
+    uint32_t hash = 2166136261u;
+    for (uint8_t b : patchTarget) {
+        hash = (hash ^ b) * 16777619u;
+    }
+    TEST_ASSERT_EQUAL_HEX32(0x8705a724, hash);
+    bench("ota_patch_apply", [&]() {
+        apply();
+        sink = patch.produced();
+    });
+}
+
+static void test_timezone_lookup() {
+    static const char* names[] = {
+        "Africa/Abidjan", "America/New_York", "Asia/Kolkata", "Australia/Sydney",
+        "Europe/Paris", "Pacific/Auckland", "Not/AZone", "UTC"
+    };
+    TEST_ASSERT_NOT_NULL(timezoneLookup("Europe/Paris"));
+    size_t next = 0;
+    bench("timezone_lookup", [&]() {
+        sink = (uintptr_t)timezoneLookup(names[next]);
+        next = (next + 1) % (sizeof(names) / sizeof(names[0]));
+    });
+}
+
+int main(int argc, char** argv) {
+    const char* path = getenv("ISS_BENCH_BASELINE");
+    path = path ? path : defaultBaselinePath;
+    const char* toleranceText = getenv("ISS_BENCH_TOLERANCE");
+    if (toleranceText != NULL) {
+        tolerance = atof(toleranceText);
+    }
+    updating = getenv("ISS_BENCH_UPDATE") != NULL;
+    loadBaseline(path);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_calibration);
+    RUN_TEST(test_charset_transliterate);
+    RUN_TEST(test_scroll_layout);
+    RUN_TEST(test_scroll_frame);
+    RUN_TEST(test_orbit_parse_tle);
+    RUN_TEST(test_orbit_position);
+    RUN_TEST(test_payload_cbor);
+    RUN_TEST(test_payload_json);
+    RUN_TEST(test_history_decode);
+    RUN_TEST(test_ota_patch_apply);
+    RUN_TEST(test_timezone_lookup);
+    int failures = UNITY_END();
+
+    if (updating) {
+        saveBaseline(path);
+        if (failures > 0) {
+            printf("Failed tests left their benchmarks out of the baseline\n");
+        }
+    }
+    return failures;
+}